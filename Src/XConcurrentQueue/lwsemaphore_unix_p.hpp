@@ -33,7 +33,7 @@ namespace moodycamel::details{
     public:
         X_DISABLE_COPY_MOVE(Semaphore)
 
-        constexpr explicit Semaphore(int const initialCount = {}) {
+        explicit Semaphore(int const initialCount = {}) {
             assert(initialCount >= 0);
             [[maybe_unused]] auto const rc {sem_init(std::addressof(m_sema_), 0, static_cast<unsigned int>(initialCount))};
             assert(!rc);
@@ -42,20 +42,20 @@ namespace moodycamel::details{
         virtual ~Semaphore()
         { sem_destroy(std::addressof(m_sema_)); }
 
-        constexpr bool wait() const noexcept {
+        bool wait() const noexcept {
             // http://stackoverflow.com/questions/2013181/gdb-causes-sem-wait-to-fail-with-eintr-error
             int rc{};
             do { rc = sem_wait(std::addressof(m_sema_)); } while (rc < 0 && errno == EINTR);
             return !rc;
         }
 
-        constexpr bool try_wait() const noexcept {
+        bool try_wait() const noexcept {
             int rc{};
             do { rc = sem_trywait(std::addressof(m_sema_)); } while (rc < 0 && errno == EINTR);
             return !rc;
         }
 
-        constexpr bool timed_wait(std::uint64_t const usecs) const noexcept {
+        bool timed_wait(std::uint64_t const usecs) const noexcept {
             struct timespec ts{};
 #ifdef MOODYCAMEL_LIGHTWEIGHTSEMAPHORE_MONOTONIC
             clock_gettime(CLOCK_MONOTONIC, std::addressof(ts));
@@ -78,16 +78,16 @@ namespace moodycamel::details{
 #ifdef MOODYCAMEL_LIGHTWEIGHTSEMAPHORE_MONOTONIC
                 rc = sem_clockwait(std::addressof(m_sema_), CLOCK_MONOTONIC, std::addressof(ts));
 #else
-                rc = sem_timedwait(&std::addressof(m_sema_), std::addressof(ts));
+                rc = sem_timedwait(std::addressof(m_sema_), std::addressof(ts));
 #endif
             } while (rc < 0 && errno == EINTR);
             return !rc;
         }
 
-        constexpr void signal() const noexcept
+        void signal() const noexcept
         { while (sem_post(std::addressof(m_sema_)) < 0); }
 
-        constexpr void signal(int count) const noexcept
+        void signal(int count) const noexcept
         { while (count-- > 0) { while (sem_post(std::addressof(m_sema_)) < 0); } }
     };
 }
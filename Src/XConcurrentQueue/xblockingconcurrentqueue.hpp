@@ -429,7 +429,7 @@ namespace moodycamel {
 		// the queue are lock-free (they should be on most platforms).
 		// Thread-safe.
 		static constexpr bool is_lock_free() noexcept
-		{ return Base::XConcurrentQueue::is_lock_free(); }
+		{ return Base::InnerQueue::is_lock_free(); }
 
 		template<typename ,typename >friend class XBlockingConcurrentQueueAbstract;
 		template<typename,typename,typename> friend struct XBlockingConcurrentQueueProxy;
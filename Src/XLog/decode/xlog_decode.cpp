@@ -0,0 +1,52 @@
+#include <XLog/xlog.hpp>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+/**
+ * 把LogOutput::BINARY写出的.xlb文件还原为文本日志,输出到标准输出
+ * 用法: xlog-decode [--precision ms|us|ns] [--monotonic] [file.xlb ...]
+ * 未指定文件时读取标准输入
+ */
+int main(int const argc, char * argv[]) {
+
+    using namespace XUtils;
+
+    auto precision {LogTimePrecision::MILLISECONDS};
+    auto clock {LogTimestamp::WALL_CLOCK};
+    std::vector<std::string_view> files {};
+
+    for (int i {1}; i < argc; ++i) {
+        std::string_view const arg {argv[i]};
+        if ("--monotonic" == arg) { clock = LogTimestamp::MONOTONIC; continue; }
+        if ("--precision" == arg && i + 1 < argc) {
+            std::string_view const value {argv[++i]};
+            if ("ms" == value) { precision = LogTimePrecision::MILLISECONDS; continue; }
+            if ("us" == value) { precision = LogTimePrecision::MICROSECONDS; continue; }
+            if ("ns" == value) { precision = LogTimePrecision::NANOSECONDS; continue; }
+        }
+        if (arg.starts_with("-")) {
+            std::cerr << "usage: " << argv[0] << " [--precision ms|us|ns] [--monotonic] [file.xlb ...]\n";
+            return 2;
+        }
+        files.push_back(arg);
+    }
+
+    if (files.empty()) { return XLog::decodeBinaryLog(std::cin, std::cout, precision, clock) ? 0 : 1; }
+
+    auto result {0};
+    for (auto const & file : files) {
+        std::ifstream in(std::string{file}, std::ios::binary);
+        if (!in) {
+            std::cerr << "Failed to open " << file << '\n';
+            result = 1;
+            continue;
+        }
+        if (!XLog::decodeBinaryLog(in, std::cout, precision, clock)) {
+            std::cerr << "Corrupted or truncated binary log: " << file << '\n';
+            result = 1;
+        }
+    }
+    return result;
+}
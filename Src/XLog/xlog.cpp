@@ -5,18 +5,86 @@
 #include <iomanip>
 #include <regex>
 #include <array>
+#include <bit>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
 #ifdef _WIN32
 #include <windows.h>
 #include <dbghelp.h>
+#include <io.h>
 #pragma comment(lib, "dbghelp.lib")
 #else
 #include <xsignal.hpp>
 #include <execinfo.h>
+#include <unistd.h>
+#endif
+#ifdef X_PLATFORM_LINUX
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
 #endif
 
 XTD_NAMESPACE_BEGIN
 XTD_INLINE_NAMESPACE_BEGIN(v1)
 
+    static constinit std::atomic<xuint64> sm_nextLogId_{1};
+    /// 日志宏每次调用都要取得实例,XSingleton::instance()按值返回shared_ptr,
+    /// 每条日志两次原子增减,多线程写日志时在同一个控制块上争用,这里缓存裸指针
+    static constinit std::atomic<XLog *> sm_instance_{};
+    /// 当前线程在m_logger对应实例中的队列
+    static constinit thread_local struct { xuint64 m_logger; XLogRing_ * m_ring; } sm_logRing_{};
+
+    /// 持有当前线程的队列,线程退出时标记队列关闭
+    struct XLogRingOwner_ final {
+        std::shared_ptr<XLogRing_> m_ring{};
+        void reset(std::shared_ptr<XLogRing_> ring) noexcept {
+            if (m_ring) { m_ring->m_closed.store(true,std::memory_order_release); }
+            m_ring = std::move(ring);
+        }
+        ~XLogRingOwner_() { reset({}); }
+    };
+    static thread_local XLogRingOwner_ sm_logRingOwner_{};
+
+    /// 只取文件名部分,不构造std::filesystem::path
+    static std::string_view logFileName_(char const * const path) noexcept {
+        if (!path) { return "unknown"; }
+        std::string_view file{path};
+        if (auto const pos{file.find_last_of("/\\")}; pos != std::string_view::npos)
+        { file.remove_prefix(pos + 1); }
+        return file;
+    }
+
+    /**
+     * 模块日志级别表,0号为全局级别(未指定模块)
+     * 宏在每个调用点缓存所属模块级别的引用,之后判断级别只是一次relaxed读取;
+     * 注册与修改在sm_moduleMutex_下进行,模块注册后不会移除,表满后新模块使用全局级别
+     * 名字存放在定长数组中,进程退出析构静态对象后仍可安全查找
+     */
+    struct XLogModule_ final {
+        std::array<char,XLog::ModuleNameSize_> m_name{};
+        std::atomic<LogLevel> m_level{LogLevel::INFO_LEVEL};
+        /// 单独设置过级别,不再跟随全局级别
+        bool m_override{};
+    };
+    static constinit std::array<XLogModule_,64> sm_modules_{};
+    static constinit std::size_t sm_moduleCount_{1};
+    static constinit std::mutex sm_moduleMutex_{};
+
+    /// 需持有sm_moduleMutex_
+    /// @return 模块的表项,create为true时注册新模块,表满或名字过长时返回nullptr
+    static XLogModule_ * findModule_(std::string_view const module,bool const create) noexcept {
+        if (module.empty()) { return std::addressof(sm_modules_[0]); }
+        if (module.size() >= XLog::ModuleNameSize_) { return {}; }
+        for (std::size_t i{1}; i < sm_moduleCount_; ++i) {
+            if (module == sm_modules_[i].m_name.data()) { return std::addressof(sm_modules_[i]); }
+        }
+        if (!create || sm_moduleCount_ >= sm_modules_.size()) { return {}; }
+        auto & entry{sm_modules_[sm_moduleCount_++]};
+        std::memcpy(entry.m_name.data(),module.data(),module.size());
+        entry.m_level.store(sm_modules_[0].m_level.load(std::memory_order_relaxed),std::memory_order_relaxed);
+        return std::addressof(entry);
+    }
+
 void XLog::consoleOut(std::string const & s) noexcept {
     if (instance()) { return; }
     std::cerr << s << std::endl << std::flush;
@@ -26,10 +94,11 @@ XLog::XLog() = default;
 
 XLog::~XLog() {
     X_D(XLog);
+    sm_instance_.store({},std::memory_order_release);
 
     if (d->m_running_.loadRelaxed()) {
-        d->m_shutdown_requested_.storeRelaxed(true);
-        d->m_queue_cv_.notify_all();
+        d->m_shutdown_requested_.storeRelease(true);
+        d->m_wake_sem_.signal();
 
         if (d->m_worker_thread_.joinable())
         { d->m_worker_thread_.join(); }
@@ -48,6 +117,7 @@ bool XLog::construct_() {
 
     try {
         X_D(XLog);
+        d->m_id_ = sm_nextLogId_.fetch_add(1,std::memory_order_relaxed);
         // 确保日志目录存在
         d->ensureLogDirectory();
 
@@ -57,13 +127,19 @@ bool XLog::construct_() {
         // 清理过期的日志文件
         cleanupOldLogFiles();
 
-        // 启动异步处理线程
+        // 启动异步处理线程,时钟在此校准,保证早于任何记录的时间刻度
+        d->m_clock_.calibrate();
+        d->m_anchor_ = d->m_clock_;
+#ifdef X_PLATFORM_LINUX
+        d->m_asymmetric_ = !syscall(__NR_membarrier,MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED,0,0);
+#endif
         d->m_running_.storeRelease(true);
         d->m_worker_thread_ = std::thread(&XLogPrivate::processLogQueue, d);
 
         // 设置崩溃处理器
         if (d->m_crash_diagnostics_.loadRelaxed()) { XLogPrivate::setupCrashHandlers(); }
 
+        sm_instance_.store(this,std::memory_order_release);
         return true;
 
     } catch (std::exception const & e) {
@@ -73,13 +149,48 @@ bool XLog::construct_() {
 }
 
 auto XLog::instance() noexcept -> XLog *
-{ return XSingleton::instance().get(); }
+{ return sm_instance_.load(std::memory_order_acquire); }
 
-void XLog::setLogLevel(LogLevel const & level) noexcept
-{ d_func()->m_log_level_.store(level, std::memory_order_relaxed); }
+void XLog::setLogLevel(LogLevel const & level) noexcept {
+    std::unique_lock lock(sm_moduleMutex_);
+    for (std::size_t i{}; i < sm_moduleCount_; ++i) {
+        if (!sm_modules_[i].m_override) { sm_modules_[i].m_level.store(level, std::memory_order_relaxed); }
+    }
+}
 
 LogLevel XLog::getLogLevel() const noexcept
-{ return d_func()->m_log_level_.load(std::memory_order_relaxed); }
+{ return sm_modules_[0].m_level.load(std::memory_order_relaxed); }
+
+std::atomic<LogLevel> const & XLog::moduleLevel(char const * const module) noexcept {
+    if (!module || !*module) { return sm_modules_[0].m_level; }
+    std::unique_lock lock(sm_moduleMutex_);
+    auto const entry{findModule_(module,true)};
+    return entry ? entry->m_level : sm_modules_[0].m_level;
+}
+
+bool XLog::setModuleLogLevel(std::string_view const & module, LogLevel const & level) noexcept {
+    if (module.empty()) { setLogLevel(level); return true; }
+    std::unique_lock lock(sm_moduleMutex_);
+    auto const entry{findModule_(module,true)};
+    if (!entry) { return {}; }
+    entry->m_override = true;
+    entry->m_level.store(level, std::memory_order_relaxed);
+    return true;
+}
+
+void XLog::resetModuleLogLevel(std::string_view const & module) noexcept {
+    std::unique_lock lock(sm_moduleMutex_);
+    if (auto const entry{findModule_(module,false)}; entry && entry != std::addressof(sm_modules_[0])) {
+        entry->m_override = {};
+        entry->m_level.store(sm_modules_[0].m_level.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+LogLevel XLog::getModuleLogLevel(std::string_view const & module) const noexcept {
+    std::unique_lock lock(sm_moduleMutex_);
+    auto const entry{findModule_(module,false)};
+    return (entry ? entry : std::addressof(sm_modules_[0]))->m_level.load(std::memory_order_relaxed);
+}
 
 void XLog::setOutput(LogOutput const & output) noexcept
 { d_func()->m_output_.store(output, std::memory_order_relaxed); }
@@ -98,7 +209,7 @@ void XLog::setLogFileConfig(std::string_view const & base_name,
 
     // 重新初始化文件
     std::unique_lock file_lock(d->m_file_mutex_);
-    d->m_file_stream_.reset();
+    d->m_file_.close();
     d->m_current_file_size_.storeRelaxed({});
 
     // 确保目录存在并初始化新的日志文件
@@ -108,7 +219,7 @@ void XLog::setLogFileConfig(std::string_view const & base_name,
 }
 
 bool XLog::shouldLog(LogLevel const & level) const noexcept
-{ return level >= d_func()->m_log_level_.load(std::memory_order_relaxed); }
+{ return level >= sm_modules_[0].m_level.load(std::memory_order_relaxed); }
 
 [[maybe_unused]] std::string XLog::getCurrentLogFile() const {
     X_D(const XLog);
@@ -160,11 +271,33 @@ void XLog::cleanupOldLogFiles() const noexcept {
     }
 }
 
+void XLog::setFlushPolicy(LogFlushPolicy const policy, std::chrono::milliseconds const & interval) noexcept {
+    X_D(XLog);
+    d->m_flush_interval_.storeRelaxed(std::max<std::chrono::milliseconds::rep>(interval.count(),1));
+    d->m_flush_policy_.store(policy, std::memory_order_relaxed);
+    d->m_wake_sem_.signal();
+}
+
+void XLog::setTimestampFormat(LogTimePrecision const precision, LogTimestamp const clock) noexcept {
+    X_D(XLog);
+    d->m_time_precision_.store(precision, std::memory_order_relaxed);
+    d->m_time_clock_.store(clock, std::memory_order_relaxed);
+}
+
 void XLog::setColorOutput(bool const enable) noexcept
 { d_func()->m_color_output_.storeRelaxed(enable); }
 
 void XLog::setAsyncQueueSize(std::size_t const size) noexcept
-{ d_func()->m_max_queue_size_.storeRelaxed(size); }
+{ d_func()->m_max_queue_size_.storeRelaxed(size ? size : XLogPrivate::DefaultQueueSize_); }
+
+void XLog::setOverflowPolicy(LogOverflow const policy) noexcept
+{ d_func()->m_overflow_.store(policy, std::memory_order_relaxed); }
+
+LogOverflow XLog::getOverflowPolicy() const noexcept
+{ return d_func()->m_overflow_.load(std::memory_order_relaxed); }
+
+std::size_t XLog::getDroppedCount() const noexcept
+{ return d_func()->m_dropped_.loadRelaxed(); }
 
 void XLog::enableCrashDiagnostics(bool const enable) {
     d_func()->m_crash_diagnostics_.storeRelaxed(enable);
@@ -178,35 +311,24 @@ void XLog::setCrashHandler(CrashHandlerPtr && handler) {
 }
 
 void XLog::log(LogLevel const & level, std::string_view const & message, SourceLocation const & location) {
+    if (shouldLog(level)) { log_(level, message, location); }
+}
 
-    if (!shouldLog(level)) { return; }
-
+void XLog::log_(LogLevel const & level, std::string_view const & message, SourceLocation const & location) {
     try {
         X_D(XLog);
-        // 创建日志消息
-        LogMessage log_msg {
-            level,
-            getCurrentTimestamp(),
-            getCurrentThreadId(),
-            location.m_fileName ? std::filesystem::path(location.m_fileName).filename().string() : "unknown",
-            location.m_line,
-            location.m_functionName ? location.m_functionName : "unknown",
-            std::string(message)
-        };
-
-        std::unique_lock lock(d->m_queue_mutex_);
-
-        // 检查队列大小限制
-        if (const auto max_size{d->m_max_queue_size_.loadRelaxed()}
-            ; max_size > 0 && d->m_log_queue_.size() >= max_size) {
-            // 队列满时丢弃最旧的消息
-            d->m_log_queue_.pop_front();
-        }
-        // 添加到队列
-        d->m_log_queue_.push_back(std::move(log_msg));
-
+        // 只保存原始数据,时间戳、线程id、文件名的格式化由工作线程完成
+        auto & ring{d->currentRing()};
+        auto const tick{std::chrono::steady_clock::now().time_since_epoch().count()};
+        auto const record{d->reserve(ring)};
+        if (!record) { return; }
+        record->m_tick = tick;
+        record->m_location = location;
+        record->m_thread = ring.m_thread;
+        record->m_level = level;
+        record->assign(message);
         // 通知处理线程
-        d->m_queue_cv_.notify_one();
+        d->notifyWorker(ring.publish());
 
     } catch (const std::exception& e) {
         // 如果日志系统本身出错，直接输出到stderr
@@ -214,83 +336,66 @@ void XLog::log(LogLevel const & level, std::string_view const & message, SourceL
     }
 }
 
+void XLog::logEncoded_(LogLevel const & level, const char * const format, SourceLocation const & location, std::size_t const size
+                      , void (* const encode)(char *, void const *) noexcept, void const * const args) {
+    try {
+        X_D(XLog);
+        // 参数已在编译期检查,这里只按类型拷贝原始字节
+        auto & ring{d->currentRing()};
+        auto const tick{std::chrono::steady_clock::now().time_since_epoch().count()};
+        auto const record{d->reserve(ring)};
+        if (!record) { return; }
+        record->m_tick = tick;
+        record->m_location = location;
+        record->m_thread = ring.m_thread;
+        record->m_level = level;
+        encode(record->prepare(size), args);
+        record->m_format = format;
+        d->notifyWorker(ring.publish());
+
+    } catch (const std::exception& e) {
+        std::cerr << "XLog error: " << e.what() << '\n';
+    }
+}
+
 void XLog::flush() {
     // 等待队列清空
     X_D(XLog);
-    std::unique_lock lock(d->m_queue_mutex_);
-    d->m_queue_cv_.wait(lock, [&d] { return d->m_log_queue_.empty(); });
+    static_cast<void>(d->waitFlushed(std::chrono::milliseconds::zero()));
     
-    // 强制刷新文件流
+    // 工作线程已写出全部缓冲,落盘
     std::unique_lock file_lock(d->m_file_mutex_);
-    if (d->m_file_stream_ && d->m_file_stream_->is_open()) {
-        d->m_file_stream_->flush();
-    }
+    d->m_file_.sync();
     std::cout.flush();
     std::cerr.flush();
 }
 
-[[maybe_unused]] bool XLog::waitForCompletion(std::chrono::milliseconds const & timeout) {
-    X_D(XLog);
-    std::unique_lock lock(d->m_queue_mutex_);
-
-    auto const pred { [d]()noexcept{ return d->m_log_queue_.empty(); } };
-
-    if ( std::chrono::milliseconds::zero() == timeout ) {
-        d->m_queue_cv_.wait(lock, pred);
-        return true;
-    }
-    return d->m_queue_cv_.wait_for(lock, timeout,pred);
-}
+[[maybe_unused]] bool XLog::waitForCompletion(std::chrono::milliseconds const & timeout)
+{ return d_func()->waitFlushed(timeout); }
 
 [[maybe_unused]] std::size_t XLog::getQueueSize() const {
     X_D(const XLog);
-    std::shared_lock lock(d->m_queue_mutex_);
-    return d->m_log_queue_.size();
+    std::unique_lock lock(d->m_rings_mutex_);
+    std::size_t size{};
+    for (auto const & ring : d->m_rings_) { size += ring->sizeApprox(); }
+    return size;
 }
 
 std::string XLog::getCurrentTimestamp() {
-    using namespace std::chrono;
-    
-    // 获取当前时间点和毫秒精度
-    auto const now{system_clock::now()};
-    auto const time_t_value{system_clock::to_time_t(now)};
-    auto const ms{duration_cast<milliseconds>(now.time_since_epoch()) % 1000};
-
-    // C++17 RAII线程安全时间格式化器
-    class SafeTimeFormatter {
-        std::tm tm_buffer_{};
-        bool valid_{};
-
-    public:
-        explicit SafeTimeFormatter(std::time_t const & time) {
-            // 优先尝试线程安全的本地时间函数
-#ifdef _WIN32
-            valid_ = !localtime_s(&tm_buffer_, &time);
-            if (!valid_) { valid_ = !gmtime_s(&tm_buffer_, &time); } // Fallback to UTC
-#else
-            // POSIX系统：使用线程安全版本
-            valid_ = localtime_r(&time, &tm_buffer_) != nullptr;
-            if (!valid_) { valid_ = gmtime_r(&time, &tm_buffer_) != nullptr; } // Fallback to UTC
-#endif
-        }
-        // 禁用拷贝和移动，确保线程安全
-        X_DISABLE_COPY_MOVE(SafeTimeFormatter)
-
-        [[nodiscard]] bool is_valid() const noexcept { return valid_; }
-
-        [[nodiscard]] const std::tm * get() const noexcept { return valid_ ? &tm_buffer_ : nullptr;  }
-    };
-
-    // 使用RAII格式化器
-    SafeTimeFormatter const formatter {time_t_value};
-
-    // 如果时间格式化失败，返回固定的错误时间戳
-    if (!formatter.is_valid()) { return {"1970-01-01 00:00:00.000"}; }
+    // 每个线程一份缓存,同一秒内只改写毫秒部分
+    static constinit thread_local XLogTimestamp_ sm_timestamp_{};
+    std::string result{};
+    sm_timestamp_.append(std::chrono::system_clock::now(), LogTimePrecision::MILLISECONDS, result);
+    return result;
+}
 
-    // 使用现代C++17流式语法格式化时间
-    return ( std::ostringstream{} << std::put_time(formatter.get(), "%Y-%m-%d %H:%M:%S")
-                                << '.' << std::setfill('0') << std::setw(3) << ms.count()
-            ).str();
+bool XLog::decodeBinaryLog(std::istream & in, std::ostream & out, LogTimePrecision const precision, LogTimestamp const clock) {
+    try {
+        return XLogBinary_::decode(in, out, precision, clock);
+    } catch (std::exception const & e) {
+        std::cerr << "Failed to decode binary log: " << e.what() << '\n';
+        return {};
+    }
 }
 
 std::string XLog::getCurrentThreadId()
@@ -391,7 +496,7 @@ std::string XLogPrivate::generateLogFileName() const {
     do {
         std::ostringstream oss{};
         oss << m_log_directory_ << "/" << m_log_base_name_ 
-            << "_" << today << "_" << std::setfill('0') << std::setw(3) << sequence << ".log";
+            << "_" << today << "_" << std::setfill('0') << std::setw(3) << sequence << m_file_extension_;
         filename = oss.str();
         ++sequence;
     } while (std::filesystem::exists(filename));
@@ -416,6 +521,9 @@ std::string XLogPrivate::findLatestLogFile() const {
 
             auto const filename{entry.path().filename().string()};
 
+            // 只续写与当前输出格式相同的文件
+            if (!filename.ends_with(m_file_extension_)) { continue; }
+
             if (std::smatch match{}
                 ; std::regex_match(filename, match, log_regex))
             {
@@ -462,10 +570,10 @@ std::string XLogPrivate::getTodayDateString() {
 }
 
 std::string XLogPrivate::getLogFilePattern() const {
-    // 匹配格式：basename_YYYY-MM-DD_NNN.log
+    // 匹配格式：basename_YYYY-MM-DD_NNN.log,二进制日志为.xlb
     // 例如：application_2024-01-15_001.log
     return ( std::ostringstream{}
-        << "(" << m_log_base_name_ << R"()_(\d{4}-\d{2}-\d{2})_(\d{3})\.log)").str();
+        << "(" << m_log_base_name_ << R"()_(\d{4}-\d{2}-\d{2})_(\d{3})\.(log|xlb))").str();
 }
 
 void XLogPrivate::ensureLogDirectory() const {
@@ -478,49 +586,345 @@ void XLogPrivate::ensureLogDirectory() const {
     }
 }
 
-void XLogPrivate::processLogQueue(){
+void XLogRecord_::assign(std::string_view const & message) {
+    std::memcpy(prepare(message.size()),message.data(),message.size());
+    m_format = {};
+}
 
-    while (m_running_.loadAcquire() || !m_log_queue_.empty()) {
+char * XLogRecord_::prepare(std::size_t const size) {
+    m_size = static_cast<xuint32>(size);
+    if (size <= InlineSize_) { return m_inline.data(); }
+    m_overflow.resize(size);
+    return m_overflow.data();
+}
 
-        std::unique_lock lock(m_queue_mutex_);
+void XLogRecord_::takeFrom(XLogRecord_ & other) noexcept {
+    m_tick = other.m_tick;
+    m_location = other.m_location;
+    m_format = other.m_format;
+    m_thread = other.m_thread;
+    m_level = other.m_level;
+    m_size = other.m_size;
+    if (m_size > InlineSize_) { m_overflow.swap(other.m_overflow); }
+    else { std::memcpy(m_inline.data(),other.m_inline.data(),m_size); }
+}
 
-        // 等待新消息或停止信号
-        m_queue_cv_.wait(lock, [this]{
-            return !m_log_queue_.empty() || m_shutdown_requested_.loadAcquire();
-        });
+XLogRing_::XLogRing_(std::size_t const capacity,xuint32 const thread,std::string id)
+    : m_cells_{std::make_unique<Cell_[]>(capacity)},m_mask_{capacity - 1}
+    , m_thread{thread},m_wakeAt{std::max<std::size_t>(std::min(XLogPrivate::BatchSize_,capacity / 2),1)}
+    , m_id{std::move(id)}
+{
+    for (std::size_t i{}; i < capacity; ++i) { m_cells_[i].m_seq.store(i,std::memory_order_relaxed); }
+    m_checkAt_ = m_wakeAt;
+}
 
-        // 处理队列中的所有消息
-        while (!m_log_queue_.empty()) {
-            auto const msg { std::move(m_log_queue_.front()) };
-            m_log_queue_.pop_front();
-            lock.unlock();
+XLogRecord_ * XLogRing_::tryReserve() const noexcept {
+    auto const tail{m_tail_.load(std::memory_order_relaxed)};
+    auto & cell{m_cells_[tail & m_mask_]};
+    // 槽的序号等于生产位置时才可写,否则消费端尚未取走
+    return cell.m_seq.load(std::memory_order_acquire) == tail ? std::addressof(cell.m_record) : nullptr;
+}
 
-            // 处理日志消息
-            const auto output {m_output_.load(std::memory_order_relaxed)};
+bool XLogRing_::publish() noexcept {
+    auto const tail{m_tail_.load(std::memory_order_relaxed) + 1};
+    m_cells_[(tail - 1) & m_mask_].m_seq.store(tail,std::memory_order_release);
+    m_tail_.store(tail,std::memory_order_relaxed);
+    if (tail != m_checkAt_) { return {}; }
+    // 消费位置只增不减,积压未达到时下次检查安排在最早可能达到的位置
+    auto const backlog{tail - std::min(m_head_.load(std::memory_order_relaxed),tail)};
+    m_checkAt_ = tail + (backlog >= m_wakeAt ? m_wakeAt : m_wakeAt - backlog);
+    return backlog >= m_wakeAt;
+}
 
-            if ((output & LogOutput::CONSOLE) != LogOutput{}) { writeToConsole(msg); }
+XLogRing_::Cell_ * XLogRing_::claim_() noexcept {
+    auto head{m_head_.load(std::memory_order_relaxed)};
+    while (true) {
+        auto & cell{m_cells_[head & m_mask_]};
+        auto const diff{static_cast<std::ptrdiff_t>(cell.m_seq.load(std::memory_order_acquire) - (head + 1))};
+        if (diff < 0) { return {}; }
+        if (!diff && m_head_.compare_exchange_weak(head,head + 1,std::memory_order_relaxed))
+        { return std::addressof(cell); }
+        if (diff > 0) { head = m_head_.load(std::memory_order_relaxed); }
+    }
+}
 
-            if ((output & LogOutput::FILE) != LogOutput{}) { writeToFile(msg); }
+bool XLogRing_::pop(XLogRecord_ & record) noexcept {
+    auto const cell{claim_()};
+    if (!cell) { return {}; }
+    record.takeFrom(cell->m_record);
+    cell->m_seq.store(cell->m_seq.load(std::memory_order_relaxed) + m_mask_,std::memory_order_release);
+    return true;
+}
+
+bool XLogRing_::discard() noexcept {
+    auto const cell{claim_()};
+    if (!cell) { return {}; }
+    cell->m_seq.store(cell->m_seq.load(std::memory_order_relaxed) + m_mask_,std::memory_order_release);
+    return true;
+}
+
+std::size_t XLogRing_::sizeApprox() const noexcept {
+    auto const head{m_head_.load(std::memory_order_relaxed)},tail{m_tail_.load(std::memory_order_relaxed)};
+    return tail > head ? tail - head : 0;
+}
+
+XLogRing_ & XLogPrivate::currentRing() {
+    if (sm_logRing_.m_logger == m_id_) { return *sm_logRing_.m_ring; }
 
-            lock.lock();
+    // 每个线程只在第一次写日志时格式化一次线程id
+    auto id{( std::ostringstream{} << std::this_thread::get_id() ).str()};
+    auto const capacity{std::bit_ceil(std::max<std::size_t>(m_max_queue_size_.loadRelaxed(),2))};
+    std::shared_ptr<XLogRing_> ring{};
+    {
+        std::unique_lock lock(m_rings_mutex_);
+        ring = std::make_shared<XLogRing_>(capacity,m_next_thread_++,std::move(id));
+        m_rings_.push_back(ring);
+        m_rings_version_.fetch_add(1,std::memory_order_release);
+    }
+    sm_logRing_ = {m_id_,ring.get()};
+    sm_logRingOwner_.reset(std::move(ring));
+    return *sm_logRing_.m_ring;
+}
+
+std::string_view XLogPrivate::threadId(xuint32 const index) const noexcept
+{ return index < m_thread_ids_.size() ? std::string_view{m_thread_ids_[index]} : std::string_view{"unknown"}; }
+
+XLogRecord_ * XLogPrivate::reserve(XLogRing_ & ring) {
+    while (true) {
+        if (auto const record{ring.tryReserve()}) { return record; }
+
+        switch (m_shutdown_requested_.loadAcquire() ? LogOverflow::DROP_NEWEST : m_overflow_.load(std::memory_order_relaxed)) {
+            case LogOverflow::BLOCK:
+                // 不加锁,唤醒工作线程后让出CPU直到腾出空间
+                m_wake_sem_.signal();
+                std::this_thread::yield();
+                break;
+            case LogOverflow::DROP_NEWEST:
+                m_dropped_.fetchAndAddRelaxed(1);
+                return {};
+            case LogOverflow::DROP_OLDEST:
+                // 可能与工作线程同时取走同一条,失败后重试即可
+                if (ring.discard()) { m_dropped_.fetchAndAddRelaxed(1); }
+                break;
+        }
+    }
+}
+
+void XLogPrivate::notifyWorker(bool const backlog) noexcept {
+    // 与工作线程先置空闲标志再检查队列构成Dekker式同步,保证不会漏掉唤醒
+    if (m_asymmetric_) { std::atomic_signal_fence(std::memory_order_seq_cst); }
+    else { std::atomic_thread_fence(std::memory_order_seq_cst); }
+    if (m_worker_idle_.load(std::memory_order_relaxed) && m_worker_idle_.exchange(false,std::memory_order_relaxed))
+    { m_wake_sem_.signal(); return; }
+    if (backlog) { m_wake_sem_.signal(); }
+}
+
+void XLogPrivate::idleBarrier() const noexcept {
+#ifdef X_PLATFORM_LINUX
+    // 令所有正在运行的生产线程执行一次完整屏障,注册成功后不会失败
+    if (m_asymmetric_) { static_cast<void>(syscall(__NR_membarrier,MEMBARRIER_CMD_PRIVATE_EXPEDITED,0,0)); return; }
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool XLogPrivate::waitFlushed(std::chrono::milliseconds const & timeout) {
+    auto const ticket{m_flush_requested_.fetch_add(1) + 1};
+    m_wake_sem_.signal();
+    std::unique_lock lock(m_flush_mutex_);
+    auto const pred{[this,ticket]{ return m_flush_done_ >= ticket; }};
+    if (std::chrono::milliseconds::zero() == timeout) {
+        m_flush_cv_.wait(lock,pred);
+        return true;
+    }
+    return m_flush_cv_.wait_for(lock,timeout,pred);
+}
+
+void XLogPrivate::processLogQueue(){
+
+    using namespace std::chrono;
+
+    std::vector<std::shared_ptr<XLogRing_>> rings{};
+    std::vector<XLogRecord_> fronts{};
+    std::size_t version{};
+    xuint64 flushed{};
+    m_file_buffer_.reserve(FileBufferSize_ + XLogRecord_::InlineSize_ * 2);
+
+    auto const refresh{[&]{
+        std::unique_lock lock(m_rings_mutex_);
+        version = m_rings_version_.load(std::memory_order_acquire);
+        rings = m_rings_;
+        for (auto const & ring : rings) {
+            if (ring->m_thread >= m_thread_ids_.size()) { m_thread_ids_.resize(ring->m_thread + 1); }
+            if (m_thread_ids_[ring->m_thread].empty()) { m_thread_ids_[ring->m_thread] = ring->m_id; }
+        }
+    }};
+
+    while (true) {
+        auto const ticket{m_flush_requested_.load(std::memory_order_acquire)};
+        auto const shutdown{m_shutdown_requested_.loadAcquire()};
+
+        if (m_rings_version_.load(std::memory_order_acquire) != version) { refresh(); }
+
+        auto const count{drainRings(rings,fronts)};
+        // flush与停止时写出全部缓冲
+        commitFile(true,ticket != flushed || shutdown);
+
+        // 移除线程已退出且已取空的队列
+        if (std::ranges::any_of(rings,[](auto const & ring){ return ring->m_closed.load(std::memory_order_acquire) && !ring->sizeApprox(); })) {
+            std::unique_lock lock(m_rings_mutex_);
+            std::erase_if(m_rings_,[](auto const & ring){ return ring->m_closed.load(std::memory_order_acquire) && !ring->sizeApprox(); });
+            m_rings_version_.fetch_add(1,std::memory_order_release);
         }
 
         // 通知等待队列清空的线程
-        m_queue_cv_.notify_all();
+        if (ticket != flushed) {
+            flushed = ticket;
+            std::unique_lock lock(m_flush_mutex_);
+            m_flush_done_ = ticket;
+            m_flush_cv_.notify_all();
+        }
+
+        if (shutdown) { break; }
 
-        if (m_shutdown_requested_.loadAcquire()) { break; }
+        // 先限时攒批,避免每条记录唤醒一次
+        if (count) {
+            static_cast<void>(m_wake_sem_.wait(duration_cast<microseconds>(Linger_).count()));
+            continue;
+        }
+
+        // 一轮没有取到记录,置空闲标志后再检查一次,仍为空则无限等待新消息或停止信号
+        m_worker_idle_.store(true,std::memory_order_relaxed);
+        idleBarrier();
+        if (m_rings_version_.load(std::memory_order_acquire) == version
+            && std::ranges::none_of(rings,[](auto const & ring){ return ring->sizeApprox(); })
+            && m_flush_requested_.load(std::memory_order_acquire) == flushed
+            && !m_shutdown_requested_.loadAcquire())
+        {
+            // 缓冲中还有按间隔写入的记录时只等到写入时间
+            if (auto const deadline{fileDeadline()}; deadline == steady_clock::time_point::max())
+            { static_cast<void>(m_wake_sem_.wait()); }
+            else {
+                auto const timeout{duration_cast<microseconds>(deadline - steady_clock::now()).count()};
+                static_cast<void>(m_wake_sem_.wait(std::max<std::int64_t>(timeout,0)));
+            }
+        }
+        m_worker_idle_.store(false,std::memory_order_relaxed);
     }
+
+    // 工作线程退出后flush不再等待
+    std::unique_lock lock(m_flush_mutex_);
+    m_flush_done_ = std::numeric_limits<xuint64>::max();
+    m_flush_cv_.notify_all();
 }
 
-void XLogPrivate::writeToConsole(const LogMessage& msg) const {
+std::size_t XLogPrivate::drainRings(std::vector<std::shared_ptr<XLogRing_>> const & rings,std::vector<XLogRecord_> & fronts) {
+
+    using namespace std::chrono;
+
+    // fronts[i]为rings[i]已取出尚未输出的最旧记录
+    if (fronts.size() < rings.size()) { fronts.resize(rings.size()); }
+    std::vector<bool> loaded(rings.size());
+    std::size_t count{};
+
+    while (true) {
+        std::size_t next{rings.size()};
+        for (std::size_t i{}; i < rings.size(); ++i) {
+            if (!loaded[i]) { loaded[i] = rings[i]->pop(fronts[i]); }
+            if (loaded[i] && (next == rings.size() || fronts[i].m_tick < fronts[next].m_tick)) { next = i; }
+        }
+        if (next == rings.size()) { return count; }
 
-    if (auto const formatted{formatLogMessage(msg)}
-        ;m_color_output_.loadRelaxed())
+        if (!(count % BatchSize_) && steady_clock::now() - m_clock_.lastCalibration() >= seconds{1})
+        { m_clock_.calibrate(); }
+
+        writeRecord(fronts[next]);
+        loaded[next] = false;
+        ++count;
+        commitFile(false,false);
+    }
+}
+
+void XLogPrivate::writeRecord(XLogRecord_ const & record) {
+    // 处理日志消息
+    const auto output {m_output_.load(std::memory_order_relaxed)};
+    auto const console{(output & LogOutput::CONSOLE) != LogOutput{}}
+            ,file{(output & LogOutput::FILE) != LogOutput{}}
+            ,binary{(output & LogOutput::BINARY) == LogOutput::BINARY};
+
+    // 切换文本与二进制前先写出缓冲,之后的记录写入对应扩展名的文件
+    if (file && binary != m_file_binary_) {
+        commitFile(true,true);
+        m_file_binary_ = binary;
+    }
+
+    if (!file || binary) {
+        if (console) {
+            m_line_.clear();
+            formatRecord(record,m_line_);
+            writeToConsole(record.m_level,m_line_);
+        }
+        if (file) {
+            m_binary_.append(record,m_clock_,threadId(record.m_thread),m_file_buffer_);
+            ++m_file_records_;
+            m_file_urgent_ = m_file_urgent_ || record.m_level >= LogLevel::ERROR_LEVEL;
+            m_file_sync_ = m_file_sync_ || record.m_level >= LogLevel::FATAL_LEVEL;
+        }
+        return;
+    }
+
+    // 直接格式化到文件缓冲,控制台输出同一段内容
+    auto const start{m_file_buffer_.size()};
+    formatRecord(record,m_file_buffer_);
+    if (console) { writeToConsole(record.m_level,std::string_view{m_file_buffer_}.substr(start)); }
+    m_file_buffer_ += '\n';
+    ++m_file_records_;
+    m_file_urgent_ = m_file_urgent_ || record.m_level >= LogLevel::ERROR_LEVEL;
+    m_file_sync_ = m_file_sync_ || record.m_level >= LogLevel::FATAL_LEVEL;
+}
+
+void XLogPrivate::commitFile(bool const end_of_pass,bool const force) {
+
+    if (m_file_buffer_.empty()) { return; }
+
+    // 缓冲区满、FATAL、flush时总是写入,其余由策略决定
+    auto write{force || m_file_sync_ || m_file_buffer_.size() >= FileBufferSize_};
+    if (!write) {
+        switch (m_flush_policy_.load(std::memory_order_relaxed)) {
+            case LogFlushPolicy::EVERY_BATCH:
+                write = end_of_pass || m_file_records_ >= BatchSize_;
+                break;
+            case LogFlushPolicy::INTERVAL:
+                // 每64条才读一次时钟
+                write = (end_of_pass || !(m_file_records_ % 64)) && std::chrono::steady_clock::now() >= fileDeadline();
+                break;
+            case LogFlushPolicy::ON_ERROR:
+                write = m_file_urgent_;
+                break;
+        }
+    }
+    if (!write) { return; }
+
+    writeToFile(m_file_buffer_,m_file_sync_);
+    m_file_buffer_.clear();
+    m_file_records_ = {};
+    m_file_urgent_ = m_file_sync_ = false;
+    m_file_written_ = std::chrono::steady_clock::now();
+}
+
+std::chrono::steady_clock::time_point XLogPrivate::fileDeadline() const noexcept {
+    if (m_file_buffer_.empty() || LogFlushPolicy::INTERVAL != m_flush_policy_.load(std::memory_order_relaxed))
+    { return std::chrono::steady_clock::time_point::max(); }
+    return m_file_written_ + std::chrono::milliseconds{m_flush_interval_.loadRelaxed()};
+}
+
+void XLogPrivate::writeToConsole(LogLevel const level,std::string_view const & formatted) const {
+
+    if (m_color_output_.loadRelaxed())
     {
         // 添加颜色代码
         std::string_view color_code{};
 
-        switch (msg.level) {
+        switch (level) {
             case LogLevel::TRACE_LEVEL: color_code = "\033[37m"; break;  // 白色
             case LogLevel::DEBUG_LEVEL: color_code = "\033[36m"; break;  // 青色
             case LogLevel::INFO_LEVEL:  color_code = "\033[32m"; break;  // 绿色
@@ -531,39 +935,41 @@ void XLogPrivate::writeToConsole(const LogMessage& msg) const {
 
         constexpr std::string_view reset_code {"\033[0m"};
 
-        msg.level >= LogLevel::ERROR_LEVEL ?
+        level >= LogLevel::ERROR_LEVEL ?
             std::cerr << color_code << formatted << reset_code << '\n':
                 std::cout << color_code << formatted << reset_code << '\n';
 
     } else {
-        msg.level >= LogLevel::ERROR_LEVEL ?
+        level >= LogLevel::ERROR_LEVEL ?
             std::cerr << formatted << '\n' :
                 std::cout << formatted << '\n';
     }
 }
 
-void XLogPrivate::writeToFile(LogMessage const & msg) {
+void XLogPrivate::writeToFile(std::string_view const & data,bool const sync) {
 
     std::unique_lock lock(m_file_mutex_);
 
-    // 检查是否需要轮转文件
-    if (shouldRotateFile()) { rotateLogFile(); }
+    // 文本与二进制使用不同扩展名的文件
+    if (auto const extension{m_file_binary_ ? XLogBinary_::Extension_ : TextExtension_}
+        ; extension != m_file_extension_)
+    {
+        m_file_.close();
+        m_file_extension_ = extension;
+        initializeLogFile();
+    }
 
-    // 打开文件流（如果需要）
-    if (!m_file_stream_ || !m_file_stream_->is_open()) {
+    // 检查是否需要轮转文件,以批为单位,文件可能超出上限不到一批
+    if (shouldRotateFile()) { rotateLogFile(); }
 
-        // 检查智能指针是否创建成功
-        if (m_file_stream_ = makeUnique<std::ofstream>(m_current_log_file_, std::ios::app)
-                ;!m_file_stream_)
-        {
-            std::cerr << "Failed to create file stream for: " << m_current_log_file_ << '\n';
-            return;
-        }
+    // 打开文件（如果需要）
+    if (!m_file_.isOpen()) {
 
-        if (!m_file_stream_->is_open()) {
+        if (!m_file_.open(m_current_log_file_)) {
             std::cerr << "Failed to open log file: " << m_current_log_file_ << '\n';
             return;
         }
+        m_anchor_pending_ = true;
 
         // 获取当前文件大小
         try {
@@ -574,38 +980,486 @@ void XLogPrivate::writeToFile(LogMessage const & msg) {
         }
     }
 
-    // 写入日志前再次检查文件流的有效性
-    if (!m_file_stream_ || !m_file_stream_->is_open()) {
-        std::cerr << "File stream is not available for writing\n";
-        return;
+    // 二进制文件的每一段以文件头和全部定义开始,保证单个文件可以独立解码
+    if (m_anchor_pending_ && m_file_binary_) {
+        m_line_.clear();
+        m_binary_.preamble(m_line_);
+        if (m_file_.append(m_line_)) { m_current_file_size_.fetchAndAddRelaxed(m_line_.size()); }
+    }
+    // MONOTONIC时间戳在每个文件开头(或切换后)写入一次锚点
+    else if (m_anchor_pending_ && LogTimestamp::MONOTONIC == m_last_clock_) {
+        m_line_.clear();
+        appendAnchor(m_timestamp_,m_anchor_.systemAtCalibration(),m_time_precision_.load(std::memory_order_relaxed),m_line_);
+        if (m_file_.append(m_line_)) { m_current_file_size_.fetchAndAddRelaxed(m_line_.size()); }
     }
+    m_anchor_pending_ = false;
 
-    // 写入日志
-    auto const formatted{formatLogMessage(msg)};
-    *m_file_stream_ << formatted << '\n';
-    m_file_stream_->flush();
+    // 整批一次写入
+    if (!m_file_.append(data)) {
+        std::cerr << "Failed to write log file: " << m_current_log_file_ << '\n';
+    }
+    if (sync) { m_file_.sync(); }
 
     // 更新文件大小
-    m_current_file_size_.fetchAndAddRelaxed(formatted.length() + 1);
+    m_current_file_size_.fetchAndAddRelaxed(data.length());
 }
 
-std::string XLogPrivate::formatLogMessage(const LogMessage& msg)  {
-    return (
-        std::ostringstream {} << "[" << msg.timestamp << "] "
-                             << "[" << XLog::getLevelName(msg.level) << "] "
-                             << "[" << msg.thread_id << "] "
-                             << msg.file << ":" << msg.line << " "
-                             << msg.function << "() - "
-                             << msg.message
-        ).str();
+bool XLogFile_::open(std::string const & path) noexcept {
+    close();
+#ifdef _WIN32
+    if (fopen_s(&m_file_, path.c_str(), "ab")) { m_file_ = {}; }
+#else
+    m_file_ = std::fopen(path.c_str(), "ab");
+#endif
+    // 不使用stdio缓冲,每次append为一次write调用
+    if (m_file_) { std::setvbuf(m_file_, nullptr, _IONBF, 0); }
+    return m_file_;
 }
 
-void XLogPrivate::rotateLogFile() {
+void XLogFile_::close() noexcept {
+    if (m_file_) { std::fclose(std::exchange(m_file_, {})); }
+}
+
+bool XLogFile_::append(std::string_view const & data) noexcept
+{ return m_file_ && std::fwrite(data.data(), 1, data.size(), m_file_) == data.size(); }
+
+void XLogFile_::sync() const noexcept {
+    if (!m_file_) { return; }
+    std::fflush(m_file_);
+#ifdef _WIN32
+    _commit(_fileno(m_file_));
+#else
+    fsync(fileno(m_file_));
+#endif
+}
+
+void XLogPrivate::formatRecord(XLogRecord_ const & record,std::string & out) {
+
+    // 切换到MONOTONIC后,下一次写文件前补写锚点
+    if (auto const clock{m_time_clock_.load(std::memory_order_relaxed)}; clock != m_last_clock_) {
+        m_last_clock_ = clock;
+        m_anchor_pending_ = LogTimestamp::MONOTONIC == clock;
+    }
+    auto const precision{m_time_precision_.load(std::memory_order_relaxed)};
+
+    out += '[';
+    if (LogTimestamp::MONOTONIC == m_last_clock_) {
+        XLogTimestamp_::appendElapsed(std::chrono::steady_clock::duration{record.m_tick} - m_anchor_.lastCalibration().time_since_epoch(),precision,out);
+    } else {
+        m_timestamp_.append(m_clock_.toSystem(record.m_tick),precision,out);
+    }
+    out += ']';
+    appendHeader(record.m_level,threadId(record.m_thread),logFileName_(record.m_location.m_fileName),record.m_location.m_line
+        ,record.m_location.m_functionName ? record.m_location.m_functionName : "unknown",out);
+    appendMessage(record.m_format,record.text(),out);
+}
+
+void XLogPrivate::appendHeader(LogLevel const level,std::string_view const & thread,std::string_view const & file
+                              ,xuint32 const line,std::string_view const & function,std::string & out) {
+    std::array<char,16> digits{};
+    auto const digits_end{std::to_chars(digits.data(),digits.data() + digits.size(),line).ptr};
+    out += " [";
+    out += XLog::getLevelName(level);
+    out += "] [";
+    out += thread;
+    out += "] ";
+    out += file;
+    out += ':';
+    out.append(digits.data(),digits_end);
+    out += ' ';
+    out += function;
+    out += "() - ";
+}
+
+void XLogPrivate::appendMessage(char const * const format,std::string_view const & payload,std::string & out) {
+    if (format) { XPrivate::appendLogFormat_(format,payload,out); }
+    else { out += payload; }
+}
 
-    if (m_file_stream_ && m_file_stream_->is_open()) {
-        m_file_stream_->close();
-        m_file_stream_.reset();
+void XPrivate::appendLogFormat_(std::string_view const format,std::string_view args,std::string & out) {
+
+    // 按标记读取下一个参数,编码由同一程序的encodeLogArg_产生,标记不符时返回INVALID
+    struct Arg_ final { LogArg_ m_kind{}; std::int64_t m_signed{}; std::uint64_t m_unsigned{};
+                        double m_double{}; long double m_long_double{}; void const * m_pointer{}; char const * m_string{}; };
+    auto const next{[&args]() noexcept {
+        Arg_ arg{};
+        auto const get{[&args](auto & value) noexcept {
+            if (args.size() < sizeof(value)) { return false; }
+            std::memcpy(std::addressof(value),args.data(),sizeof(value));
+            args.remove_prefix(sizeof(value));
+            return true;
+        }};
+        if (args.empty()) { return arg; }
+        auto const kind{static_cast<LogArg_>(args.front())};
+        args.remove_prefix(1);
+        bool ok{};
+        switch (kind) {
+            case LogArg_::SIGNED: ok = get(arg.m_signed); break;
+            case LogArg_::UNSIGNED: ok = get(arg.m_unsigned); break;
+            case LogArg_::DOUBLE: ok = get(arg.m_double); break;
+            case LogArg_::LONG_DOUBLE: ok = get(arg.m_long_double); break;
+            case LogArg_::POINTER: ok = get(arg.m_pointer); break;
+            case LogArg_::STRING: {
+                std::uint32_t size{};
+                if ((ok = get(size) && args.size() > size)) {
+                    arg.m_string = args.data();
+                    args.remove_prefix(size + 1);
+                }
+                break;
+            }
+            default: break;
+        }
+        if (ok) { arg.m_kind = kind; }
+        return arg;
+    }};
+    auto const integer{[](Arg_ const & arg) noexcept {
+        return static_cast<int>(LogArg_::UNSIGNED == arg.m_kind ? static_cast<std::int64_t>(arg.m_unsigned) : arg.m_signed);
+    }};
+
+    // 单个转换说明的格式化结果先写入栈上缓冲区,放不下时直接写入out
+    auto const print{[&out](char const * const spec,auto const & ... values) {
+        std::array<char,128> buffer{};
+        auto const n{std::snprintf(buffer.data(),buffer.size(),spec,values...)};
+        if (n < 0) { return; }
+        if (static_cast<std::size_t>(n) < buffer.size()) { out.append(buffer.data(),static_cast<std::size_t>(n)); return; }
+        auto const size{out.size()};
+        out.resize(size + static_cast<std::size_t>(n));
+        std::snprintf(out.data() + size,static_cast<std::size_t>(n) + 1,spec,values...);
+    }};
+
+    std::size_t literal{};
+    for (auto pos{format.find('%')}; pos != std::string_view::npos; pos = format.find('%',literal)) {
+        out.append(format.substr(literal,pos - literal));
+        auto const spec{parseLogSpec_(format,pos)};
+        literal = spec.m_end;
+        if ('%' == spec.m_conversion) { out += '%'; continue; }
+
+        Arg_ width{},precision{};
+        if (spec.m_starWidth) { width = next(); }
+        if (spec.m_starPrecision) { precision = next(); }
+        auto const arg{next()};
+        if (!spec.m_conversion || !acceptsLogArg_(spec.m_conversion,arg.m_kind)
+            || (spec.m_starWidth && !acceptsLogArg_('d',width.m_kind))
+            || (spec.m_starPrecision && !acceptsLogArg_('d',precision.m_kind)))
+        { out.append(format.substr(pos,spec.m_end - pos)); continue; }
+
+        // 重建说明:原有的标志、宽度、精度,加上与编码类型一致的长度修饰符
+        std::array<char,32> rebuilt{};
+        auto const head{format.substr(pos,std::min<std::size_t>(spec.m_length - pos,rebuilt.size() - 4))};
+        std::memcpy(rebuilt.data(),head.data(),head.size());
+        auto tail{rebuilt.data() + head.size()};
+        if ('c' != spec.m_conversion && (LogArg_::SIGNED == arg.m_kind || LogArg_::UNSIGNED == arg.m_kind))
+        { *tail++ = 'l'; *tail++ = 'l'; }
+        else if (LogArg_::LONG_DOUBLE == arg.m_kind) { *tail++ = 'L'; }
+        *tail = spec.m_conversion;
+
+        auto const emit{[&](auto const value) {
+            if (spec.m_starWidth && spec.m_starPrecision) { print(rebuilt.data(),integer(width),integer(precision),value); }
+            else if (spec.m_starWidth) { print(rebuilt.data(),integer(width),value); }
+            else if (spec.m_starPrecision) { print(rebuilt.data(),integer(precision),value); }
+            else { print(rebuilt.data(),value); }
+        }};
+        switch (arg.m_kind) {
+            case LogArg_::SIGNED:
+                if ('c' == spec.m_conversion) { emit(static_cast<int>(arg.m_signed)); }
+                else { emit(static_cast<long long>(arg.m_signed)); }
+                break;
+            case LogArg_::UNSIGNED:
+                if ('c' == spec.m_conversion) { emit(static_cast<int>(arg.m_unsigned)); }
+                else { emit(static_cast<unsigned long long>(arg.m_unsigned)); }
+                break;
+            case LogArg_::DOUBLE: emit(arg.m_double); break;
+            case LogArg_::LONG_DOUBLE: emit(arg.m_long_double); break;
+            case LogArg_::POINTER: emit(arg.m_pointer); break;
+            case LogArg_::STRING: emit(arg.m_string); break;
+            default: break;
+        }
     }
+    out.append(format.substr(std::min(literal,format.size())));
+}
+
+void XLogPrivate::appendAnchor(XLogTimestamp_ & timestamp,std::chrono::system_clock::time_point const & anchor
+                              ,LogTimePrecision const precision,std::string & out) {
+    out += '[';
+    timestamp.append(anchor,precision,out);
+    out += "] [ANCHOR] monotonic timestamps are seconds since this time\n";
+}
+
+void XLogTimestamp_::writeDigits(char * const first,std::size_t width,std::uint64_t value) noexcept {
+    while (width) {
+        first[--width] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+void XLogTimestamp_::append(std::chrono::system_clock::time_point const & tp,LogTimePrecision const precision,std::string & out) {
+    using namespace std::chrono;
+
+    auto const second{floor<seconds>(tp)};
+
+    // 跨秒时才重新生成前缀
+    if (auto const count{second.time_since_epoch().count()}; count != m_second_) {
+        m_second_ = count;
+        auto const time_t_value{system_clock::to_time_t(second)};
+        std::tm tm_buffer{};
+#ifdef _WIN32
+        auto valid {!localtime_s(&tm_buffer, &time_t_value)};
+        if (!valid) { valid = !gmtime_s(&tm_buffer, &time_t_value); } // Fallback to UTC
+#else
+        auto valid {localtime_r(&time_t_value, &tm_buffer) != nullptr};
+        if (!valid) { valid = gmtime_r(&time_t_value, &tm_buffer) != nullptr; } // Fallback to UTC
+#endif
+        if (!valid) { tm_buffer = {}; tm_buffer.tm_year = 70; tm_buffer.tm_mday = 1; }
+
+        auto const p{m_prefix_.data()};
+        writeDigits(p,4,static_cast<std::uint64_t>(tm_buffer.tm_year + 1900));
+        p[4] = '-';
+        writeDigits(p + 5,2,static_cast<std::uint64_t>(tm_buffer.tm_mon + 1));
+        p[7] = '-';
+        writeDigits(p + 8,2,static_cast<std::uint64_t>(tm_buffer.tm_mday));
+        p[10] = ' ';
+        writeDigits(p + 11,2,static_cast<std::uint64_t>(tm_buffer.tm_hour));
+        p[13] = ':';
+        writeDigits(p + 14,2,static_cast<std::uint64_t>(tm_buffer.tm_min));
+        p[16] = ':';
+        writeDigits(p + 17,2,static_cast<std::uint64_t>(tm_buffer.tm_sec));
+    }
+
+    // 只改写小数部分
+    auto const digits{static_cast<std::size_t>(precision)};
+    auto const fraction{static_cast<std::uint64_t>(duration_cast<nanoseconds>(tp - second).count()) / Pow10_[9 - digits]};
+    std::array<char,PrefixSize_ + 10> buffer;
+    std::memcpy(buffer.data(),m_prefix_.data(),PrefixSize_);
+    buffer[PrefixSize_] = '.';
+    writeDigits(buffer.data() + PrefixSize_ + 1,digits,fraction);
+    out.append(buffer.data(),PrefixSize_ + 1 + digits);
+}
+
+void XLogTimestamp_::appendElapsed(std::chrono::nanoseconds const & elapsed,LogTimePrecision const precision,std::string & out) {
+    auto const negative{elapsed.count() < 0};
+    auto const ns{static_cast<std::uint64_t>(negative ? -elapsed.count() : elapsed.count())};
+    auto const digits{static_cast<std::size_t>(precision)};
+
+    std::array<char,32> buffer;
+    buffer[0] = negative ? '-' : '+';
+    auto const end{std::to_chars(buffer.data() + 1,buffer.data() + 21,ns / Pow10_[9]).ptr};
+    *end = '.';
+    writeDigits(end + 1,digits,ns % Pow10_[9] / Pow10_[9 - digits]);
+    out.append(buffer.data(),end + 1 + digits);
+}
+
+void XLogBinary_::putVarint(std::string & out,std::uint64_t value) {
+    std::array<char,10> buffer;
+    std::size_t size{};
+    while (value >= 0x80) {
+        buffer[size++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buffer[size++] = static_cast<char>(value);
+    out.append(buffer.data(),size);
+}
+
+void XLogBinary_::putSigned(std::string & out,std::int64_t const value)
+{ putVarint(out,static_cast<std::uint64_t>(value) << 1 ^ static_cast<std::uint64_t>(value >> 63)); }
+
+void XLogBinary_::putString(std::string & out,std::string_view const & value) {
+    putVarint(out,value.size());
+    out += value;
+}
+
+void XLogBinary_::putClock(std::string & out,XLogClock_ const & clock) {
+    using namespace std::chrono;
+    out += static_cast<char>(Tag_::CLOCK);
+    putSigned(out,duration_cast<nanoseconds>(clock.lastCalibration().time_since_epoch()).count());
+    putSigned(out,duration_cast<nanoseconds>(clock.systemAtCalibration().time_since_epoch()).count());
+}
+
+void XLogBinary_::append(XLogRecord_ const & record,XLogClock_ const & clock,std::string_view const & thread,std::string & out) {
+
+    using namespace std::chrono;
+
+    // 记下缓冲开始时的状态,缓冲写入新文件时由preamble补写
+    if (out.empty()) { m_base_ = m_tick_; m_base_clock_ = m_clock_; }
+
+    if (clock.lastCalibration() != m_clock_.lastCalibration()) {
+        m_clock_ = clock;
+        putClock(out,clock);
+    }
+
+    if (record.m_thread >= m_threads_.size()) { m_threads_.resize(record.m_thread + 1); }
+    if (!m_threads_[record.m_thread]) {
+        m_threads_[record.m_thread] = true;
+        auto const begin{out.size()};
+        out += static_cast<char>(Tag_::THREAD);
+        putVarint(out,record.m_thread);
+        putString(out,thread);
+        m_table_.append(out,begin);
+    }
+
+    auto const & location{record.m_location};
+    auto const [site,inserted]{m_sites_.try_emplace(Site_{location.m_fileName,location.m_functionName,record.m_format,location.m_line}
+                                                    ,static_cast<xuint32>(m_sites_.size()))};
+    if (inserted) {
+        auto const begin{out.size()};
+        out += static_cast<char>(Tag_::SITE);
+        putVarint(out,site->second);
+        putVarint(out,location.m_line);
+        out += static_cast<char>(record.m_format ? 1 : 0);
+        putString(out,logFileName_(location.m_fileName));
+        putString(out,location.m_functionName ? location.m_functionName : "unknown");
+        if (record.m_format) { putString(out,record.m_format); }
+        m_table_.append(out,begin);
+    }
+
+    auto const tick{duration_cast<nanoseconds>(steady_clock::duration{record.m_tick}).count()};
+    out += static_cast<char>(record.m_level);
+    putSigned(out,tick - m_tick_);
+    m_tick_ = tick;
+    putVarint(out,record.m_thread);
+    putVarint(out,site->second);
+    putString(out,record.text());
+}
+
+void XLogBinary_::preamble(std::string & out) const {
+    out += Magic_;
+    if (m_base_clock_.lastCalibration() != std::chrono::steady_clock::time_point{}) { putClock(out,m_base_clock_); }
+    out += static_cast<char>(Tag_::BASE);
+    putSigned(out,m_base_);
+    out += m_table_;
+}
+
+bool XLogBinary_::decode(std::istream & in,std::ostream & out,LogTimePrecision const precision,LogTimestamp const clock_type) {
+
+    using namespace std::chrono;
+
+    struct Site_ final {
+        std::string m_file{},m_function{},m_format{};
+        xuint32 m_line{};
+        bool m_formatted{},m_defined{};
+    };
+
+    // 序号上限,防止损坏的输入导致过大的分配
+    constexpr std::uint64_t MaxIndex_{1 << 24};
+
+    std::string const data{std::istreambuf_iterator<char>{in},std::istreambuf_iterator<char>{}};
+    std::string_view input{data};
+    std::vector<Site_> sites{};
+    std::vector<std::string> threads{};
+    XLogClock_ clock{};
+    XLogTimestamp_ timestamp{};
+    std::int64_t tick{},anchor{};
+    bool anchored{};
+    std::string line{};
+
+    auto const getVarint{[&input](std::uint64_t & value) noexcept {
+        value = {};
+        for (unsigned shift{}; shift < 64 && !input.empty(); shift += 7) {
+            auto const byte{static_cast<unsigned char>(input.front())};
+            input.remove_prefix(1);
+            value |= std::uint64_t{byte & 0x7fu} << shift;
+            if (!(byte & 0x80)) { return true; }
+        }
+        return false;
+    }};
+    auto const getSigned{[&getVarint](std::int64_t & value) noexcept {
+        std::uint64_t raw{};
+        if (!getVarint(raw)) { return false; }
+        value = static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1);
+        return true;
+    }};
+    auto const getString{[&input,&getVarint](std::string_view & value) noexcept {
+        std::uint64_t size{};
+        if (!getVarint(size) || size > input.size()) { return false; }
+        value = input.substr(0,size);
+        input.remove_prefix(size);
+        return true;
+    }};
+    auto const steady{[](std::int64_t const ns) noexcept
+    { return steady_clock::time_point{duration_cast<steady_clock::duration>(nanoseconds{ns})}; }};
+
+    if (!input.starts_with(Magic_)) { return {}; }
+
+    while (!input.empty()) {
+        // 续写的每一段重新定义全部线程与调用点
+        if (input.starts_with(Magic_)) {
+            input.remove_prefix(Magic_.size());
+            sites.clear();
+            threads.clear();
+            anchored = false;
+            continue;
+        }
+
+        auto const tag{static_cast<xuint8>(input.front())};
+        input.remove_prefix(1);
+        switch (static_cast<Tag_>(tag)) {
+            case Tag_::CLOCK: {
+                std::int64_t steady_ns{},system_ns{};
+                if (!getSigned(steady_ns) || !getSigned(system_ns)) { return {}; }
+                clock.calibrate(steady(steady_ns),system_clock::time_point{duration_cast<system_clock::duration>(nanoseconds{system_ns})});
+                // MONOTONIC时以每段第一次校准为锚点
+                if (LogTimestamp::MONOTONIC == clock_type && !anchored) {
+                    anchored = true;
+                    anchor = steady_ns;
+                    line.clear();
+                    XLogPrivate::appendAnchor(timestamp,clock.systemAtCalibration(),precision,line);
+                    out << line;
+                }
+                break;
+            }
+            case Tag_::BASE:
+                if (!getSigned(tick)) { return {}; }
+                break;
+            case Tag_::THREAD: {
+                std::uint64_t index{};
+                std::string_view id{};
+                if (!getVarint(index) || index >= MaxIndex_ || !getString(id)) { return {}; }
+                if (index >= threads.size()) { threads.resize(index + 1); }
+                threads[index] = id;
+                break;
+            }
+            case Tag_::SITE: {
+                std::uint64_t index{},line_number{};
+                std::string_view file{},function{},format{};
+                if (!getVarint(index) || index >= MaxIndex_ || !getVarint(line_number) || input.empty()) { return {}; }
+                auto const formatted{0 != input.front()};
+                input.remove_prefix(1);
+                if (!getString(file) || !getString(function) || (formatted && !getString(format))) { return {}; }
+                if (index >= sites.size()) { sites.resize(index + 1); }
+                sites[index] = {std::string{file},std::string{function},std::string{format},static_cast<xuint32>(line_number),formatted,true};
+                break;
+            }
+            default: {
+                if (tag > static_cast<xuint8>(LogLevel::FATAL_LEVEL)) { return {}; }
+                std::int64_t delta{};
+                std::uint64_t thread{},index{};
+                std::string_view payload{};
+                if (!getSigned(delta) || !getVarint(thread) || !getVarint(index) || !getString(payload)
+                    || index >= sites.size() || !sites[index].m_defined)
+                { return {}; }
+                tick += delta;
+                auto const & site{sites[index]};
+
+                line.clear();
+                line += '[';
+                if (LogTimestamp::MONOTONIC == clock_type) { XLogTimestamp_::appendElapsed(nanoseconds{tick - anchor},precision,line); }
+                else { timestamp.append(clock.toSystem(steady(tick).time_since_epoch().count()),precision,line); }
+                line += ']';
+                XLogPrivate::appendHeader(static_cast<LogLevel>(tag)
+                    ,thread < threads.size() ? std::string_view{threads[thread]} : std::string_view{"unknown"}
+                    ,site.m_file,site.m_line,site.m_function,line);
+                XLogPrivate::appendMessage(site.m_formatted ? site.m_format.c_str() : nullptr,payload,line);
+                line += '\n';
+                out << line;
+                break;
+            }
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+void XLogPrivate::rotateLogFile() {
+
+    m_file_.close();
 
     try {
         // 生成新的日志文件名
@@ -723,7 +1577,7 @@ void XLogPrivate::initializeLogFile() {
     } catch (std::exception const & e) {
         std::cerr << "Failed to initialize log file: " << e.what() << '\n';
         // 回退到简单的文件名
-        m_current_log_file_ = m_log_directory_ + "/application.log";
+        m_current_log_file_ = m_log_directory_ + "/application" + std::string{m_file_extension_};
         m_log_file_path_ = m_current_log_file_;
         m_current_file_size_.storeRelaxed({});
     }
@@ -761,10 +1615,8 @@ void XLog::xlogHelper(LogLevel const &level
                 ,SourceLocation const &location
                 ,bool const b)
 {
-    if ( auto const logger{instance()}
-        ;logger && logger->shouldLog(level))
-    {
-        logger->log(level,msg,location);
+    if (auto const logger{instance()}) {
+        logger->log_(level,msg,location);
         if (b){logger->flush();}
     }
 }
@@ -2,6 +2,9 @@
 #define XUTILS_XLOG_HPP 1
 
 #include <XMemory/xmemory.hpp>
+#include <XLog/xlogformat_impl.hpp>
+#include <atomic>
+#include <tuple>
 
 XTD_NAMESPACE_BEGIN
 XTD_INLINE_NAMESPACE_BEGIN(v1)
@@ -25,7 +28,45 @@ enum class LogLevel : uint8_t {
 enum class LogOutput : uint8_t {
     CONSOLE = 1 << 0,  // 控制台输出
     FILE = 1 << 1,     // 文件输出
-    BOTH = CONSOLE | FILE  // 同时输出到控制台和文件
+    BOTH = CONSOLE | FILE,  // 同时输出到控制台和文件
+    BINARY = 1 << 2 | FILE // 文件以紧凑的二进制记录写入(.xlb),由xlog-decode还原为文本,可与CONSOLE组合
+};
+
+/**
+ * @brief 线程队列满时的处理策略
+ */
+enum class LogOverflow : uint8_t {
+    BLOCK,       // 等待工作线程腾出空间
+    DROP_NEWEST, // 丢弃本条日志
+    DROP_OLDEST  // 丢弃队列中最旧的日志
+};
+
+/**
+ * @brief 日志文件的写入策略
+ * 工作线程把一批记录格式化到同一缓冲区后一次写入,缓冲区满时总会写入,
+ * 仅在FATAL或显式flush()时落盘(fsync)
+ */
+enum class LogFlushPolicy : uint8_t {
+    EVERY_BATCH, // 每批写入一次
+    INTERVAL,    // 每隔指定毫秒写入一次
+    ON_ERROR     // 出现ERROR及以上级别时写入
+};
+
+/**
+ * @brief 时间戳的时钟
+ */
+enum class LogTimestamp : uint8_t {
+    WALL_CLOCK, // 系统时间 YYYY-mm-dd HH:MM:SS.fff
+    MONOTONIC   // 单调时钟,距锚点的秒数 +SSS.fff,每个日志文件开头写入一次锚点的系统时间
+};
+
+/**
+ * @brief 时间戳的小数精度
+ */
+enum class LogTimePrecision : uint8_t {
+    MILLISECONDS = 3,
+    MICROSECONDS = 6,
+    NANOSECONDS = 9
 };
 
 // 启用位运算操作符
@@ -127,9 +168,12 @@ class X_CLASS_EXPORT XLog final : XSingleton<XLog> {
 public:
     using CrashHandlerPtr = CrashHandlerPtr_;
     using TimePoint [[maybe_unused]] = std::chrono::system_clock::time_point;
+    /// 模块名的最大长度(含结尾的'\0')
+    static constexpr std::size_t ModuleNameSize_{48};
 
     /**
      * @brief 设置日志级别
+     * 同时作用于没有单独设置级别的模块,级别为进程内全局,不随实例重建而重置
      * @param level 最低日志级别
      */
     void setLogLevel(LogLevel const & level) noexcept;
@@ -140,6 +184,35 @@ public:
      */
     [[nodiscard]] LogLevel getLogLevel() const noexcept;
 
+    /**
+     * @brief 单独设置模块的日志级别,不再跟随setLogLevel
+     * 模块由定义XLOG_MODULE的源文件中的日志宏使用,最多63个模块
+     * @param module 模块名,空串等同于setLogLevel
+     * @param level 最低日志级别
+     * @return 模块表已满或模块名过长时返回false
+     */
+    bool setModuleLogLevel(std::string_view const & module, LogLevel const & level) noexcept;
+
+    /**
+     * @brief 取消模块单独设置的级别,恢复跟随全局级别
+     * @param module 模块名
+     */
+    void resetModuleLogLevel(std::string_view const & module) noexcept;
+
+    /**
+     * @brief 获取模块当前生效的日志级别
+     * @param module 模块名,未注册时返回全局级别
+     * @return 日志级别
+     */
+    [[nodiscard]] LogLevel getModuleLogLevel(std::string_view const & module) const noexcept;
+
+    /**
+     * @brief 获取模块级别的引用,需要时注册模块,供日志宏在调用点缓存
+     * @param module 模块名,nullptr或空串为全局级别;表满或名字过长时也返回全局级别
+     * @return 与模块的生命周期相同(进程内一直有效)
+     */
+    [[nodiscard]] static std::atomic<LogLevel> const & moduleLevel(char const * module) noexcept;
+
     /**
      * @brief 设置日志输出方式
      * @param output 输出方式（控制台、文件或两者）
@@ -158,6 +231,14 @@ public:
                          std::size_t max_size_mb = 5, 
                          int retention_days = 7);
 
+    /**
+     * @brief 设置日志文件的写入策略
+     * @param policy 默认为EVERY_BATCH
+     * @param interval INTERVAL策略的写入间隔
+     */
+    void setFlushPolicy(LogFlushPolicy policy,
+                        std::chrono::milliseconds const & interval = std::chrono::milliseconds{100}) noexcept;
+
     /**
      * @brief 获取当前日志文件路径
      * @return 当前日志文件的完整路径
@@ -169,6 +250,14 @@ public:
      */
     void cleanupOldLogFiles() const noexcept;
 
+    /**
+     * @brief 设置时间戳格式
+     * @param precision 小数精度，默认毫秒
+     * @param clock 时钟，默认系统时间
+     */
+    void setTimestampFormat(LogTimePrecision precision,
+                            LogTimestamp clock = LogTimestamp::WALL_CLOCK) noexcept;
+
     /**
      * @brief 启用/禁用控制台彩色输出
      * @param enable 是否启用彩色输出
@@ -177,10 +266,26 @@ public:
 
     /**
      * @brief 设置异步队列大小
-     * @param size 队列大小，0表示无限制
+     * 每个写日志的线程有独立的无锁队列,容量向上取整为2的幂,
+     * 对之后第一次写日志的线程生效
+     * @param size 每个线程的队列大小，0表示默认值1024
      */
     void setAsyncQueueSize(std::size_t size) noexcept;
 
+    /**
+     * @brief 设置线程队列满时的处理策略
+     * @param policy 默认为DROP_OLDEST
+     */
+    void setOverflowPolicy(LogOverflow policy) noexcept;
+
+    [[nodiscard]] LogOverflow getOverflowPolicy() const noexcept;
+
+    /**
+     * @brief 获取因队列满而丢弃的日志数量
+     * @return 丢弃的日志数量
+     */
+    [[nodiscard]] std::size_t getDroppedCount() const noexcept;
+
     /**
      * @brief 启用崩溃诊断
      * @param enable 是否启用崩溃诊断
@@ -204,33 +309,23 @@ public:
 
     /**
      * @brief 格式化记录日志
+     * 参数以二进制编码写入日志记录,文本格式化由工作线程完成
      * @tparam Args 参数类型
      * @param level 日志级别
-     * @param format_str 格式字符串
+     * @param format_str 格式字符串,编译期检查与参数是否一致
      * @param location 源代码位置信息
      * @param args 格式参数
      */
     template<typename... Args>
-    constexpr void logFormat(LogLevel const & level, const char * const format_str,
+    void logFormat(LogLevel const & level, XLogFormatString<std::type_identity_t<Args>...> const & format_str,
               SourceLocation const & location, Args &&... args)
     {
-        if (!shouldLog(level)) { return; }
-
-        try {
-            // 使用简单的字符串格式化（C++17兼容）
-            std::ostringstream oss{};
-            formatImpl(oss, format_str, std::forward<Args>(args)...);
-            log(level, oss.str(), location);
-        } catch (std::exception const & e) {
-            // 格式化失败时记录错误
-            log(LogLevel::ERROR_LEVEL
-                , (std::ostringstream{} << "Log format error: " << e.what()).str()
-                , location);
-        }
+        if (shouldLog(level)) { logFormat_(level, format_str.get(), location, args...); }
     }
 
     /**
      * @brief 刷新所有待处理的日志
+     * 等待工作线程写出全部已提交的日志,并将日志文件落盘
      */
     void flush();
 
@@ -290,18 +385,31 @@ public:
      */
     [[nodiscard]] static std::string getStackTrace(int skip_frames = 1);
 
+    /**
+     * @brief 把二进制日志(LogOutput::BINARY写出的.xlb文件)还原为文本格式
+     * @param in 二进制日志
+     * @param out 文本输出,每条日志一行
+     * @param precision 时间戳小数精度
+     * @param clock 时间戳时钟
+     * @return 输入完整且格式正确,否则只输出出错前的部分
+     */
+    static bool decodeBinaryLog(std::istream & in, std::ostream & out,
+                                LogTimePrecision precision = LogTimePrecision::MILLISECONDS,
+                                LogTimestamp clock = LogTimestamp::WALL_CLOCK);
+
+    /// 由日志宏调用,级别已由宏按模块判断,这里不再过滤
     static void xlogHelper(LogLevel const &,std::string_view const &,SourceLocation const &,bool = false);
 
+    /// 由日志宏调用,级别已由宏按模块判断,这里不再过滤
     template<typename ...Args>
     static constexpr void xlogFormatHelper(LogLevel const & level
-                                        ,const char * const format
+                                        ,XLogFormatString<std::type_identity_t<Args>...> const & format
                                         ,SourceLocation const & location
                                         ,bool const b
                                         ,Args && ...args) noexcept {
 
-        if ( auto const logger{instance()}
-            ;logger && logger->shouldLog(level)) {
-            logger->logFormat(level,format,location,std::forward< Args >(args)...);
+        if (auto const logger{instance()}) {
+            logger->logFormat_(level,format.get(),location,args...);
             if (b){logger->flush();}
         }
     }
@@ -313,77 +421,147 @@ private:
     ~XLog();
     bool construct_();
     static auto instance() noexcept -> XLog *;
-    // 格式化辅助函数 - 使用标准printf风格格式化
+    /// 写入一条日志,不检查级别
+    void log_(LogLevel const & , std::string_view const & message, SourceLocation const & );
+
+    /// 编码参数并写入一条格式化日志,不检查级别
     template<typename... Args>
-    static constexpr void formatImpl(std::ostringstream & , const char* , Args &&...);
+    void logFormat_(LogLevel const & level, char const * const format, SourceLocation const & location, Args const & ... args) {
+        std::tuple<Args const & ...> const pack{args...};
+        logEncoded_(level, format, location
+            , (std::size_t{} + ... + XPrivate::logArgSize_(args))
+            , [](char * out, void const * const p) noexcept {
+                std::apply([&out](auto const & ... a) noexcept { ((out = XPrivate::encodeLogArg_(out, a)), ...); }
+                    , *static_cast<decltype(pack) const *>(p));
+            }
+            , std::addressof(pack));
+    }
+
+    /// 写入一条格式化日志,encode把参数编码到size字节的缓冲区
+    void logEncoded_(LogLevel const & , const char * format, SourceLocation const & , std::size_t size
+                    , void (*encode)(char *, void const *) noexcept, void const * args);
     X_DISABLE_COPY_MOVE(XLog)
     friend X_API XLog * XlogHandle() noexcept;
 };
 
-template<typename... Args>
-constexpr void XLog::formatImpl(std::ostringstream & oss
-                            , const char * const format
-                            , Args &&... args)
-{
-    using BufferType = std::vector<char,XPrivate::Allocator_<char>>;
-
-    if constexpr ( sizeof...(args) > 0 ) { //有参数时使用snprintf进行格式化
-        constexpr auto PredictSize {4096};
-        BufferType buffer(PredictSize,{});
-        if (auto const result { std::snprintf(buffer.data(), buffer.size(), format, args...) }
-            ; result > 0 && static_cast<std::size_t>(result) < buffer.size())
-        {
-            oss << buffer.data();
-        } else if (result > 0) {
-            // 缓冲区太小，需要更大的缓冲区
-            BufferType largerBuffer(result + 1,{});
-            std::snprintf(largerBuffer.data(), result + 1, format, args...);
-            oss << largerBuffer.data();
-        } else {
-            // 格式化失败，输出原始格式字符串
-            oss << format;
-        }
-    } else {
-        // 无参数时直接输出格式字符串
-        oss << format;
-    }
-}
+/**
+ * 编译期最低级别,低于该级别的日志宏不生成任何调用,参数也不会求值,但格式串与参数仍做编译期检查
+ * 在包含本头文件前定义或由编译选项给出,如 -DXLOG_ACTIVE_LEVEL=XLOG_LEVEL_INFO
+ */
+#define XLOG_LEVEL_TRACE 0
+#define XLOG_LEVEL_DEBUG 1
+#define XLOG_LEVEL_INFO  2
+#define XLOG_LEVEL_WARN  3
+#define XLOG_LEVEL_ERROR 4
+#define XLOG_LEVEL_FATAL 5
+#define XLOG_LEVEL_OFF   6
+
+#ifndef XLOG_ACTIVE_LEVEL
+#define XLOG_ACTIVE_LEVEL XLOG_LEVEL_TRACE
+#endif
+
+/**
+ * 日志宏所属的模块,定义为字符串字面量后该源文件的日志按模块级别过滤(XLog::setModuleLogLevel)
+ * 未定义时使用全局级别
+ */
+#ifndef XLOG_MODULE
+#define XLOG_MODULE nullptr
+#endif
+
+/// 每个调用点第一次执行时缓存所属模块级别的引用,之后只做一次relaxed读取
+#define XLOG_ENABLED_(level)                                                        \
+    ((level) >= []() noexcept -> std::atomic<XUtils::LogLevel> const & {            \
+        static auto const & slot_{XUtils::XLog::moduleLevel(XLOG_MODULE)};          \
+        return slot_;                                                               \
+    }().load(std::memory_order_relaxed))
+
+/// 级别未开启时不求值参数,编译期关闭时调用只做类型检查
+#define XLOG_WHEN_(enabled, call) ((enabled) ? call : static_cast<void>(0))
 
 // 现代化的便利宏定义 - 使用辅助宏减少重复代码
-#define XLOG_IMPL(level, msg)       \
-    XUtils::XLog::xlogHelper(level  \
-    ,msg                            \
-    ,XUtils::SourceLocation::current(__FILE__, FUNC_SIGNATURE, __LINE__))
+#define XLOG_CALL_(level, msg, b)       \
+    XUtils::XLog::xlogHelper(level      \
+    ,msg                                \
+    ,XUtils::SourceLocation::current(__FILE__, FUNC_SIGNATURE, __LINE__),b)
 
-#define XLOG_FATAL_IMPL(level, msg) \
-    XUtils::XLog::xlogHelper(level  \
-    ,msg                            \
-    ,XUtils::SourceLocation::current(__FILE__, FUNC_SIGNATURE, __LINE__),true)
+#define XLOG_IMPL(level, msg)       XLOG_WHEN_(XLOG_ENABLED_(level), XLOG_CALL_(level, msg, false))
+#define XLOG_FATAL_IMPL(level, msg) XLOG_WHEN_(XLOG_ENABLED_(level), XLOG_CALL_(level, msg, true))
+#define XLOG_DISABLED_(level, msg)  XLOG_WHEN_(false, XLOG_CALL_(level, msg, false))
 
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_TRACE
 #define XLOG_TRACE(msg) XLOG_IMPL(XUtils::LogLevel::TRACE_LEVEL, msg)
+#else
+#define XLOG_TRACE(msg) XLOG_DISABLED_(XUtils::LogLevel::TRACE_LEVEL, msg)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_DEBUG
 #define XLOG_DEBUG(msg) XLOG_IMPL(XUtils::LogLevel::DEBUG_LEVEL, msg)
+#else
+#define XLOG_DEBUG(msg) XLOG_DISABLED_(XUtils::LogLevel::DEBUG_LEVEL, msg)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_INFO
 #define XLOG_INFO(msg)  XLOG_IMPL(XUtils::LogLevel::INFO_LEVEL, msg)
+#else
+#define XLOG_INFO(msg)  XLOG_DISABLED_(XUtils::LogLevel::INFO_LEVEL, msg)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_WARN
 #define XLOG_WARN(msg)  XLOG_IMPL(XUtils::LogLevel::WARN_LEVEL, msg)
+#else
+#define XLOG_WARN(msg)  XLOG_DISABLED_(XUtils::LogLevel::WARN_LEVEL, msg)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_ERROR
 #define XLOG_ERROR(msg) XLOG_IMPL(XUtils::LogLevel::ERROR_LEVEL, msg)
+#else
+#define XLOG_ERROR(msg) XLOG_DISABLED_(XUtils::LogLevel::ERROR_LEVEL, msg)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_FATAL
 #define XLOG_FATAL(msg) XLOG_FATAL_IMPL(XUtils::LogLevel::FATAL_LEVEL, msg)
+#else
+#define XLOG_FATAL(msg) XLOG_DISABLED_(XUtils::LogLevel::FATAL_LEVEL, msg)
+#endif
 
 // 格式化日志宏 - 使用辅助宏来处理可变参数
-#define XLOG_FORMAT_IMPL(level, fmt, ...) \
+#define XLOG_FORMAT_CALL_(level, b, fmt, ...) \
     XUtils::XLog::xlogFormatHelper(level,fmt \
         ,XUtils::SourceLocation::current(__FILE__, FUNC_SIGNATURE, __LINE__) \
-        , false __VA_OPT__(, ) __VA_ARGS__ )
+        , b __VA_OPT__(, ) __VA_ARGS__ )
 
+#define XLOG_FORMAT_IMPL(level, fmt, ...) \
+    XLOG_WHEN_(XLOG_ENABLED_(level), XLOG_FORMAT_CALL_(level, false, fmt __VA_OPT__(, ) __VA_ARGS__))
 #define XLOG_FATAL_FORMAT_IMPL(level, fmt, ...) \
-    XUtils::XLog::xlogFormatHelper(level,fmt \
-        ,XUtils::SourceLocation::current(__FILE__, FUNC_SIGNATURE, __LINE__) \
-        , true __VA_OPT__(, ) __VA_ARGS__ )
+    XLOG_WHEN_(XLOG_ENABLED_(level), XLOG_FORMAT_CALL_(level, true, fmt __VA_OPT__(, ) __VA_ARGS__))
+#define XLOG_FORMAT_DISABLED_(level, fmt, ...) \
+    XLOG_WHEN_(false, XLOG_FORMAT_CALL_(level, false, fmt __VA_OPT__(, ) __VA_ARGS__))
 
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_TRACE
 #define XLOGF_TRACE(fmt, ...) XLOG_FORMAT_IMPL(XUtils::LogLevel::TRACE_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define XLOGF_TRACE(fmt, ...) XLOG_FORMAT_DISABLED_(XUtils::LogLevel::TRACE_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_DEBUG
 #define XLOGF_DEBUG(fmt, ...) XLOG_FORMAT_IMPL(XUtils::LogLevel::DEBUG_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define XLOGF_DEBUG(fmt, ...) XLOG_FORMAT_DISABLED_(XUtils::LogLevel::DEBUG_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_INFO
 #define XLOGF_INFO(fmt, ...)  XLOG_FORMAT_IMPL(XUtils::LogLevel::INFO_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define XLOGF_INFO(fmt, ...)  XLOG_FORMAT_DISABLED_(XUtils::LogLevel::INFO_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_WARN
 #define XLOGF_WARN(fmt, ...)  XLOG_FORMAT_IMPL(XUtils::LogLevel::WARN_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define XLOGF_WARN(fmt, ...)  XLOG_FORMAT_DISABLED_(XUtils::LogLevel::WARN_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_ERROR
 #define XLOGF_ERROR(fmt, ...) XLOG_FORMAT_IMPL(XUtils::LogLevel::ERROR_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define XLOGF_ERROR(fmt, ...) XLOG_FORMAT_DISABLED_(XUtils::LogLevel::ERROR_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#endif
+#if XLOG_ACTIVE_LEVEL <= XLOG_LEVEL_FATAL
 #define XLOGF_FATAL(fmt, ...) XLOG_FATAL_FORMAT_IMPL(XUtils::LogLevel::FATAL_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define XLOGF_FATAL(fmt, ...) XLOG_FORMAT_DISABLED_(XUtils::LogLevel::FATAL_LEVEL, fmt __VA_OPT__(, ) __VA_ARGS__)
+#endif
 
 XTD_INLINE_NAMESPACE_END
 XTD_NAMESPACE_END
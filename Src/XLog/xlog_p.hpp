@@ -3,11 +3,18 @@
 
 #include <XLog/xlog.hpp>
 #include <XAtomic/xatomic.hpp>
+#include <XGlobal/xtypes.hpp>
+#include <XConcurrentQueue/xlightweightsemaphore.hpp>
+#include <array>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
+#include <limits>
 #include <mutex>
 #include <shared_mutex>
 #include <thread>
-#include <deque>
+#include <unordered_map>
+#include <vector>
 #include <condition_variable>
 #ifdef X_PLATFORM_WINDOWS
 #include <windows.h>
@@ -16,14 +23,244 @@
 XTD_NAMESPACE_BEGIN
 XTD_INLINE_NAMESPACE_BEGIN(v1)
 
+/**
+ * 日志记录,调用线程只保存原始数据,格式化推迟到工作线程
+ * 时间为steady_clock刻度,线程为进程内序号,源码位置保留原始指针(__FILE__等字面量)
+ * 不超过InlineSize_的消息就地存放,入队不分配内存
+ * 格式化日志保存格式串指针和编码后的参数,文本同样由工作线程生成
+ */
+struct XLogRecord_ final {
+    static constexpr std::size_t InlineSize_{200};
+
+    std::chrono::steady_clock::rep m_tick{};
+    SourceLocation m_location{};
+    /// 非空时消息为按该格式串编码的参数
+    char const * m_format{};
+    xuint32 m_thread{};
+    xuint32 m_size{};
+    LogLevel m_level{};
+    /// 不做值初始化,只有前m_size个字节有效
+    std::array<char,InlineSize_> m_inline;
+    /// 超过InlineSize_的消息,只有长消息才分配
+    std::string m_overflow{};
+
+    void assign(std::string_view const & message);
+
+    /// 准备size字节的消息缓冲区
+    /// @return 可写入size字节的位置
+    [[nodiscard]] char * prepare(std::size_t size);
+
+    /// 取走other的内容,长消息交换缓冲区,两边的容量都得以复用
+    void takeFrom(XLogRecord_ & other) noexcept;
+
+    [[nodiscard]] std::string_view text() const noexcept
+    { return m_size > InlineSize_ ? std::string_view{m_overflow} : std::string_view{m_inline.data(),m_size}; }
+};
+
+/**
+ * 每个写日志的线程一个有界环形队列,生产者只有所属线程,不加锁
+ * 每个槽带序号(Vyukov有界队列),消费端以CAS取槽,
+ * 因此除工作线程外,队列满且策略为DROP_OLDEST时生产者也能作为消费者丢弃最旧的记录
+ */
+class XLogRing_ final {
+    struct Cell_ final {
+        std::atomic_size_t m_seq{};
+        XLogRecord_ m_record{};
+    };
+
+    std::unique_ptr<Cell_[]> m_cells_{};
+    std::size_t const m_mask_{};
+    alignas(64) std::atomic_size_t m_head_{};
+    /// 只由生产线程写入
+    alignas(64) std::atomic_size_t m_tail_{};
+    /// 只由生产线程使用,生产位置到达该值时才读取消费位置判断积压
+    std::size_t m_checkAt_{};
+
+public:
+    X_DISABLE_COPY_MOVE(XLogRing_)
+
+    xuint32 const m_thread{};
+    /// 积压达到该数量时唤醒工作线程
+    std::size_t const m_wakeAt{};
+    std::string const m_id{};
+    /// 生产线程已退出,队列清空后由工作线程移除
+    std::atomic_bool m_closed{};
+
+    /// @param capacity 2的幂
+    XLogRing_(std::size_t capacity,xuint32 thread,std::string id);
+    ~XLogRing_() = default;
+
+    /// 生产者取得下一个可写的记录
+    /// @return 队列满时返回nullptr
+    [[nodiscard]] XLogRecord_ * tryReserve() const noexcept;
+
+    /// 生产者发布tryReserve取得的记录
+    /// 消费位置所在的缓存行由工作线程写入,每m_wakeAt条记录最多读取一次
+    /// @return 积压达到m_wakeAt,需要唤醒工作线程
+    [[nodiscard]] bool publish() noexcept;
+
+    /// 取出最旧的记录
+    /// @return 队列为空时返回false
+    bool pop(XLogRecord_ & record) noexcept;
+
+    /// 丢弃最旧的记录
+    /// @return 队列为空时返回false
+    bool discard() noexcept;
+
+    [[nodiscard]] std::size_t sizeApprox() const noexcept;
+
+private:
+    /// @return 已占有的槽,队列为空时返回nullptr
+    Cell_ * claim_() noexcept;
+};
+
+/**
+ * 日志文件,无缓冲的FILE*,每次append为一次write调用,缓冲与批次由工作线程负责
+ */
+class XLogFile_ final {
+    std::FILE * m_file_{};
+
+public:
+    X_DISABLE_COPY_MOVE(XLogFile_)
+    XLogFile_() = default;
+    ~XLogFile_() { close(); }
+
+    /// 以追加方式打开
+    bool open(std::string const & path) noexcept;
+    void close() noexcept;
+
+    [[nodiscard]] bool isOpen() const noexcept
+    { return m_file_; }
+
+    bool append(std::string_view const & data) noexcept;
+
+    /// 落盘(fsync)
+    void sync() const noexcept;
+};
+
+/**
+ * steady_clock刻度到系统时间的换算
+ * 由工作线程每秒重新校准一次,以跟随系统时间的调整
+ */
+class XLogClock_ final {
+    std::chrono::steady_clock::time_point m_steady_{};
+    std::chrono::system_clock::time_point m_system_{};
+
+public:
+    void calibrate() noexcept {
+        m_steady_ = std::chrono::steady_clock::now();
+        m_system_ = std::chrono::system_clock::now();
+    }
+
+    /// 以已知的对应关系校准,用于解码二进制日志
+    void calibrate(std::chrono::steady_clock::time_point const & steady,std::chrono::system_clock::time_point const & system) noexcept {
+        m_steady_ = steady;
+        m_system_ = system;
+    }
+
+    [[nodiscard]] std::chrono::steady_clock::time_point lastCalibration() const noexcept
+    { return m_steady_; }
+
+    [[nodiscard]] std::chrono::system_clock::time_point systemAtCalibration() const noexcept
+    { return m_system_; }
+
+    [[nodiscard]] std::chrono::system_clock::time_point toSystem(std::chrono::steady_clock::rep const tick) const noexcept {
+        auto const elapsed{std::chrono::steady_clock::duration{tick} - m_steady_.time_since_epoch()};
+        return m_system_ + std::chrono::duration_cast<std::chrono::system_clock::duration>(elapsed);
+    }
+};
+
+/**
+ * 时间戳格式化缓存
+ * 同一秒内复用"YYYY-mm-dd HH:MM:SS"前缀,只改写小数部分,跨秒时才调用一次localtime
+ * 全部为定宽数字写入,不经过iostream
+ */
+class XLogTimestamp_ final {
+    static constexpr std::size_t PrefixSize_{19};
+    static constexpr std::array<std::uint64_t,10> Pow10_{1,10,100,1000,10000,100000,1000000,10000000,100000000,1000000000};
+    std::array<char,PrefixSize_> m_prefix_{};
+    std::chrono::system_clock::rep m_second_{std::numeric_limits<std::chrono::system_clock::rep>::min()};
+
+public:
+    constexpr XLogTimestamp_() = default;
+
+    /// 追加系统时间
+    void append(std::chrono::system_clock::time_point const & ,LogTimePrecision ,std::string & out);
+
+    /// 追加"+秒.小数"
+    static void appendElapsed(std::chrono::nanoseconds const & ,LogTimePrecision ,std::string & out);
+
+    /// 以定宽十进制(前补0)写入
+    static void writeDigits(char * first,std::size_t width,std::uint64_t value) noexcept;
+};
+
+/**
+ * 二进制日志(LogOutput::BINARY),文件扩展名为.xlb,由XLog::decodeBinaryLog或xlog-decode还原为文本
+ * 文件(及续写的每一段)以Magic_开头,之后每条记录以1字节标记开始,整数均为变长整数(有符号的先做zigzag):
+ * - 0~5   日志,标记即级别:时间刻度与上一条之差、线程序号、调用点序号、参数字节数、参数原始字节
+ * - CLOCK steady_clock刻度与对应的系统时间(纳秒),工作线程重新校准后写入
+ * - BASE  下一条日志的时间差相对的刻度
+ * - THREAD 线程序号与线程id,每个线程第一次出现时写入
+ * - SITE  调用点序号、行号、有无格式串、文件名、函数名、格式串,每个调用点第一次出现时写入
+ * 没有格式串的调用点,参数即消息文本;有格式串时为encodeLogArg_编码后的参数
+ */
+class XLogBinary_ final {
+public:
+    static constexpr std::string_view Magic_{"XLOGBIN\x01",8},Extension_{".xlb"};
+
+    enum class Tag_ : xuint8 { CLOCK = 0x80, BASE, THREAD, SITE };
+
+private:
+    struct Site_ final {
+        char const * m_file{},* m_function{},* m_format{};
+        xuint32 m_line{};
+        bool operator==(Site_ const &) const noexcept = default;
+    };
+
+    struct SiteHash_ final {
+        std::size_t operator()(Site_ const & site) const noexcept {
+            auto const mix{[](std::size_t const seed,std::size_t const value) noexcept { return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)); }};
+            return mix(mix(mix(std::hash<void const *>{}(site.m_file),std::hash<void const *>{}(site.m_function))
+                ,std::hash<void const *>{}(site.m_format)),site.m_line);
+        }
+    };
+
+    std::unordered_map<Site_,xuint32,SiteHash_> m_sites_{};
+    std::vector<bool> m_threads_{};
+    /// 已写出的全部THREAD、SITE记录,每个新文件开头重新写入一次
+    std::string m_table_{};
+    /// 上一条日志的时间刻度(纳秒)与缓冲开始时的刻度
+    std::int64_t m_tick_{},m_base_{};
+    XLogClock_ m_clock_{},m_base_clock_{};
+
+    static void putClock(std::string & out,XLogClock_ const & );
+
+public:
+    static void putVarint(std::string & out,std::uint64_t value);
+    static void putSigned(std::string & out,std::int64_t value);
+    static void putString(std::string & out,std::string_view const & value);
+
+    /// 把记录编码后追加到out(文件缓冲)
+    void append(XLogRecord_ const & ,XLogClock_ const & ,std::string_view const & thread,std::string & out);
+
+    /// 追加新文件开头需要的内容:Magic_、缓冲开始时的校准与刻度基准、全部线程与调用点
+    void preamble(std::string & out) const;
+
+    /// 还原为文本
+    /// @return 输入完整且格式正确
+    static bool decode(std::istream & ,std::ostream & ,LogTimePrecision ,LogTimestamp );
+};
+
 class X_CLASS_EXPORT XLogPrivate final: public XLogData {
 public:
     X_DECLARE_PUBLIC(XLog)
     // 配置参数
-    std::atomic<LogLevel> m_log_level_ {LogLevel::INFO_LEVEL};
     std::atomic<LogOutput> m_output_ {LogOutput::BOTH};
     XAtomicBool m_color_output_{true},m_crash_diagnostics_{true};
-    XAtomicInteger<std::size_t> m_max_queue_size_ { 10000 };
+    /// 每个线程的队列容量
+    XAtomicInteger<std::size_t> m_max_queue_size_ { DefaultQueueSize_ };
+    std::atomic<LogOverflow> m_overflow_{LogOverflow::DROP_OLDEST};
+    XAtomicInteger<std::size_t> m_dropped_{};
 
     // 文件相关
     std::string m_log_file_path_{}
@@ -33,15 +270,66 @@ public:
     XAtomicInteger<std::size_t> m_max_file_size_{5 * 1024 * 1024} // 默认5MB
                         ,m_current_file_size_{};
     XAtomicInt m_retention_days_{7}; // 默认保存7天
-    std::unique_ptr<std::ofstream> m_file_stream_{};
+    /// 由m_file_mutex_保护
+    XLogFile_ m_file_{};
+    std::atomic<LogFlushPolicy> m_flush_policy_{LogFlushPolicy::EVERY_BATCH};
+    XAtomicInteger<std::chrono::milliseconds::rep> m_flush_interval_{100};
+    std::atomic<LogTimePrecision> m_time_precision_{LogTimePrecision::MILLISECONDS};
+    std::atomic<LogTimestamp> m_time_clock_{LogTimestamp::WALL_CLOCK};
 
     // 异步处理
-    std::deque<LogMessage> m_log_queue_{};
-    mutable std::shared_mutex m_queue_mutex_{};
-    std::condition_variable_any m_queue_cv_{};
+    /// 已登记的线程队列,登记与移除由m_rings_mutex_保护,工作线程按m_rings_version_重新复制
+    std::vector<std::shared_ptr<XLogRing_>> m_rings_{};
+    mutable std::mutex m_rings_mutex_{};
+    std::atomic_size_t m_rings_version_{};
+    /// 由m_rings_mutex_保护
+    xuint32 m_next_thread_{};
+    /// 区分XLog实例,线程局部缓存的队列只对同一实例有效
+    xuint64 m_id_{};
+
+    /// 工作线程先限时攒批,期间只有某个队列积压达到m_wakeAt才唤醒;
+    /// 一轮没有取到记录才置m_worker_idle_并无限等待,此后第一条记录负责唤醒
+    /// 空闲标志与队列构成Dekker式同步,重屏障放在很少执行的置空闲一侧(membarrier),
+    /// 生产者只需编译器屏障;m_asymmetric_为false(不支持membarrier)时两侧都用seq_cst屏障
+    static constexpr std::size_t DefaultQueueSize_{1024},BatchSize_{256};
+    static constexpr std::chrono::milliseconds Linger_{10};
+    moodycamel::XLightweightSemaphore m_wake_sem_{0,0};
+    std::atomic_bool m_worker_idle_{};
+    /// 工作线程启动前确定,之后只读
+    bool m_asymmetric_{};
     std::thread m_worker_thread_{};
     XAtomicBool m_running_{},m_shutdown_requested_{};
 
+    /// flush请求的序号,工作线程在请求之后的一轮把全部队列取空后完成该序号
+    std::atomic<xuint64> m_flush_requested_{};
+    /// 由m_flush_mutex_保护
+    xuint64 m_flush_done_{};
+    std::mutex m_flush_mutex_{};
+    std::condition_variable m_flush_cv_{};
+
+    // 以下只由工作线程使用
+    XLogClock_ m_clock_{};
+    /// MONOTONIC时间戳的锚点,工作线程启动时固定
+    XLogClock_ m_anchor_{};
+    XLogTimestamp_ m_timestamp_{};
+    /// 上一条记录使用的时钟,切换到MONOTONIC时需要在文件中补写锚点
+    LogTimestamp m_last_clock_{LogTimestamp::WALL_CLOCK};
+    /// 新打开的文件需要先写入锚点(MONOTONIC)或二进制文件头
+    bool m_anchor_pending_{};
+    std::string m_line_{};
+    /// m_file_buffer_中为二进制记录
+    bool m_file_binary_{};
+    XLogBinary_ m_binary_{};
+    /// 待写入文件的已格式化记录,达到写入条件时一次写入
+    static constexpr std::size_t FileBufferSize_{64 * 1024};
+    std::string m_file_buffer_{};
+    std::size_t m_file_records_{};
+    /// 缓冲中有ERROR及以上/FATAL级别的记录
+    bool m_file_urgent_{},m_file_sync_{};
+    std::chrono::steady_clock::time_point m_file_written_{};
+    /// 线程序号对应的线程id字符串
+    std::vector<std::string> m_thread_ids_{};
+
     // 崩溃处理
     using CrashHandlerPtr = std::shared_ptr<ICrashHandler>;
     CrashHandlerPtr m_crash_handler_{};
@@ -49,14 +337,53 @@ public:
     // 同步
     mutable std::shared_mutex m_config_mutex_{};
     mutable std::mutex m_file_mutex_{};
+    /// 由m_file_mutex_保护,文本为.log,二进制为.xlb
+    static constexpr std::string_view TextExtension_{".log"};
+    std::string_view m_file_extension_{TextExtension_};
 
     XLogPrivate() = default;
     ~XLogPrivate() override = default;
+    /// @return 当前线程的队列,第一次调用时登记
+    [[nodiscard]] XLogRing_ & currentRing();
+    [[nodiscard]] std::string_view threadId(xuint32 ) const noexcept;
+
+    /// 按溢出策略取得可写的记录
+    /// @return 记录被丢弃时返回nullptr
+    [[nodiscard]] XLogRecord_ * reserve(XLogRing_ & );
+    /// 发布记录后按需唤醒工作线程
+    /// @param backlog publish返回的积压标志
+    void notifyWorker(bool backlog) noexcept;
+    /// 工作线程置空闲标志后、检查队列前调用的重屏障
+    void idleBarrier() const noexcept;
+
+    /// 等待工作线程完成本次flush请求
+    /// @return 是否在超时前完成
+    bool waitFlushed(std::chrono::milliseconds const & timeout);
+
     // 异步日志处理
     void processLogQueue();
-    void writeToConsole(LogMessage const & ) const;
-    void writeToFile(LogMessage const & );
-    [[nodiscard]] static std::string formatLogMessage(LogMessage const & ) ;
+    /// 按时间戳多路归并输出全部队列,直到全部为空
+    /// @return 输出的记录数
+    std::size_t drainRings(std::vector<std::shared_ptr<XLogRing_>> const & ,std::vector<XLogRecord_> & fronts);
+    void writeRecord(XLogRecord_ const & );
+    /// 按写入策略决定是否把m_file_buffer_写入文件
+    /// @param end_of_pass 本轮队列已取空
+    /// @param force flush或停止时强制写入
+    void commitFile(bool end_of_pass,bool force);
+    /// @return 按INTERVAL策略缓冲下一次需要写入的时间,无需定时写入时为time_point::max()
+    [[nodiscard]] std::chrono::steady_clock::time_point fileDeadline() const noexcept;
+    void writeToConsole(LogLevel , std::string_view const & ) const;
+    void writeToFile(std::string_view const & ,bool sync);
+    /// 把记录格式化后追加到out
+    void formatRecord(XLogRecord_ const & ,std::string & out);
+    /// 追加时间戳之后、消息之前的部分 " [LEVEL] [thread] file:line function() - "
+    static void appendHeader(LogLevel ,std::string_view const & thread,std::string_view const & file
+                            ,xuint32 line,std::string_view const & function,std::string & out);
+    /// 追加消息,format非空时payload为编码后的参数
+    static void appendMessage(char const * format,std::string_view const & payload,std::string & out);
+    /// 追加MONOTONIC时间戳的锚点行
+    static void appendAnchor(XLogTimestamp_ & ,std::chrono::system_clock::time_point const & anchor
+                            ,LogTimePrecision ,std::string & out);
 
     // 文件轮转
     void rotateLogFile();
@@ -0,0 +1,217 @@
+#ifndef XUTILS_XLOG_FORMAT_IMPL_HPP
+#define XUTILS_XLOG_FORMAT_IMPL_HPP 1
+
+#include <XHelper/xversion.hpp>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+namespace XPrivate {
+
+    /**
+     * 格式化参数在日志记录中的类型标记
+     * 每个参数编码为1字节标记加原始字节,整数统一为64位,字符串为32位长度、内容和结尾的'\0'
+     */
+    enum class LogArg_ : std::uint8_t {
+        INVALID,
+        SIGNED,
+        UNSIGNED,
+        DOUBLE,
+        LONG_DOUBLE,
+        POINTER,
+        STRING
+    };
+
+    template<typename T>
+    consteval LogArg_ logArgOf_() noexcept {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_enum_v<U> && !std::is_scoped_enum_v<U>) {
+            return logArgOf_<std::underlying_type_t<U>>();
+        } else if constexpr (std::is_integral_v<U>) {
+            return std::is_signed_v<U> ? LogArg_::SIGNED : LogArg_::UNSIGNED;
+        } else if constexpr (std::is_same_v<U,float> || std::is_same_v<U,double>) {
+            return LogArg_::DOUBLE;
+        } else if constexpr (std::is_same_v<U,long double>) {
+            return LogArg_::LONG_DOUBLE;
+        } else if constexpr (std::is_same_v<U,char *> || std::is_same_v<U,char const *>
+                            || (std::is_class_v<U> && std::is_convertible_v<U const &,std::string_view>)) {
+            return LogArg_::STRING;
+        } else if constexpr (std::is_pointer_v<U> || std::is_null_pointer_v<U>) {
+            return LogArg_::POINTER;
+        } else {
+            return LogArg_::INVALID;
+        }
+    }
+
+    /**
+     * 以下函数都不是constexpr,编译期检查格式串时调用即产生编译错误,函数名即错误原因
+     */
+    struct LogFormatError_ final {
+        static void invalidConversionSpecifier() noexcept {}
+        static void argumentTypeMismatch() noexcept {}
+        static void unsupportedArgumentType() noexcept {}
+        static void tooFewArguments() noexcept {}
+        static void tooManyArguments() noexcept {}
+    };
+
+    /**
+     * printf风格的转换说明 %[flags][width][.precision][length]conversion
+     * 编译期检查与工作线程格式化共用同一解析
+     */
+    struct LogSpec_ final {
+        /// 说明在格式串中的范围[m_begin,m_end),m_begin处为'%'
+        std::size_t m_begin{},m_end{};
+        /// 长度修饰符的起始位置,格式化时替换为与编码类型一致的修饰符
+        std::size_t m_length{};
+        /// 转换字符,'%'为字面量%,无效时为'\0'
+        char m_conversion{};
+        bool m_starWidth{},m_starPrecision{};
+    };
+
+    /// @param pos format[pos]为'%'
+    constexpr LogSpec_ parseLogSpec_(std::string_view const format,std::size_t const pos) noexcept {
+        LogSpec_ spec{pos};
+        auto i{pos + 1};
+        auto const at{[&format](std::size_t const n) noexcept { return n < format.size() ? format[n] : '\0'; }};
+        auto const digit{[](char const c) noexcept { return c >= '0' && c <= '9'; }};
+
+        if ('%' == at(i)) { spec.m_end = i + 1; spec.m_length = i; spec.m_conversion = '%'; return spec; }
+        while (std::string_view{"-+ #0"}.find(at(i)) != std::string_view::npos && at(i)) { ++i; }
+        if ('*' == at(i)) { spec.m_starWidth = true; ++i; }
+        else { while (digit(at(i))) { ++i; } }
+        if ('.' == at(i)) {
+            ++i;
+            if ('*' == at(i)) { spec.m_starPrecision = true; ++i; }
+            else { while (digit(at(i))) { ++i; } }
+        }
+        spec.m_length = i;
+        while (std::string_view{"hljztL"}.find(at(i)) != std::string_view::npos && at(i) && i - spec.m_length < 2) { ++i; }
+        auto const conversion{at(i)};
+        spec.m_end = std::min(i + 1,format.size());
+        // 不支持%n,宽字符的%ls、%lc也不支持
+        if (!conversion || std::string_view{"diouxXcfFeEgGaAsp"}.find(conversion) == std::string_view::npos
+            || (('s' == conversion || 'c' == conversion || 'p' == conversion) && i != spec.m_length))
+        { return spec; }
+        spec.m_conversion = conversion;
+        return spec;
+    }
+
+    /// @return 转换字符可以接受的参数类型
+    constexpr bool acceptsLogArg_(char const conversion,LogArg_ const arg) noexcept {
+        switch (conversion) {
+            case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+                return LogArg_::SIGNED == arg || LogArg_::UNSIGNED == arg;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                return LogArg_::DOUBLE == arg || LogArg_::LONG_DOUBLE == arg;
+            case 's':
+                return LogArg_::STRING == arg;
+            case 'p':
+                return LogArg_::POINTER == arg;
+            default:
+                return {};
+        }
+    }
+
+    /// 编译期检查格式串与参数类型、个数是否一致
+    template<std::size_t N>
+    consteval void checkLogFormat_(std::string_view const format,std::array<LogArg_,N> const & args) {
+        std::size_t index{};
+        auto const next{[&index,&args](bool const integer) {
+            if (index >= N) { LogFormatError_::tooFewArguments(); return; }
+            auto const arg{args[index++]};
+            if (LogArg_::INVALID == arg) { LogFormatError_::unsupportedArgumentType(); }
+            if (integer && LogArg_::SIGNED != arg && LogArg_::UNSIGNED != arg) { LogFormatError_::argumentTypeMismatch(); }
+        }};
+
+        for (auto pos{format.find('%')}; pos != std::string_view::npos; pos = format.find('%',pos)) {
+            auto const spec{parseLogSpec_(format,pos)};
+            pos = spec.m_end;
+            if ('%' == spec.m_conversion) { continue; }
+            if (!spec.m_conversion) { LogFormatError_::invalidConversionSpecifier(); }
+            if (spec.m_starWidth) { next(true); }
+            if (spec.m_starPrecision) { next(true); }
+            if (index >= N) { LogFormatError_::tooFewArguments(); }
+            if (LogArg_::INVALID == args[index]) { LogFormatError_::unsupportedArgumentType(); }
+            if (!acceptsLogArg_(spec.m_conversion,args[index])) { LogFormatError_::argumentTypeMismatch(); }
+            ++index;
+        }
+        if (index != N) { LogFormatError_::tooManyArguments(); }
+    }
+
+    template<typename T>
+    std::string_view logArgText_(T const & arg) noexcept {
+        if constexpr (std::is_pointer_v<T>) { return arg ? std::string_view{arg} : std::string_view{"(null)"}; }
+        else { return std::string_view{arg}; }
+    }
+
+    /// @return 参数编码后的字节数
+    template<typename T>
+    std::size_t logArgSize_(T const & arg) noexcept {
+        constexpr auto kind{logArgOf_<T>()};
+        if constexpr (LogArg_::STRING == kind) { return 1 + sizeof(std::uint32_t) + logArgText_(arg).size() + 1; }
+        else if constexpr (LogArg_::LONG_DOUBLE == kind) { return 1 + sizeof(long double); }
+        else if constexpr (LogArg_::POINTER == kind) { return 1 + sizeof(void const *); }
+        else { return 1 + sizeof(std::uint64_t); }
+    }
+
+    /// 编码一个参数
+    /// @return 写入后的位置
+    template<typename T>
+    char * encodeLogArg_(char * out,T const & arg) noexcept {
+        constexpr auto kind{logArgOf_<T>()};
+        *out++ = static_cast<char>(kind);
+        auto const put{[&out](auto const & value) noexcept {
+            std::memcpy(out,std::addressof(value),sizeof(value));
+            out += sizeof(value);
+        }};
+        if constexpr (LogArg_::SIGNED == kind) { put(static_cast<std::int64_t>(arg)); }
+        else if constexpr (LogArg_::UNSIGNED == kind) { put(static_cast<std::uint64_t>(arg)); }
+        else if constexpr (LogArg_::DOUBLE == kind) { put(static_cast<double>(arg)); }
+        else if constexpr (LogArg_::LONG_DOUBLE == kind) { put(arg); }
+        else if constexpr (LogArg_::POINTER == kind) { put(static_cast<void const *>(arg)); }
+        else {
+            auto const text{logArgText_(arg)};
+            put(static_cast<std::uint32_t>(text.size()));
+            std::memcpy(out,text.data(),text.size());
+            out += text.size();
+            *out++ = '\0';
+        }
+        return out;
+    }
+
+    /**
+     * 按格式串和编码后的参数格式化,追加到out,由工作线程调用
+     * 每个转换说明单独交给snprintf,长度修饰符替换为与编码类型一致的修饰符
+     */
+    X_API void appendLogFormat_(std::string_view format,std::string_view args,std::string & out);
+}
+
+/**
+ * @brief 编译期检查的printf风格格式串
+ * 只能由字符串字面量等常量表达式构造,格式串与参数的类型或个数不一致时编译失败
+ * 与printf相比,%s还接受std::string与std::string_view,%p只接受非字符指针
+ * @tparam Args 格式参数类型
+ */
+template<typename... Args>
+class XLogFormatString final {
+    char const * m_str_{};
+
+public:
+    consteval XLogFormatString(char const * const format) noexcept : m_str_{format} {
+        XPrivate::checkLogFormat_(format,std::array<XPrivate::LogArg_,sizeof...(Args)>{XPrivate::logArgOf_<Args>()...});
+    }
+
+    [[nodiscard]] constexpr char const * get() const noexcept
+    { return m_str_; }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
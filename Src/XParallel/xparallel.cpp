@@ -0,0 +1,74 @@
+#include "xparallel.hpp"
+#include <atomic>
+#include <exception>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+namespace {
+
+    /**
+     * 一次并行调用的共享状态
+     * 辅助任务可能在调用返回后才被调度,因此由shared_ptr持有,
+     * 此时所有块已被领取,迟到的辅助任务不会再访问调用者栈上的ctx
+     */
+    class XParallelState_ final {
+    public:
+        void (*m_invoke)(void *,std::size_t,std::size_t){};
+        void * m_ctx{};
+        std::size_t m_size{},m_grain{},m_chunks{};
+        std::atomic_size_t m_next{},m_done{};
+        std::atomic_bool m_failed{};
+        /// 只由第一个失败的块写入,m_done的release/acquire保证调用线程可见
+        std::exception_ptr m_error{};
+
+        void work() noexcept {
+            for (auto chunk{m_next.fetch_add(1,std::memory_order_relaxed)}; chunk < m_chunks;
+                chunk = m_next.fetch_add(1,std::memory_order_relaxed))
+            {
+                if (!m_failed.load(std::memory_order_relaxed)) {
+                    auto const begin{chunk * m_grain};
+                    try { m_invoke(m_ctx,begin,std::min(begin + m_grain,m_size)); }
+                    catch (...) { if (!m_failed.exchange(true)) { m_error = std::current_exception(); } }
+                }
+                if (m_done.fetch_add(1,std::memory_order_acq_rel) + 1 == m_chunks) { m_done.notify_all(); }
+            }
+        }
+    };
+}
+
+std::size_t XParallel::grainSize(XThreadPool const & pool,std::size_t const size,std::size_t const grain) noexcept {
+    if (grain) { return grain; }
+    auto const threads{static_cast<std::size_t>(std::max<XSize_t>(pool.currentThreadsSize(),0)) + 1};
+    auto const chunks{threads * AutoChunksPerThread};
+    return std::max<std::size_t>((size + chunks - 1) / chunks,1);
+}
+
+void XParallel::run_(XThreadPool & pool,std::size_t const size,std::size_t const grain,chunk_t const invoke,void * const ctx) {
+    if (!size) { return; }
+    auto const chunks{(size + grain - 1) / grain};
+    if (chunks < 2) { invoke(ctx,0,size); return; }
+
+    auto const state{std::make_shared<XParallelState_>()};
+    state->m_invoke = invoke;
+    state->m_ctx = ctx;
+    state->m_size = size;
+    state->m_grain = grain;
+    state->m_chunks = chunks;
+
+    // 调用线程自身也领取块,辅助任务数不超过剩余块数
+    for (auto helpers{std::min(chunks - 1,static_cast<std::size_t>(std::max<XSize_t>(pool.currentThreadsSize(),0)))};
+        helpers; --helpers)
+    { if (!pool.runnableJoinDetached([state]{ state->work(); })) { break; } }
+
+    state->work();
+
+    for (auto done{state->m_done.load(std::memory_order_acquire)}; done != chunks;
+        done = state->m_done.load(std::memory_order_acquire))
+    { state->m_done.wait(done,std::memory_order_acquire); }
+
+    if (state->m_error) { std::rethrow_exception(state->m_error); }
+}
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
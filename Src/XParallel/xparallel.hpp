@@ -0,0 +1,162 @@
+#ifndef XUTILS2_X_PARALLEL_HPP
+#define XUTILS2_X_PARALLEL_HPP 1
+
+#include <XThreadPool/xthreadpool.hpp>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 基于XThreadPool的数据并行算法
+ * 区间按grain切成连续的块,调用线程与至多(线程池线程数)个辅助任务原子地领取块,
+ * 调用线程参与计算而不是阻塞等待,辅助任务没有被及时调度时由调用线程独自完成剩余的块,
+ * 因此在工作线程内嵌套调用也不会死锁
+ * 每次调用只提交少量辅助任务,不会为每个元素分配任务
+ * grain为0时按线程数自动选择,每个参与的线程约分到AutoChunksPerThread个块
+ * 任一块抛出异常后不再执行剩余的块,异常在调用线程重新抛出
+ */
+class X_CLASS_EXPORT XParallel final {
+public:
+    static constexpr std::size_t AutoChunksPerThread{4};
+
+    XParallel() = delete;
+
+    /// @return grain为0时按线程数计算的块大小,否则返回grain
+    [[nodiscard]] static std::size_t grainSize(XThreadPool const & pool,std::size_t size,std::size_t grain) noexcept;
+
+    /// 并行执行[first,last),fn可以是fn(index)或者fn(begin,end)
+    template<typename Fn>
+    static void parallelFor(XThreadPool & pool,std::size_t const first,std::size_t const last,std::size_t const grain,Fn && fn) {
+        if (first >= last) { return; }
+        auto const size{last - first};
+        forChunks_(pool,size,grainSize(pool,size,grain),[&fn,first](std::size_t const begin,std::size_t const end) {
+            if constexpr (std::is_invocable_v<Fn &,std::size_t,std::size_t>) { std::invoke(fn,first + begin,first + end); }
+            else { for (auto i{first + begin}; i < first + end; ++i) { std::invoke(fn,i); } }
+        });
+    }
+
+    /// 对区间的每个元素执行fn(element)
+    template<std::ranges::random_access_range Range,typename Fn> requires std::ranges::sized_range<Range>
+    static void parallelFor(XThreadPool & pool,Range && range,std::size_t const grain,Fn && fn) {
+        auto const it{std::ranges::begin(range)};
+        parallelFor(pool,{},static_cast<std::size_t>(std::ranges::size(range)),grain,[&fn,it](std::size_t const i)
+            { std::invoke(fn,at_(it,i)); });
+    }
+
+    /// out[i] = fn(range[i])
+    /// @return 输出区间的末尾
+    template<std::ranges::random_access_range Range,std::random_access_iterator OutIt,typename Fn>
+        requires std::ranges::sized_range<Range>
+    static OutIt parallelTransform(XThreadPool & pool,Range && range,OutIt const out,std::size_t const grain,Fn && fn) {
+        auto const it{std::ranges::begin(range)};
+        auto const size{static_cast<std::size_t>(std::ranges::size(range))};
+        parallelFor(pool,{},size,grain,[&fn,it,out](std::size_t const begin,std::size_t const end)
+            { for (auto i{begin}; i < end; ++i) { at_(out,i) = std::invoke(fn,at_(it,i)); } });
+        return out + static_cast<std::iter_difference_t<OutIt>>(size);
+    }
+
+    /// 每块按顺序归约,再按块的顺序与init合并,op满足结合律即可,不要求交换律
+    template<std::ranges::random_access_range Range,typename T,typename Op = std::plus<>>
+        requires std::ranges::sized_range<Range>
+    [[nodiscard]] static T parallelReduce(XThreadPool & pool,Range && range,std::size_t const grain,T init,Op op = {}) {
+        for (auto & partial : partials_<T>(pool,range,grain,op))
+        { init = std::invoke(op,std::move(init),std::move(*partial)); }
+        return init;
+    }
+
+    /// 包含式前缀扫描: out[i] = init op range[0] op ... op range[i]
+    /// 先并行求每块的归约,顺序计算每块的起始值,再并行扫描每块
+    /// @return 输出区间的末尾
+    template<std::ranges::random_access_range Range,std::random_access_iterator OutIt,typename T,typename Op = std::plus<>>
+        requires std::ranges::sized_range<Range>
+    static OutIt parallelScan(XThreadPool & pool,Range && range,OutIt const out,std::size_t const grain,T init,Op op = {}) {
+        auto const it{std::ranges::begin(range)};
+        auto const size{static_cast<std::size_t>(std::ranges::size(range))};
+        auto const g{grainSize(pool,size,grain)};
+        auto partials{partials_<T>(pool,range,g,op)};
+        std::vector<T> offsets{};
+        offsets.reserve(partials.size());
+        for (auto & partial : partials) {
+            offsets.push_back(init);
+            init = std::invoke(op,std::move(init),std::move(*partial));
+        }
+        forChunks_(pool,size,g,[&op,&offsets,it,out,g](std::size_t const begin,std::size_t const end) {
+            auto acc{std::move(offsets[begin / g])};
+            for (auto i{begin}; i < end; ++i) {
+                acc = std::invoke(op,std::move(acc),at_(it,i));
+                at_(out,i) = acc;
+            }
+        });
+        return out + static_cast<std::iter_difference_t<OutIt>>(size);
+    }
+
+    /// 每块并行排序后两两归并,每轮归并同样并行执行,不保证稳定
+    template<std::ranges::random_access_range Range,typename Comp = std::ranges::less>
+        requires std::ranges::sized_range<Range>
+    static void parallelSort(XThreadPool & pool,Range && range,std::size_t const grain = {},Comp comp = {}) {
+        auto const it{std::ranges::begin(range)};
+        auto const size{static_cast<std::size_t>(std::ranges::size(range))};
+        if (size < 2) { return; }
+        auto const g{grainSize(pool,size,grain)};
+        forChunks_(pool,size,g,[&comp,it](std::size_t const begin,std::size_t const end)
+            { std::sort(it + diff_(it,begin),it + diff_(it,end),std::ref(comp)); });
+        for (auto width{g}; width < size; width *= 2) {
+            auto const pairs{(size + 2 * width - 1) / (2 * width)};
+            forChunks_(pool,pairs,1,[&comp,it,width,size](std::size_t const begin,std::size_t const end) {
+                for (auto pair{begin}; pair < end; ++pair) {
+                    auto const low{pair * 2 * width},mid{std::min(low + width,size)},high{std::min(low + 2 * width,size)};
+                    if (mid < high)
+                    { std::inplace_merge(it + diff_(it,low),it + diff_(it,mid),it + diff_(it,high),std::ref(comp)); }
+                }
+            });
+        }
+    }
+
+private:
+    using chunk_t = void(*)(void *,std::size_t,std::size_t);
+
+    /// 把[0,size)按grain分块,由调用线程与辅助任务共同执行,全部结束后返回
+    static void run_(XThreadPool & pool,std::size_t size,std::size_t grain,chunk_t invoke,void * ctx);
+
+    template<typename F>
+    static void forChunks_(XThreadPool & pool,std::size_t const size,std::size_t const grain,F && f) {
+        using fn_t = std::remove_reference_t<F>;
+        run_(pool,size,grain,[](void * const ctx,std::size_t const begin,std::size_t const end)
+            { (*static_cast<fn_t *>(ctx))(begin,end); },std::addressof(f));
+    }
+
+    template<typename It>
+    static constexpr auto diff_(It const &,std::size_t const i) noexcept
+    { return static_cast<std::iter_difference_t<It>>(i); }
+
+    template<typename It>
+    static constexpr decltype(auto) at_(It const & it,std::size_t const i)
+    { return it[diff_(it,i)]; }
+
+    /// @return 每块的归约结果,块内至少有一个元素,因此均有值
+    template<typename T,typename Range,typename Op>
+    static std::vector<std::optional<T>> partials_(XThreadPool & pool,Range && range,std::size_t const grain,Op & op) {
+        auto const it{std::ranges::begin(range)};
+        auto const size{static_cast<std::size_t>(std::ranges::size(range))};
+        if (!size) { return {}; }
+        auto const g{grainSize(pool,size,grain)};
+        std::vector<std::optional<T>> ret((size + g - 1) / g);
+        forChunks_(pool,size,g,[&op,&ret,it,g](std::size_t const begin,std::size_t const end) {
+            auto & acc{ret[begin / g]};
+            acc.emplace(at_(it,begin));
+            for (auto i{begin + 1}; i < end; ++i) { *acc = std::invoke(op,std::move(*acc),at_(it,i)); }
+        });
+        return ret;
+    }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
@@ -22,7 +22,13 @@ XAbstractRunnable::XAbstractRunnable(FuncVer const is_OverrideConst)
 }
 
 [[maybe_unused]] bool XAbstractRunnable::is_Running() const noexcept
-{ X_D(const XAbstractRunnable); return d->m_is_running && d->m_is_running(); }
+{ X_D(const XAbstractRunnable); return !d->cancelled() && d->m_is_running && d->m_is_running(); }
+
+[[maybe_unused]] bool XAbstractRunnable::isCancelled() const noexcept
+{ return d_func()->cancelled(); }
+
+[[maybe_unused]] XCancellationToken XAbstractRunnable::cancellationToken() const noexcept
+{ return d_func()->m_token; }
 
 void XAbstractRunnable::call() const {
     X_D(const XAbstractRunnable);
@@ -47,8 +53,10 @@ void XAbstractRunnable::call() const {
     d->m_owner.storeRelease({});
 }
 
-void XAbstractRunnable::resetRecall_() const noexcept
-{ d_func()->m_result_.reset(); }
+void XAbstractRunnable::resetRecall_() const noexcept {
+    d_func()->m_result_.reset();
+    resetTypedState_();
+}
 
 void XAbstractRunnable::allow_get_() const noexcept
 { d_func()->m_result_.allow_get(); }
@@ -59,6 +67,18 @@ void XAbstractRunnable::set_exit_function_(std::function<bool()> &&f) const noex
 XAtomicPointer<const void> & XAbstractRunnable::Owner_() const noexcept
 { return d_func()->m_owner; }
 
+void XAbstractRunnablePrivate::execute() noexcept {
+    if (auto const self{std::move(m_retain)}) { self->call(); }
+}
+
+void XAbstractRunnablePrivate::discard() noexcept {
+    auto const self{std::move(m_retain)};
+    if (self) { self->abandonTypedState_(); }
+    m_result_.set({});
+    m_is_running = {};
+    m_owner.storeRelease({});
+}
+
 XAbstractRunnablePtr XAbstractRunnable::joinThreadPool(XThreadPoolPtr const & pool) noexcept {
     auto ret{ shared_from_this() };
     if (pool){ pool->runnableJoin(ret); }
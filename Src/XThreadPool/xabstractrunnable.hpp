@@ -7,6 +7,9 @@
 #include <functional>
 #include <XAtomic/xatomic.hpp>
 #include <XThreadPool/xresult.hpp>
+#include <XThreadPool/xfuture.hpp>
+#include <XThreadPool/xcancellation.hpp>
+#include <typeinfo>
 
 XTD_NAMESPACE_BEGIN
 XTD_INLINE_NAMESPACE_BEGIN(v1)
@@ -19,6 +22,7 @@ using XAbstractRunnablePtr = std::shared_ptr<XAbstractRunnable>;
 class X_CLASS_EXPORT XAbstractRunnableData {
     X_DISABLE_COPY_MOVE(XAbstractRunnableData)
     friend class XAbstractRunnable;
+    friend class XAbstractRunnablePrivate;
     XResult m_result_{};
 
 public:
@@ -48,9 +52,17 @@ public:
     /// @param model_
     /// @tparam Ty
     /// @return T类型
+    /// 由runnableJoin加入的可调用对象直接从类型化结果读取,不经过std::any,Ty需与返回值类型一致
     template<typename Ty>
     [[maybe_unused]] [[nodiscard]] constexpr Ty result(const Model& model_ = Model::BLOCK) const noexcept(false) {
         const auto & r{m_d_ptr_->m_result_};
+        if (auto const f{future<Ty>()}; f.valid()) {
+            if (Model::BLOCK == model_) {
+                if (!r.checkGet_()) { return Ty{}; }
+                f.wait();
+            }
+            return f.hasValue() ? Ty(f.get()) : Ty{};
+        }
         return Model::BLOCK == model_ ? r.get<Ty>() : r.try_get<Ty>();
     }
 
@@ -61,8 +73,11 @@ public:
     /// @param rel_time
     /// @return Ty类型数据
     template<typename Ty,typename Rep_,typename Period_>
-    [[maybe_unused]] [[nodiscard]] constexpr Ty result(const std::chrono::duration<Rep_,Period_> &rel_time) const noexcept(false)
-    { return m_d_ptr_->m_result_.get_for<Ty>(rel_time); }
+    [[maybe_unused]] [[nodiscard]] constexpr Ty result(const std::chrono::duration<Rep_,Period_> &rel_time) const noexcept(false) {
+        if (auto const f{future<Ty>()}; f.valid())
+        { return f.waitFor(rel_time) && f.hasValue() ? Ty(f.get()) : Ty{}; }
+        return m_d_ptr_->m_result_.get_for<Ty>(rel_time);
+    }
 
     /// 带指定时间等候返回值
     /// @tparam Ty
@@ -70,8 +85,19 @@ public:
     /// @param abs_time_
     /// @return Ty类型
     template<typename Ty,typename Clock_,typename Duration_>
-    [[maybe_unused]] [[nodiscard]] constexpr Ty result(const std::chrono::time_point<Clock_,Duration_> & abs_time_) const noexcept(false)
-    { return m_d_ptr_->m_result_.get_until<Ty>(abs_time_); }
+    [[maybe_unused]] [[nodiscard]] constexpr Ty result(const std::chrono::time_point<Clock_,Duration_> & abs_time_) const noexcept(false) {
+        if (auto const f{future<Ty>()}; f.valid())
+        { return f.waitUntil(abs_time_) && f.hasValue() ? Ty(f.get()) : Ty{}; }
+        return m_d_ptr_->m_result_.get_until<Ty>(abs_time_);
+    }
+
+    /// 获取类型化结果,只有由runnableJoin加入的可调用对象且Ty与返回值类型一致时有效
+    /// XFuture可以复制和多次读取,不受result的"只能取一次"限制
+    /// @tparam Ty
+    /// @return XFuture<Ty>,不支持时valid()为false
+    template<typename Ty>
+    [[maybe_unused]] [[nodiscard]] XFuture<Ty> future() const noexcept
+    { return XFuture<Ty>{std::static_pointer_cast<XFutureState_<Ty>>(typedState_(typeid(Ty)))}; }
 
     /// 加入线程池,会按照默认线程数量启动线程池
     /// 如果需要调整数量(需在FIXED模式才有意义),请自行调用线程池start函数输入线程数量
@@ -79,10 +105,17 @@ public:
     /// @return 任务对象
     [[maybe_unused]] XAbstractRunnablePtr joinThreadPool(std::shared_ptr<XThreadPool> const & pool) noexcept;
 
-    /// 检查线程池是否运行
+    /// 检查线程池是否运行,任务的取消令牌被取消后同样返回false
     /// @return  ture or false
     [[maybe_unused]] [[maybe_unused]] [[nodiscard]] bool is_Running() const noexcept;
 
+    /// 在run()内协作式地检查取消,开销为一次原子读
+    /// @return 加入线程池时指定的取消令牌已被取消
+    [[maybe_unused]] [[nodiscard]] bool isCancelled() const noexcept;
+
+    /// @return 最近一次加入线程池时指定的取消令牌
+    [[maybe_unused]] [[nodiscard]] XCancellationToken cancellationToken() const noexcept;
+
     virtual ~XAbstractRunnable() = default;
 
 protected:
@@ -95,14 +128,23 @@ protected:
 private:
     virtual std::any run();
     virtual std::any run() const;
+    /// 类型化结果的共享状态,类型不一致或不支持时返回空
+    [[nodiscard]] virtual std::shared_ptr<void> typedState_(std::type_info const &) const noexcept { return {}; }
+    /// 重新加入线程池前复位类型化结果
+    virtual void resetTypedState_() const noexcept {}
+    /// 任务未被执行就被丢弃时,唤醒等待类型化结果的调用者
+    virtual void abandonTypedState_() const noexcept {}
     explicit XAbstractRunnable(FuncVer );
     void call() const;
     void set_exit_function_(std::function<bool()> &&) const noexcept;
+    [[nodiscard]] XReadyFlag_ const & readyFlag_() const noexcept
+    { return m_d_ptr_->m_result_.ready_(); }
     void resetRecall_() const noexcept;
     void allow_get_() const noexcept;
     XAtomicPointer<const void> &Owner_() const noexcept;
 
     template<typename> friend class XRunnable;
+    friend class XRunnableAwaiter_;
     friend class XThreadPool;
     friend class XThreadPoolPrivate;
 };
@@ -2,11 +2,14 @@
 #define XUTILS2_X_ABSTRACT_RUNNABLE_P_HPP 1
 
 #include <XThreadPool/xabstractrunnable.hpp>
+#include "xpooltask_p.hpp"
 
 XTD_NAMESPACE_BEGIN
 XTD_INLINE_NAMESPACE_BEGIN(v1)
 
-class X_CLASS_EXPORT XAbstractRunnablePrivate final : public XAbstractRunnableData {
+class X_CLASS_EXPORT XAbstractRunnablePrivate final
+    : public XAbstractRunnableData , public XPoolTask_
+{
 
 public:
     X_DECLARE_PUBLIC(XAbstractRunnable)
@@ -19,9 +22,14 @@ public:
     mutable XAtomicBool m_recall{};
     mutable std::function<bool()> m_is_running{};
     mutable XAtomicPointer<const void> m_owner{};
+    /// 在队列中时,由线程池持有任务的所有权
+    XAbstractRunnablePtr m_retain{};
 
     constexpr XAbstractRunnablePrivate() = default;
     ~XAbstractRunnablePrivate() override = default;
+
+    void execute() noexcept override;
+    void discard() noexcept override;
 };
 
 XTD_INLINE_NAMESPACE_END
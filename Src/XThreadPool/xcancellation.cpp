@@ -0,0 +1,54 @@
+#include "xcancellation.hpp"
+#include <algorithm>
+#include <utility>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+static constinit thread_local XCancellationToken const * sm_currentToken_{};
+
+bool XCancellationState_::cancel() noexcept {
+    if (m_cancelled.exchange(true,std::memory_order_acq_rel)) { return {}; }
+    std::vector<std::weak_ptr<XCancellationState_>> children{};
+    {
+        std::unique_lock lock(m_mtx);
+        children.swap(m_children);
+    }
+    for (auto const & weak : children) {
+        if (auto const child{weak.lock()}) { child->cancel(); }
+    }
+    return true;
+}
+
+void XCancellationState_::attach(std::shared_ptr<XCancellationState_> const & child) {
+    {
+        std::unique_lock lock(m_mtx);
+        if (!m_cancelled.load(std::memory_order_acquire)) {
+            // 容量用尽时先清理已析构的子状态,避免长期存在的父令牌无限增长
+            if (m_children.size() == m_children.capacity())
+            { std::erase_if(m_children,[](auto const & weak) noexcept { return weak.expired(); }); }
+            m_children.push_back(child);
+            return;
+        }
+    }
+    child->cancel();
+}
+
+XCancellationToken const * XCancellationToken::exchangeCurrent_(XCancellationToken const * const token) noexcept
+{ return std::exchange(sm_currentToken_,token); }
+
+XCancellationToken const & XCancellationToken::current() noexcept {
+    static XCancellationToken const none{};
+    auto const token{sm_currentToken_};
+    return token ? *token : none;
+}
+
+XCancellationSource::XCancellationSource()
+    : m_state_{std::make_shared<XCancellationState_>()} {}
+
+XCancellationSource::XCancellationSource(XCancellationToken const & parent)
+    : XCancellationSource()
+{ if (parent.m_state_) { parent.m_state_->attach(m_state_); } }
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
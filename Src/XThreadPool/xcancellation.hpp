@@ -0,0 +1,105 @@
+#ifndef XUTILS2_X_CANCELLATION_HPP
+#define XUTILS2_X_CANCELLATION_HPP 1
+
+#include <XHelper/xhelper.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+class XThreadPoolPrivate;
+class XTaskGroupState_;
+
+/**
+ * 取消令牌的共享状态
+ * 取消时向下传播到所有子状态,因此检查只需要读取自身的标志
+ */
+class X_CLASS_EXPORT XCancellationState_ final {
+public:
+    X_DISABLE_COPY_MOVE(XCancellationState_)
+
+    std::atomic_bool m_cancelled{};
+    std::mutex m_mtx{};
+    /// 由m_mtx保护,取消后清空
+    std::vector<std::weak_ptr<XCancellationState_>> m_children{};
+
+    XCancellationState_() = default;
+    ~XCancellationState_() = default;
+
+    /// @return 本次调用完成了取消
+    bool cancel() noexcept;
+
+    /// 登记子状态,已取消时直接取消子状态
+    void attach(std::shared_ptr<XCancellationState_> const & child);
+};
+
+/**
+ * 取消令牌,由XCancellationSource发放,复制开销为一次引用计数
+ * 默认构造的令牌永远不会被取消
+ * 任务内通过isCancelled()协作式地检查,开销为一次原子读
+ */
+class X_CLASS_EXPORT XCancellationToken final {
+    std::shared_ptr<XCancellationState_> m_state_{};
+
+    explicit XCancellationToken(std::shared_ptr<XCancellationState_> state) noexcept
+        : m_state_{std::move(state)} {}
+
+    /// 设置当前线程正在执行的任务的令牌
+    /// @return 之前的令牌
+    static XCancellationToken const * exchangeCurrent_(XCancellationToken const *) noexcept;
+
+    friend class XCancellationSource;
+    friend class XThreadPoolPrivate;
+    friend class XTaskGroupState_;
+
+public:
+    XCancellationToken() = default;
+
+    /// @return 已被取消
+    [[nodiscard]] bool isCancelled() const noexcept
+    { return m_state_ && m_state_->m_cancelled.load(std::memory_order_acquire); }
+
+    /// @return 由XCancellationSource发放,可能被取消
+    [[nodiscard]] bool canBeCancelled() const noexcept
+    { return static_cast<bool>(m_state_); }
+
+    /// 线程池任务执行期间为该任务的令牌,其他情况下为永远不会被取消的令牌
+    /// 用于runnableJoinDetached等没有task对象的可调用对象
+    /// @return 当前线程正在执行的任务的令牌
+    [[nodiscard]] static XCancellationToken const & current() noexcept;
+
+    [[nodiscard]] bool operator==(XCancellationToken const &) const noexcept = default;
+};
+
+/**
+ * 取消源,可以为单个任务或一组任务(共用同一令牌)发放令牌
+ * 以父令牌构造时成为其子组,父令牌取消时子组一并取消,子组取消不影响父令牌
+ * 已排队且令牌已取消的任务在出队时直接丢弃,不再执行,等待结果的调用者得到空返回值或broken_promise
+ */
+class X_CLASS_EXPORT XCancellationSource final {
+    std::shared_ptr<XCancellationState_> m_state_{};
+
+public:
+    XCancellationSource();
+
+    explicit XCancellationSource(XCancellationToken const & parent);
+
+    [[nodiscard]] XCancellationToken token() const noexcept
+    { return XCancellationToken{m_state_}; }
+
+    /// 取消令牌及其所有子组,重复调用无效
+    /// @return 本次调用完成了取消
+    bool cancel() noexcept
+    { return m_state_->cancel(); }
+
+    [[nodiscard]] bool isCancelled() const noexcept
+    { return m_state_->m_cancelled.load(std::memory_order_acquire); }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
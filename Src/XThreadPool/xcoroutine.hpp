@@ -0,0 +1,267 @@
+#ifndef XUTILS2_X_COROUTINE_HPP
+#define XUTILS2_X_COROUTINE_HPP 1
+
+#include <XThreadPool/xthreadpool.hpp>
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <variant>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 协程帧分配入口
+ * 协程的第一个参数是XThreadPoolPtr或XThreadPool &时使用该线程池的帧分配器,
+ * 否则在工作线程中使用所在线程池的分配器,其他线程使用::operator new
+ */
+class X_CLASS_EXPORT XCoroutineFrame_ final {
+public:
+    XCoroutineFrame_() = delete;
+
+    [[nodiscard]] static void * allocate(std::size_t size,XThreadPool const * pool);
+
+    static void deallocate(void * frame) noexcept;
+
+    /// 供promise_type继承,统一帧的分配与释放
+    class Allocated_ {
+    public:
+        [[nodiscard]] static void * operator new(std::size_t const size)
+        { return allocate(size,{}); }
+
+        /// 强制内联: GCC按修饰名配对new与delete,模板operator new与operator delete(void *)
+        /// 在-O0下会被判为不匹配(-Wmismatched-new-delete),内联后调用的是allocate
+        template<typename... Args>
+        [[nodiscard]] X_FORCE_INLINE static void * operator new(std::size_t const size,XThreadPoolPtr const & pool,Args const & ...)
+        { return allocate(size,pool.get()); }
+
+        template<typename... Args>
+        [[nodiscard]] X_FORCE_INLINE static void * operator new(std::size_t const size,XThreadPool & pool,Args const & ...)
+        { return allocate(size,std::addressof(pool)); }
+
+        static void operator delete(void * const frame) noexcept
+        { deallocate(frame); }
+
+        /// 与带参数的operator new配对
+        template<typename... Args>
+        static void operator delete(void * const frame,XThreadPoolPtr const &,Args const & ...) noexcept
+        { deallocate(frame); }
+
+        template<typename... Args>
+        static void operator delete(void * const frame,XThreadPool &,Args const & ...) noexcept
+        { deallocate(frame); }
+    };
+};
+
+template<typename T = void>
+class XTask;
+
+template<typename T>
+class XTaskPromiseBase_ : public XCoroutineFrame_::Allocated_ {
+protected:
+    std::coroutine_handle<> m_continuation_{};
+    std::variant<std::monostate,std::conditional_t<std::is_void_v<T>,std::monostate,T>,std::exception_ptr> m_result_{};
+
+    struct FinalAwaiter_ final {
+        [[nodiscard]] static constexpr bool await_ready() noexcept { return {}; }
+
+        template<typename Promise_>
+        [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise_> const handle) const noexcept {
+            // 对称转移回等待者,不增加调用栈深度
+            if (auto const continuation{handle.promise().m_continuation_}) { return continuation; }
+            return std::noop_coroutine();
+        }
+
+        static constexpr void await_resume() noexcept {}
+    };
+
+    template<typename> friend class XTask;
+
+public:
+    [[nodiscard]] static std::suspend_always initial_suspend() noexcept { return {}; }
+
+    [[nodiscard]] static FinalAwaiter_ final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept
+    { m_result_.template emplace<2>(std::current_exception()); }
+};
+
+template<typename T>
+class XTaskPromise_ final : public XTaskPromiseBase_<T> {
+public:
+    XTask<T> get_return_object() noexcept;
+
+    template<typename U = T>
+    void return_value(U && value)
+    { this->m_result_.template emplace<1>(std::forward<U>(value)); }
+};
+
+template<>
+class XTaskPromise_<void> final : public XTaskPromiseBase_<void> {
+public:
+    XTask<void> get_return_object() noexcept;
+
+    void return_void() noexcept
+    { this->m_result_.template emplace<1>(); }
+};
+
+/**
+ * 惰性协程任务,在被co_await或交给XThreadPool::spawn时才开始执行
+ * 等待者挂起后被等待的协程在同一线程直接开始,结束时对称转移回等待者,不阻塞工作线程
+ * 协程帧由线程池的帧分配器分配
+ * @tparam T 返回值类型
+ */
+template<typename T>
+class [[nodiscard]] XTask final {
+public:
+    using promise_type = XTaskPromise_<T>;
+    using handle_t = std::coroutine_handle<promise_type>;
+
+private:
+    handle_t m_handle_{};
+
+    struct Awaiter_ final {
+        handle_t m_handle{};
+
+        [[nodiscard]] bool await_ready() const noexcept
+        { return !m_handle || m_handle.done(); }
+
+        [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<> const awaiting) const noexcept {
+            m_handle.promise().m_continuation_ = awaiting;
+            return m_handle;
+        }
+
+        T await_resume() const noexcept(false) {
+            if (!m_handle) { throw std::future_error(std::future_errc::no_state); }
+            auto & result{m_handle.promise().m_result_};
+            if (2 == result.index()) { std::rethrow_exception(std::get<2>(result)); }
+            if constexpr (!std::is_void_v<T>) { return std::move(std::get<1>(result)); }
+        }
+    };
+
+public:
+    constexpr XTask() = default;
+    explicit XTask(handle_t const handle) noexcept : m_handle_{handle} {}
+    XTask(XTask && o) noexcept : m_handle_{std::exchange(o.m_handle_,{})} {}
+
+    XTask & operator=(XTask && o) noexcept {
+        if (this != std::addressof(o)) {
+            if (m_handle_) { m_handle_.destroy(); }
+            m_handle_ = std::exchange(o.m_handle_,{});
+        }
+        return *this;
+    }
+
+    ~XTask() { if (m_handle_) { m_handle_.destroy(); } }
+
+    X_DISABLE_COPY(XTask)
+
+    [[nodiscard]] bool valid() const noexcept
+    { return static_cast<bool>(m_handle_); }
+
+    [[nodiscard]] bool isReady() const noexcept
+    { return m_handle_ && m_handle_.done(); }
+
+    Awaiter_ operator co_await() const & noexcept { return Awaiter_{m_handle_}; }
+    Awaiter_ operator co_await() const && noexcept { return Awaiter_{m_handle_}; }
+};
+
+template<typename T>
+XTask<T> XTaskPromise_<T>::get_return_object() noexcept
+{ return XTask<T>{XTask<T>::handle_t::from_promise(*this)}; }
+
+inline XTask<void> XTaskPromise_<void>::get_return_object() noexcept
+{ return XTask<void>{XTask<void>::handle_t::from_promise(*this)}; }
+
+/**
+ * 等待XFuture,未就绪时挂起,由设置结果的线程恢复协程
+ * 注册时发现已经就绪则不挂起,由await_suspend返回false在当前栈帧继续,不嵌套恢复
+ * 需要回到线程池时再co_await pool->schedule()
+ */
+template<typename T>
+class XFutureAwaiter_ final {
+    XFuture<T> m_future_{};
+public:
+    explicit XFutureAwaiter_(XFuture<T> future) noexcept : m_future_{std::move(future)} {}
+
+    [[nodiscard]] bool await_ready() const noexcept
+    { return !m_future_.valid() || m_future_.isReady(); }
+
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<> const handle) const
+    { return m_future_.tryOnReady([handle]() noexcept { handle.resume(); }); }
+
+    std::conditional_t<std::is_void_v<T>,void,T> await_resume() const noexcept(false) {
+        if constexpr (std::is_void_v<T>) { m_future_.get(); }
+        else { return m_future_.get(); }
+    }
+};
+
+template<typename T>
+XFutureAwaiter_<T> operator co_await(XFuture<T> future) noexcept
+{ return XFutureAwaiter_<T>{std::move(future)}; }
+
+/**
+ * 等待task对象结束(即XResult就绪),不读取返回值
+ * 返回值通过task->future<T>()或result<T>(Model::NONBLOCK)读取
+ */
+class X_CLASS_EXPORT XRunnableAwaiter_ final {
+    XAbstractRunnablePtr m_task_{};
+public:
+    explicit XRunnableAwaiter_(XAbstractRunnablePtr task) noexcept : m_task_{std::move(task)} {}
+
+    [[nodiscard]] bool await_ready() const noexcept
+    { return !m_task_ || m_task_->readyFlag_().isReady(); }
+
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<> const handle) const
+    { return m_task_->readyFlag_().tryOnReady([handle]() noexcept { handle.resume(); }); }
+
+    static constexpr void await_resume() noexcept {}
+};
+
+template<typename Runnable> requires std::is_base_of_v<XAbstractRunnable,Runnable>
+XRunnableAwaiter_ operator co_await(std::shared_ptr<Runnable> task) noexcept
+{ return XRunnableAwaiter_{std::move(task)}; }
+
+/**
+ * spawn使用的分离协程,立即开始,结束时自动释放帧
+ */
+class XDetachedTask_ final {
+public:
+    class promise_type final : public XCoroutineFrame_::Allocated_ {
+    public:
+        static XDetachedTask_ get_return_object() noexcept { return {}; }
+        [[nodiscard]] static std::suspend_never initial_suspend() noexcept { return {}; }
+        [[nodiscard]] static std::suspend_never final_suspend() noexcept { return {}; }
+        static void return_void() noexcept {}
+        static void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/// 第一个参数为线程池,协程帧使用该线程池的分配器
+/// 帧不持有线程池: 帧可能在工作线程上释放,持有最后一个引用会使线程池在自己的工作线程上析构
+/// pool只在转移到工作线程时使用,此时调用者仍持有线程池
+template<typename T>
+XDetachedTask_ spawnDetached_(XThreadPool & pool,XTask<T> task,XPromise<T> promise) {
+    co_await pool.schedule();
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+            promise.setValue();
+        } else {
+            promise.setValue(co_await task);
+        }
+    } catch (...) { promise.setException(std::current_exception()); }
+}
+
+template<typename T>
+XFuture<T> XThreadPool::spawn(XTask<T> task) {
+    XPromise<T> promise{};
+    auto ret{promise.getFuture()};
+    spawnDetached_(*this,std::move(task),std::move(promise));
+    return ret;
+}
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
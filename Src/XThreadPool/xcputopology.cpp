@@ -0,0 +1,86 @@
+#include "xcputopology_p.hpp"
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <numeric>
+
+#if defined(X_PLATFORM_LINUX) || defined(X_PLATFORM_MACOS)
+#include <pthread.h>
+#endif
+
+#ifdef X_PLATFORM_LINUX
+#include <sched.h>
+#endif
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+std::vector<std::size_t> XCpuTopology_::parseCpuList(std::string const & list) {
+    std::vector<std::size_t> ret{};
+    std::istringstream stream{list};
+    std::string range{};
+    while (std::getline(stream,range,',')) {
+        try {
+            if (auto const dash{range.find('-')}; std::string::npos == dash) {
+                ret.push_back(std::stoul(range));
+            } else {
+                auto const first{std::stoul(range.substr(0,dash))},last{std::stoul(range.substr(dash + 1))};
+                for (auto cpu{first}; cpu <= last; ++cpu) { ret.push_back(cpu); }
+            }
+        } catch (...) {}
+    }
+    return ret;
+}
+
+std::vector<std::vector<std::size_t>> XCpuTopology_::numaNodes() {
+    std::vector<std::vector<std::size_t>> ret{};
+#ifdef X_PLATFORM_LINUX
+    for (std::size_t node{};; ++node) {
+        std::ifstream file{"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"};
+        if (!file) { break; }
+        std::string list{};
+        std::getline(file,list);
+        // 没有CPU的节点(只有内存)不参与分配
+        if (auto cpus{parseCpuList(list)}; !cpus.empty()) { ret.push_back(std::move(cpus)); }
+    }
+#endif
+    if (ret.empty()) {
+        auto & cpus{ret.emplace_back(std::max(std::thread::hardware_concurrency(),1u))};
+        std::iota(cpus.begin(),cpus.end(),std::size_t{});
+    }
+    return ret;
+}
+
+void XCpuTopology_::setCurrentThreadName(std::string const & name) noexcept {
+    if (name.empty()) { return; }
+#ifdef X_PLATFORM_LINUX
+    // 包括结尾的'\0'最长16字节
+    pthread_setname_np(pthread_self(),name.substr(0,15).c_str());
+#elif defined(X_PLATFORM_MACOS)
+    pthread_setname_np(name.substr(0,63).c_str());
+#endif
+}
+
+std::size_t XCpuTopology_::currentCpu() noexcept {
+#ifdef X_PLATFORM_LINUX
+    if (auto const cpu{sched_getcpu()}; cpu >= 0) { return static_cast<std::size_t>(cpu); }
+#endif
+    return SIZE_MAX;
+}
+
+bool XCpuTopology_::bindCurrentThread(std::span<std::size_t const> const cpus) noexcept {
+    if (cpus.empty()) { return {}; }
+#ifdef X_PLATFORM_LINUX
+    cpu_set_t set{};
+    CPU_ZERO(&set);
+    for (auto const cpu : cpus) {
+        if (cpu < CPU_SETSIZE) { CPU_SET(cpu,&set); }
+    }
+    return !pthread_setaffinity_np(pthread_self(),sizeof(set),&set);
+#else
+    return {};
+#endif
+}
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
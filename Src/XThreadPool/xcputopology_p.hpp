@@ -0,0 +1,41 @@
+#ifndef XUTILS2_X_CPU_TOPOLOGY_P_HPP
+#define XUTILS2_X_CPU_TOPOLOGY_P_HPP 1
+
+#include <XHelper/xversion.hpp>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 线程放置相关的平台接口
+ * Linux下从/sys/devices/system/node读取NUMA节点,其他平台视为单节点
+ */
+class XCpuTopology_ final {
+public:
+    XCpuTopology_() = delete;
+
+    /// @return 每个NUMA节点的CPU编号,无法获取时返回包含全部CPU的单个节点
+    [[nodiscard]] static std::vector<std::vector<std::size_t>> numaNodes();
+
+    /// 解析"0-3,8-11"格式的CPU列表
+    [[nodiscard]] static std::vector<std::size_t> parseCpuList(std::string const & list);
+
+    /// 设置当前线程名称,超出平台长度限制时截断,不支持的平台忽略
+    static void setCurrentThreadName(std::string const & name) noexcept;
+
+    /// @return 当前线程所在的CPU编号,不支持的平台返回SIZE_MAX
+    [[nodiscard]] static std::size_t currentCpu() noexcept;
+
+    /// 把当前线程绑定到cpus
+    /// @return 成功返回true,不支持的平台返回false
+    static bool bindCurrentThread(std::span<std::size_t const> cpus) noexcept;
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
@@ -0,0 +1,70 @@
+#include "xframeallocator_p.hpp"
+#include <new>
+#include <utility>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+XFrameAllocator_::~XFrameAllocator_() {
+    for (auto & sizeClass : m_classes_) {
+        auto block{sizeClass.m_head};
+        while (block) { ::operator delete(std::exchange(block,block->m_next)); }
+    }
+}
+
+void XFrameAllocator_::release() noexcept {
+    if (1 == m_refs_.fetch_sub(1,std::memory_order_acq_rel)) { delete this; }
+}
+
+void * XFrameAllocator_::allocate(std::size_t const size) {
+
+    auto const total{size + sizeof(Header_)};
+    std::size_t index{};
+    while (index < ClassesSize_ && total > std::size_t{1} << (MinShift_ + index)) { ++index; }
+    if (ClassesSize_ == index) { return allocateDefault(size); }
+
+    void * block{};
+    {
+        auto & sizeClass{m_classes_[index]};
+        std::unique_lock lock(sizeClass.m_mtx);
+        if (auto const head{sizeClass.m_head}) {
+            sizeClass.m_head = head->m_next;
+            block = head;
+        }
+    }
+    if (!block) { block = ::operator new(std::size_t{1} << (MinShift_ + index)); }
+
+    m_refs_.fetch_add(1,std::memory_order_relaxed);
+    auto const header{::new (block) Header_{this,index}};
+    return header + 1;
+}
+
+void * XFrameAllocator_::allocateDefault(std::size_t const size) {
+    auto const header{::new (::operator new(size + sizeof(Header_))) Header_{}};
+    return header + 1;
+}
+
+void XFrameAllocator_::deallocate(void * const frame) noexcept {
+
+    if (!frame) { return; }
+
+    auto const header{static_cast<Header_ *>(frame) - 1};
+    auto const allocator{header->m_allocator};
+
+    if (!allocator) {
+        ::operator delete(header);
+        return;
+    }
+
+    auto & sizeClass{allocator->m_classes_[header->m_class]};
+    auto const block{::new (static_cast<void *>(header)) FreeBlock_{}};
+    {
+        std::unique_lock lock(sizeClass.m_mtx);
+        block->m_next = sizeClass.m_head;
+        sizeClass.m_head = block;
+    }
+    allocator->release();
+}
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
@@ -0,0 +1,61 @@
+#ifndef XUTILS2_X_FRAME_ALLOCATOR_P_HPP
+#define XUTILS2_X_FRAME_ALLOCATOR_P_HPP 1
+
+#include <XHelper/xversion.hpp>
+#include <XGlobal/xclasshelpermacros.hpp>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 线程池持有的协程帧分配器
+ * 按2的幂分级缓存释放的帧,超过最大级别的帧直接使用::operator new
+ * 每个存活的帧持有一个引用,线程池析构后分配器在最后一个帧释放时销毁
+ */
+class XFrameAllocator_ final {
+    static constexpr std::size_t MinShift_ {6},MaxShift_ {12}
+        ,ClassesSize_ {MaxShift_ - MinShift_ + 1};
+
+    struct FreeBlock_ final { FreeBlock_ * m_next{}; };
+
+    struct alignas(64) SizeClass_ final {
+        std::mutex m_mtx{};
+        FreeBlock_ * m_head{};
+    };
+
+    std::array<SizeClass_,ClassesSize_> m_classes_{};
+    std::atomic<std::size_t> m_refs_{1};
+
+    ~XFrameAllocator_();
+
+public:
+    /// 帧前部保存的信息,按max_align_t对齐,不影响协程帧本身的对齐
+    struct alignas(alignof(std::max_align_t)) Header_ final {
+        XFrameAllocator_ * m_allocator{};
+        std::size_t m_class{};
+    };
+
+    X_DISABLE_COPY_MOVE(XFrameAllocator_)
+
+    XFrameAllocator_() = default;
+
+    /// 由线程池调用,放弃所有权
+    void release() noexcept;
+
+    /// @return 帧地址,失败抛出std::bad_alloc
+    [[nodiscard]] void * allocate(std::size_t size);
+
+    /// 没有分配器时退化为::operator new
+    [[nodiscard]] static void * allocateDefault(std::size_t size);
+
+    static void deallocate(void * frame) noexcept;
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
@@ -0,0 +1,142 @@
+#include <XThreadPool/xfuture.hpp>
+#include <thread>
+#include <algorithm>
+#include <utility>
+
+#ifdef X_PLATFORM_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+#ifdef X_PLATFORM_LINUX
+
+static void futexWait(std::atomic<xuint32> & addr,xuint32 const expected
+    ,timespec const * const rel_time = {}) noexcept
+{
+    static_assert(sizeof(std::atomic<xuint32>) == sizeof(xuint32));
+    syscall(SYS_futex,reinterpret_cast<xuint32 *>(std::addressof(addr))
+        ,FUTEX_WAIT_PRIVATE,expected,rel_time,nullptr,0);
+}
+
+static void futexWakeAll(std::atomic<xuint32> & addr) noexcept {
+    syscall(SYS_futex,reinterpret_cast<xuint32 *>(std::addressof(addr))
+        ,FUTEX_WAKE_PRIVATE,INT32_MAX,nullptr,nullptr,0);
+}
+
+#endif
+
+namespace {
+    /// 回调链表的关闭标记,只比较地址,不会执行
+    class XClosedContinuation_ final : public XContinuation_ {
+    public:
+        void invoke() noexcept override {}
+    };
+    XClosedContinuation_ sm_closed_{};
+}
+
+static XContinuation_ * closedContinuation() noexcept
+{ return std::addressof(sm_closed_); }
+
+XReadyFlag_::~XReadyFlag_() {
+    auto node{m_continuations_.load(std::memory_order_acquire)};
+    while (node && closedContinuation() != node)
+    { delete std::exchange(node,node->m_next); }
+}
+
+void XReadyFlag_::set(xuint32 const state) noexcept {
+    if (m_state_.exchange(state,std::memory_order_acq_rel) & Waiters_) {
+#ifdef X_PLATFORM_LINUX
+        futexWakeAll(m_state_);
+#else
+        m_state_.notify_all();
+#endif
+    }
+    runContinuations_();
+}
+
+void XReadyFlag_::reset() noexcept {
+    m_state_.store(Pending_,std::memory_order_release);
+    auto closed{closedContinuation()};
+    m_continuations_.compare_exchange_strong(closed,nullptr,std::memory_order_acq_rel);
+}
+
+void XReadyFlag_::runContinuations_() noexcept {
+    auto node{m_continuations_.exchange(closedContinuation(),std::memory_order_acq_rel)};
+    if (closedContinuation() == node) { return; }
+    // 链表是后进先出的,反转后按注册顺序执行
+    XContinuation_ * ordered{};
+    while (node) {
+        auto const next{node->m_next};
+        node->m_next = ordered;
+        ordered = node;
+        node = next;
+    }
+    while (ordered) {
+        std::unique_ptr<XContinuation_> const current{std::exchange(ordered,ordered->m_next)};
+        current->invoke();
+    }
+}
+
+bool XReadyFlag_::push_(std::unique_ptr<XContinuation_> & continuation) const noexcept {
+    auto head{m_continuations_.load(std::memory_order_acquire)};
+    while (closedContinuation() != head) {
+        continuation->m_next = head;
+        if (m_continuations_.compare_exchange_weak(head,continuation.get()
+            ,std::memory_order_acq_rel,std::memory_order_acquire))
+        { static_cast<void>(continuation.release()); return true; }
+    }
+    return {};
+}
+
+void XReadyFlag_::onReady(std::unique_ptr<XContinuation_> continuation) const noexcept
+{ if (continuation && !push_(continuation)) { continuation->invoke(); } }
+
+void XReadyFlag_::wait() const noexcept {
+    auto v{m_state_.load(std::memory_order_acquire)};
+    while (!(v & StateMask_)) {
+        if (!(v & Waiters_) && !m_state_.compare_exchange_weak(v,v | Waiters_
+            ,std::memory_order_acquire,std::memory_order_acquire))
+        { continue; }
+#ifdef X_PLATFORM_LINUX
+        futexWait(m_state_,v | Waiters_);
+#else
+        m_state_.wait(v | Waiters_,std::memory_order_acquire);
+#endif
+        v = m_state_.load(std::memory_order_acquire);
+    }
+}
+
+bool XReadyFlag_::waitUntil_(std::chrono::steady_clock::time_point const & abs_time) const noexcept {
+    using namespace std::chrono;
+    auto v{m_state_.load(std::memory_order_acquire)};
+#ifndef X_PLATFORM_LINUX
+    // std::atomic没有带超时的wait,退化为指数退避轮询
+    auto backoff{microseconds{1}};
+#endif
+    while (!(v & StateMask_)) {
+        auto const now{steady_clock::now()};
+        if (now >= abs_time) { return {}; }
+#ifdef X_PLATFORM_LINUX
+        if (!(v & Waiters_) && !m_state_.compare_exchange_weak(v,v | Waiters_
+            ,std::memory_order_acquire,std::memory_order_acquire))
+        { continue; }
+        auto const rel{duration_cast<nanoseconds>(abs_time - now)};
+        timespec const ts{static_cast<std::time_t>(rel.count() / 1000000000)
+            ,static_cast<long>(rel.count() % 1000000000)};
+        futexWait(m_state_,v | Waiters_,std::addressof(ts));
+#else
+        std::this_thread::sleep_for(std::min<steady_clock::duration>(backoff,abs_time - now));
+        backoff = std::min(backoff * 2,duration_cast<microseconds>(milliseconds{1}));
+#endif
+        v = m_state_.load(std::memory_order_acquire);
+    }
+    return true;
+}
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
@@ -0,0 +1,273 @@
+#ifndef XUTILS2_X_FUTURE_HPP
+#define XUTILS2_X_FUTURE_HPP 1
+
+#include <XHelper/xhelper.hpp>
+#include <XGlobal/xtypes.hpp>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+class XThreadPool;
+
+/**
+ * 就绪后执行的回调节点,由XReadyFlag_持有并在执行后释放
+ */
+class X_CLASS_EXPORT XContinuation_ {
+public:
+    XContinuation_ * m_next{};
+    X_DISABLE_COPY_MOVE(XContinuation_)
+    constexpr XContinuation_() = default;
+    virtual ~XContinuation_() = default;
+    virtual void invoke() noexcept = 0;
+};
+
+/**
+ * 结果就绪标志
+ * 低两位保存状态,有线程等待时设置Waiters_位,设置状态时只有存在等待者才进行唤醒
+ * Linux下直接使用futex,其他平台使用std::atomic的wait/notify
+ * 就绪时在设置状态的线程执行通过onReady注册的回调,回调不经过等待者,也不会唤醒等待者
+ */
+class X_CLASS_EXPORT XReadyFlag_ final {
+    mutable std::atomic<xuint32> m_state_{};
+    /// 回调链表,就绪后替换为关闭标记,之后注册的回调立即执行
+    mutable std::atomic<XContinuation_ *> m_continuations_{};
+
+    template<typename Fn_>
+    class XContinuationImpl_ final : public XContinuation_ {
+        Fn_ m_fn_;
+    public:
+        explicit XContinuationImpl_(Fn_ && fn) : m_fn_{std::move(fn)} {}
+        void invoke() noexcept override { m_fn_(); }
+    };
+
+    [[nodiscard]] bool waitUntil_(std::chrono::steady_clock::time_point const & abs_time) const noexcept;
+
+    void runContinuations_() noexcept;
+
+    /// @return 是否已加入回调链表,已经就绪时不加入,continuation保持不变
+    [[nodiscard]] bool push_(std::unique_ptr<XContinuation_> & continuation) const noexcept;
+
+public:
+    enum : xuint32 { Pending_,Value_,Error_,StateMask_ = 3,Waiters_ = 4 };
+
+    X_DISABLE_COPY_MOVE(XReadyFlag_)
+
+    constexpr XReadyFlag_() = default;
+    /// 从未就绪时,未执行的回调直接释放
+    ~XReadyFlag_();
+
+    /// 注册就绪回调,已经就绪时在当前线程立即执行
+    void onReady(std::unique_ptr<XContinuation_> continuation) const noexcept;
+
+    /// fn必须是noexcept的无参可调用对象
+    template<typename Fn_>
+    void onReady(Fn_ && fn) const {
+        using impl_t = XContinuationImpl_<std::decay_t<Fn_>>;
+        onReady(std::unique_ptr<XContinuation_>{std::make_unique<impl_t>(std::decay_t<Fn_>(std::forward<Fn_>(fn)))});
+    }
+
+    /// 只在未就绪时注册就绪回调,已经就绪时直接释放回调而不执行,由调用者继续处理
+    /// 供协程的await_suspend使用,避免在await_suspend内嵌套恢复协程
+    /// @return 是否已注册
+    [[nodiscard]] bool tryOnReady(std::unique_ptr<XContinuation_> continuation) const noexcept
+    { return continuation && push_(continuation); }
+
+    /// fn必须是noexcept的无参可调用对象
+    template<typename Fn_>
+    [[nodiscard]] bool tryOnReady(Fn_ && fn) const {
+        using impl_t = XContinuationImpl_<std::decay_t<Fn_>>;
+        return tryOnReady(std::unique_ptr<XContinuation_>{std::make_unique<impl_t>(std::decay_t<Fn_>(std::forward<Fn_>(fn)))});
+    }
+
+    [[nodiscard]] xuint32 state() const noexcept
+    { return m_state_.load(std::memory_order_acquire) & StateMask_; }
+
+    [[nodiscard]] bool isReady() const noexcept
+    { return Pending_ != state(); }
+
+    /// 设置最终状态并唤醒所有等待者
+    void set(xuint32 state) noexcept;
+
+    /// 复位为未就绪,调用前需保证没有等待者,已执行过回调的标志可以重新注册回调
+    void reset() noexcept;
+
+    void wait() const noexcept;
+
+    /// @return 超时前就绪返回true
+    template<typename Rep_,typename Period_>
+    [[nodiscard]] bool waitFor(std::chrono::duration<Rep_,Period_> const & rel_time) const noexcept
+    { return waitUntil_(std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(rel_time)); }
+
+    /// @return 超时前就绪返回true
+    template<typename Clock_,typename Duration_>
+    [[nodiscard]] bool waitUntil(std::chrono::time_point<Clock_,Duration_> const & abs_time) const noexcept {
+        if constexpr (std::is_same_v<Clock_,std::chrono::steady_clock>) { return waitUntil_(abs_time); }
+        else { return waitFor(abs_time - Clock_::now()); }
+    }
+};
+
+template<typename T>
+class XFutureState_ final {
+    static_assert(!std::is_reference_v<T>,"XFutureState_ does not store references");
+
+    struct Empty_ {};
+    using storage_t = std::conditional_t<std::is_void_v<T>,Empty_,T>;
+
+    XReadyFlag_ m_flag_{};
+    std::exception_ptr m_error_{};
+    alignas(storage_t) std::byte m_storage_[sizeof(storage_t)]{};
+
+    void destroy_() noexcept {
+        if constexpr (!std::is_void_v<T>) {
+            if (XReadyFlag_::Value_ == m_flag_.state())
+            { std::launder(reinterpret_cast<T *>(m_storage_))->~T(); }
+        }
+        m_error_ = {};
+    }
+
+public:
+    X_DISABLE_COPY_MOVE(XFutureState_)
+
+    constexpr XFutureState_() = default;
+    ~XFutureState_() { destroy_(); }
+
+    [[nodiscard]] XReadyFlag_ const & flag() const noexcept
+    { return m_flag_; }
+
+    template<typename... Args>
+    void setValue(Args && ...args) {
+        if constexpr (!std::is_void_v<T>) { ::new (m_storage_) T(std::forward<Args>(args)...); }
+        m_flag_.set(XReadyFlag_::Value_);
+    }
+
+    void setException(std::exception_ptr e) noexcept {
+        m_error_ = std::move(e);
+        m_flag_.set(XReadyFlag_::Error_);
+    }
+
+    /// 复用状态,调用前需保证没有线程在等待或读取
+    void reset() noexcept {
+        destroy_();
+        m_flag_.reset();
+    }
+
+    /// 等待就绪,有异常时重新抛出
+    [[nodiscard]] std::add_lvalue_reference_t<storage_t const> value() const noexcept(false) {
+        m_flag_.wait();
+        if (m_error_) { std::rethrow_exception(m_error_); }
+        return *std::launder(reinterpret_cast<storage_t const *>(m_storage_));
+    }
+};
+
+/**
+ * 类型化的结果,共享状态按T的大小一次分配,不经过std::any
+ * 与std::shared_future相同,可以复制,get可以多次调用
+ * @tparam T 返回值类型
+ */
+template<typename T>
+class XFuture final {
+    std::shared_ptr<XFutureState_<T>> m_state_{};
+
+    friend class XThreadPool;
+    [[nodiscard]] XReadyFlag_ const * flag_() const noexcept
+    { return m_state_ ? std::addressof(m_state_->flag()) : nullptr; }
+
+public:
+    constexpr XFuture() = default;
+    explicit XFuture(std::shared_ptr<XFutureState_<T>> state) noexcept
+        : m_state_{std::move(state)} {}
+
+    /// @return 是否关联了共享状态
+    [[nodiscard]] bool valid() const noexcept
+    { return static_cast<bool>(m_state_); }
+
+    /// @return 是否已经就绪(包括异常)
+    [[nodiscard]] bool isReady() const noexcept
+    { return m_state_ && m_state_->flag().isReady(); }
+
+    /// @return 是否已经就绪且有返回值
+    [[nodiscard]] bool hasValue() const noexcept
+    { return m_state_ && XReadyFlag_::Value_ == m_state_->flag().state(); }
+
+    void wait() const noexcept
+    { if (m_state_) { m_state_->flag().wait(); } }
+
+    /// 就绪后在设置结果的线程执行fn,已经就绪时在当前线程立即执行
+    /// fn必须是noexcept的无参可调用对象
+    template<typename Fn>
+    void onReady(Fn && fn) const
+    { if (m_state_) { m_state_->flag().onReady(std::forward<Fn>(fn)); } }
+
+    /// 只在未就绪时注册fn,已经就绪或没有关联状态时不执行fn
+    /// @return 是否已注册
+    template<typename Fn>
+    [[nodiscard]] bool tryOnReady(Fn && fn) const
+    { return m_state_ && m_state_->flag().tryOnReady(std::forward<Fn>(fn)); }
+
+    template<typename Rep_,typename Period_>
+    [[nodiscard]] bool waitFor(std::chrono::duration<Rep_,Period_> const & rel_time) const noexcept
+    { return m_state_ && m_state_->flag().waitFor(rel_time); }
+
+    template<typename Clock_,typename Duration_>
+    [[nodiscard]] bool waitUntil(std::chrono::time_point<Clock_,Duration_> const & abs_time) const noexcept
+    { return m_state_ && m_state_->flag().waitUntil(abs_time); }
+
+    /// 阻塞获取返回值,任务中抛出的异常会在此处重新抛出
+    /// 没有关联共享状态时抛出std::future_error
+    decltype(auto) get() const noexcept(false) {
+        if (!m_state_) { throw std::future_error(std::future_errc::no_state); }
+        if constexpr (std::is_void_v<T>) { static_cast<void>(m_state_->value()); }
+        else { return m_state_->value(); }
+    }
+};
+
+/**
+ * XFuture的写入端,析构时仍未设置结果则设置std::future_errc::broken_promise异常
+ * @tparam T 返回值类型
+ */
+template<typename T>
+class XPromise final {
+    std::shared_ptr<XFutureState_<T>> m_state_{};
+
+    void abandon_() noexcept {
+        if (m_state_ && !m_state_->flag().isReady())
+        { m_state_->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise))); }
+    }
+
+public:
+    XPromise() : m_state_{std::make_shared<XFutureState_<T>>()} {}
+
+    XPromise(XPromise && o) noexcept = default;
+
+    XPromise & operator=(XPromise && o) noexcept {
+        if (this != std::addressof(o)) { abandon_(); m_state_ = std::move(o.m_state_); }
+        return *this;
+    }
+
+    ~XPromise() { abandon_(); }
+
+    X_DISABLE_COPY(XPromise)
+
+    [[nodiscard]] XFuture<T> getFuture() const noexcept
+    { return XFuture<T>{m_state_}; }
+
+    template<typename... Args>
+    void setValue(Args && ...args)
+    { m_state_->setValue(std::forward<Args>(args)...); }
+
+    void setException(std::exception_ptr e) noexcept
+    { m_state_->setException(std::move(e)); }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
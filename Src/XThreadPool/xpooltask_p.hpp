@@ -0,0 +1,61 @@
+#ifndef XUTILS2_X_POOL_TASK_P_HPP
+#define XUTILS2_X_POOL_TASK_P_HPP 1
+
+#include <XHelper/xversion.hpp>
+#include <XGlobal/xtypes.hpp>
+#include <XThreadPool/xcancellation.hpp>
+#include <chrono>
+#include <atomic>
+#include <utility>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 线程池内部的任务节点,所有任务队列只保存该节点的裸指针
+ * 入队前由具体实现持有自身的所有权,execute或discard时释放
+ */
+class XPoolTask_ {
+public:
+    using time_point_t = std::chrono::steady_clock::time_point;
+
+    /// 优先级,对应XTaskOptions::Priority
+    xuint32 m_priority{1};
+    /// 进入共享队列时的序号,用于老化
+    xuint64 m_sequence{};
+    /// 截止时间,max表示不限
+    time_point_t m_deadline{time_point_t::max()};
+    /// CACHE模式下进入共享队列的时间,用于估计排队延迟
+    time_point_t m_enqueueTime{};
+    /// 提交线程的配额计数,开始执行或丢弃时归还,不限配额时为nullptr
+    std::atomic_size_t * m_quota{};
+    /// 取消令牌,已取消且尚未开始执行的任务不再执行
+    XCancellationToken m_token{};
+
+    /// 归还提交线程的配额
+    void releaseQuota() noexcept
+    { if (auto const quota{std::exchange(m_quota,nullptr)}) { quota->fetch_sub(1,std::memory_order_release); } }
+
+    /// 执行任务,并释放线程池持有的所有权
+    virtual void execute() noexcept = 0;
+
+    /// 不执行任务,直接释放线程池持有的所有权,同时唤醒等待结果的调用者
+    virtual void discard() noexcept = 0;
+
+    /// @return 截止时间已过
+    [[nodiscard]] bool expired() const noexcept
+    { return time_point_t::max() != m_deadline && std::chrono::steady_clock::now() > m_deadline; }
+
+    /// @return 令牌已被取消
+    [[nodiscard]] bool cancelled() const noexcept
+    { return m_token.isCancelled(); }
+
+protected:
+    constexpr XPoolTask_() = default;
+    virtual ~XPoolTask_() = default;
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
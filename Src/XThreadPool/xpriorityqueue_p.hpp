@@ -0,0 +1,92 @@
+#ifndef XUTILS2_X_PRIORITY_QUEUE_P_HPP
+#define XUTILS2_X_PRIORITY_QUEUE_P_HPP 1
+
+#include "xpooltask_p.hpp"
+#include <array>
+#include <deque>
+#include <cstddef>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 线程池的共享任务队列,每个优先级一个FIFO队列,不是线程安全的,由线程池的m_mtx保护
+ * 出队时比较各级队首的(序号 - 优先级 * AgingStep),取最小者
+ * 低优先级任务每被后来的任务越过AgingStep次,相当于提升一级,因此不会被饿死
+ */
+class XPriorityQueue_ final {
+public:
+    static constexpr std::size_t LevelsSize{4};
+    static constexpr xuint64 AgingStep{64};
+
+private:
+    std::array<std::deque<XPoolTask_ *>,LevelsSize> m_levels_{};
+    std::size_t m_size_{},m_urgentSize_{};
+    xuint64 m_sequence_{LevelsSize * AgingStep};
+
+public:
+    [[nodiscard]] std::size_t size() const noexcept { return m_size_; }
+
+    [[nodiscard]] bool empty() const noexcept { return !m_size_; }
+
+    /// @return 高于默认优先级的任务数
+    [[nodiscard]] std::size_t urgentSize() const noexcept { return m_urgentSize_; }
+
+    /// @return 最早入队的任务,队列为空时返回nullptr
+    [[nodiscard]] XPoolTask_ const * oldest() const noexcept {
+        XPoolTask_ const * ret{};
+        for (auto const & queue : m_levels_) {
+            if (!queue.empty() && (!ret || queue.front()->m_sequence < ret->m_sequence)) { ret = queue.front(); }
+        }
+        return ret;
+    }
+
+    void push(XPoolTask_ * const task) {
+        auto const level{task->m_priority < LevelsSize ? task->m_priority : LevelsSize - 1};
+        task->m_priority = static_cast<xuint32>(level);
+        task->m_sequence = m_sequence_++;
+        m_levels_[level].push_back(task);
+        ++m_size_;
+        if (level > 1) { ++m_urgentSize_; }
+    }
+
+    /// 取出最早入队的任务,不考虑优先级,用于DROP_OLDEST
+    /// @return 队列为空时返回nullptr
+    XPoolTask_ * popOldest() noexcept {
+        std::deque<XPoolTask_ *> * oldest{};
+        for (auto & queue : m_levels_) {
+            if (!queue.empty() && (!oldest || queue.front()->m_sequence < oldest->front()->m_sequence))
+            { oldest = std::addressof(queue); }
+        }
+        if (!oldest) { return {}; }
+        auto const task{oldest->front()};
+        oldest->pop_front();
+        --m_size_;
+        if (task->m_priority > 1) { --m_urgentSize_; }
+        return task;
+    }
+
+    /// @return 队列为空时返回nullptr
+    XPoolTask_ * pop() noexcept {
+        if (!m_size_) { return {}; }
+        std::deque<XPoolTask_ *> * best{};
+        xuint64 bestScore{};
+        for (std::size_t level{}; level < LevelsSize; ++level) {
+            auto & queue{m_levels_[level]};
+            if (queue.empty()) { continue; }
+            // m_sequence_从LevelsSize * AgingStep开始计数,不会下溢
+            if (auto const score{queue.front()->m_sequence - level * AgingStep}; !best || score <= bestScore)
+            { best = std::addressof(queue); bestScore = score; }
+        }
+        auto const task{best->front()};
+        best->pop_front();
+        --m_size_;
+        if (task->m_priority > 1) { --m_urgentSize_; }
+        return task;
+    }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
@@ -13,7 +13,7 @@ XTD_INLINE_NAMESPACE_BEGIN(v1)
 #endif
 
 std::any XResultPrivate::get_value() const
-{ return m_result_.get_future().get(); }
+{ return std::move(m_result_); }
 
 XResult::XResult():
 m_d_ptr_{std::make_unique<XResultPrivate>()}
@@ -21,18 +21,22 @@ m_d_ptr_{std::make_unique<XResultPrivate>()}
 
 void XResult::set(std::any && v) const noexcept {
     X_D(const XResult);
-    d->m_result_ = {};
-    d->m_result_.set_value(std::move(v));
-    d->m_bin_sem_.release();
+    d->m_result_ = std::move(v);
+    d->m_ready_.set(XReadyFlag_::Value_);
 }
 
-void XResult::reset() const noexcept
-{ d_func()->m_recall_.storeRelease({}); }
+void XResult::reset() const noexcept {
+    X_D(const XResult);
+    d->m_recall_.storeRelease({});
+    d->m_ready_.reset();
+}
 
 void XResult::allow_get() const noexcept
 { d_func()->m_allow_get_.storeRelease(true); }
 
-std::any XResult::get_() const noexcept {
+bool XResult::checkGet_() const noexcept {
+
+    X_D(const XResult);
 
 #ifndef UNUSE_STD_THREAD_LOCAL
     if (this == sm_isSelf) {
@@ -43,8 +47,6 @@ std::any XResult::get_() const noexcept {
         return {};
     }
 
-    X_D(const XResult);
-
     if (d->m_recall_.loadAcquire()){
         std::cerr << FUNC_SIGNATURE << " tips: Repeated calls\n" << std::flush;
         return {};
@@ -56,20 +58,25 @@ std::any XResult::get_() const noexcept {
         return {};
     }
     d->m_allow_get_.storeRelease({});
+    return true;
+}
 
-    d->m_bin_sem_.acquire();
+std::any XResult::get_() const noexcept {
+    if (!checkGet_()) { return {}; }
+    X_D(const XResult);
+    d->m_ready_.wait();
     return d->get_value();
 }
 
 std::any XResult::try_get_() const noexcept {
     X_D(const XResult);
-    if (!d->m_bin_sem_.try_acquire()) { return {}; }
+    if (!d->m_ready_.isReady()) { return {}; }
     return d->get_value();
 }
 
 std::any XResult::get_for_(std::chrono::nanoseconds const &del_time) const noexcept {
     X_D(const XResult);
-    if (d->m_bin_sem_.try_acquire_for(del_time)){ return {}; }
+    if (!d->m_ready_.waitFor(del_time)){ return {}; }
     return d->get_value();
 }
 
@@ -2,14 +2,9 @@
 #define X_RESULT_HPP 1
 
 #include <XHelper/xhelper.hpp>
-#include <future>
+#include <XThreadPool/xfuture.hpp>
 #include <any>
 #include <memory>
-#if __cplusplus >= 202002L
-#include <semaphore>
-#else
-#include <XThreadPool/xsemaphore.hpp>
-#endif
 
 XTD_NAMESPACE_BEGIN
 XTD_INLINE_NAMESPACE_BEGIN(v1)
@@ -23,13 +18,9 @@ class X_CLASS_EXPORT XResultData {
 
 public:
     XResult * m_x_ptr{};
-    mutable
-#if __cplusplus >= 202002L
-    std::binary_semaphore
-#else
-    XBinary_Semaphore
-#endif
-    m_bin_sem_{0};
+    /// 替代原来的std::promise<std::any>与binary_semaphore,设置结果不再分配共享状态
+    mutable XReadyFlag_ m_ready_{};
+    /// 取值时移出,与原来信号量的"取一次"语义一致
     virtual std::any get_value() const = 0;
 
 protected:
@@ -62,7 +53,7 @@ public:
 
     template<typename Ty,typename Clock_,typename Duration_>
     constexpr Ty get_until(std::chrono::time_point<Clock_,Duration_> const & abs_time_) const noexcept(false) {
-        if (!m_d_ptr_->m_bin_sem_.try_acquire_until(abs_time_)) { return Ty{}; }
+        if (!m_d_ptr_->m_ready_.waitUntil(abs_time_)) { return Ty{}; }
         RETURN_VALUE(m_d_ptr_->get_value());
     }
 #undef RETURN_VALUE
@@ -77,11 +68,17 @@ public:
     ~XResult() = default;
 
 private:
+    /// get前的检查: 工作线程调用、重复调用、未加入线程池
+    [[nodiscard]] bool checkGet_() const noexcept;
+    [[nodiscard]] XReadyFlag_ const & ready_() const noexcept
+    { return m_d_ptr_->m_ready_; }
     std::any get_() const noexcept;
     std::any try_get_() const noexcept;
     std::any get_for_(std::chrono::nanoseconds const &) const noexcept;
     void set(std::any&& ) const noexcept;
     friend class XResultStorage;
+    friend class XAbstractRunnable;
+    friend class XAbstractRunnablePrivate;
 };
 
 class XResultStorage final {
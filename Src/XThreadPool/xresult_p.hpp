@@ -12,7 +12,7 @@ class X_CLASS_EXPORT XResultPrivate final : public XResultData {
 public:
     X_DECLARE_PUBLIC(XResult)
 
-    mutable std::promise<std::any> m_result_{};
+    mutable std::any m_result_{};
     mutable XAtomicBool m_recall_{},m_allow_get_{};
 #ifdef UNUSE_STD_THREAD_LOCAL
     mutable XThreadLocalConstVoid m_isSelf{};
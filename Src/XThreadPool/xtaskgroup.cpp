@@ -0,0 +1,134 @@
+#include "xtaskgroup.hpp"
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 任务组的共享状态
+ * 执行者可能在组析构后才被调度,因此由shared_ptr持有,此时队列已空,迟到的执行者直接返回
+ */
+class XTaskGroupState_ final {
+public:
+    X_DISABLE_COPY_MOVE(XTaskGroupState_)
+
+    XCancellationSource m_source;
+    XCancellationToken const m_token{m_source.token()};
+    static constexpr xuint64 Epoch_{xuint64{1} << 32},PendingMask_{Epoch_ - 1};
+    /// 低32位为已加入但尚未执行完毕或丢弃的任务数,高32位在有等待者时随任务入队递增
+    /// 等待线程只等待这一个原子量
+    std::atomic<xuint64> m_state{};
+    /// 正在等待m_state的线程数,状态变化时只有存在等待者才唤醒
+    std::atomic_size_t m_waiters{};
+    std::atomic_bool m_failed{};
+    /// 只由第一个失败的任务写入,m_state的release/acquire保证等待线程可见
+    std::exception_ptr m_error{};
+
+    std::mutex m_mtx{};
+    /// 由m_mtx保护的先进先出链表
+    XGroupTask_ * m_head{},* m_tail{};
+
+    explicit XTaskGroupState_(XCancellationToken const & parent) : m_source{parent} {}
+
+    ~XTaskGroupState_() {
+        for (auto task{m_head}; task;) { delete std::exchange(task,task->m_next); }
+    }
+
+    [[nodiscard]] std::unique_ptr<XGroupTask_> pop() noexcept {
+        std::unique_lock lock(m_mtx);
+        auto const task{m_head};
+        if (task && !(m_head = task->m_next)) { m_tail = {}; }
+        return std::unique_ptr<XGroupTask_>{task};
+    }
+
+    /// 加入任务,计数先于入队增加,保证执行中的任务加入子任务时计数不会提前归零
+    void push(std::unique_ptr<XGroupTask_> task) noexcept {
+        m_state.fetch_add(1);
+        {
+            std::unique_lock lock(m_mtx);
+            auto const p{task.release()};
+            (m_tail ? m_tail->m_next : m_head) = p;
+            m_tail = p;
+        }
+        // 计数未变,需改变状态才能唤醒已在等待的线程去执行新任务
+        if (m_waiters.load()) {
+            m_state.fetch_add(Epoch_);
+            m_state.notify_all();
+        }
+    }
+
+    /// 执行或丢弃(组已取消)一个排队的任务
+    /// @return 队列为空时返回false
+    bool runOne() noexcept {
+        auto task{pop()};
+        if (!task) { return {}; }
+        if (!m_token.isCancelled()) {
+            auto const previous{XCancellationToken::exchangeCurrent_(std::addressof(m_token))};
+            try { task->invoke(); }
+            catch (...) {
+                if (!m_failed.exchange(true)) { m_error = std::current_exception(); }
+                m_source.cancel();
+            }
+            XCancellationToken::exchangeCurrent_(previous);
+        }
+        task.reset();
+        m_state.fetch_sub(1);
+        if (m_waiters.load()) { m_state.notify_all(); }
+        return true;
+    }
+
+    [[nodiscard]] bool queued() noexcept {
+        std::unique_lock lock(m_mtx);
+        return m_head;
+    }
+
+    /// 帮助执行直到全部任务结束
+    void join() noexcept {
+        while (true) {
+            if (runOne()) { continue; }
+            // 先登记等待者再读取状态、检查队列,与push/runOne中先修改状态再检查等待者构成Dekker式同步
+            m_waiters.fetch_add(1);
+            auto const state{m_state.load()};
+            auto const pending{state & PendingMask_};
+            if (pending && !queued()) { m_state.wait(state); }
+            m_waiters.fetch_sub(1);
+            if (!pending) { return; }
+        }
+    }
+};
+
+XTaskGroup::XTaskGroup(XThreadPool & pool,XCancellationToken const & parent)
+    : m_pool_{pool},m_state_{std::make_shared<XTaskGroupState_>(parent)} {}
+
+XTaskGroup::~XTaskGroup()
+{ m_state_->join(); }
+
+bool XTaskGroup::submit_(std::unique_ptr<XGroupTask_> task) {
+    auto const & state{m_state_};
+    if (state->m_token.isCancelled()) { return {}; }
+    state->push(std::move(task));
+    // 执行者不带令牌,组取消后由执行者丢弃排队的任务并减少计数
+    static_cast<void>(m_pool_.runnableJoinDetached([state]{ static_cast<void>(state->runOne()); }));
+    return true;
+}
+
+void XTaskGroup::wait() {
+    m_state_->join();
+    if (m_state_->m_failed.load(std::memory_order_acquire)) {
+        if (auto error{std::exchange(m_state_->m_error,{})}) { std::rethrow_exception(error); }
+    }
+}
+
+void XTaskGroup::cancel() noexcept
+{ m_state_->m_source.cancel(); }
+
+bool XTaskGroup::isCancelled() const noexcept
+{ return m_state_->m_token.isCancelled(); }
+
+XCancellationToken XTaskGroup::token() const noexcept
+{ return m_state_->m_token; }
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
@@ -0,0 +1,84 @@
+#ifndef XUTILS2_X_TASK_GROUP_HPP
+#define XUTILS2_X_TASK_GROUP_HPP 1
+
+#include <XThreadPool/xthreadpool.hpp>
+#include <XThreadPool/xcancellation.hpp>
+#include <functional>
+#include <memory>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+class XTaskGroupState_;
+
+/**
+ * 任务组中等待执行的任务节点,由组的队列持有并在执行或丢弃后释放
+ */
+class X_CLASS_EXPORT XGroupTask_ {
+public:
+    XGroupTask_ * m_next{};
+    X_DISABLE_COPY_MOVE(XGroupTask_)
+    constexpr XGroupTask_() = default;
+    virtual ~XGroupTask_() = default;
+    virtual void invoke() = 0;
+};
+
+/**
+ * 结构化并发的任务组
+ * 任务先进入组自己的队列,再向线程池提交一个只从该队列取任务的执行者,
+ * 等待线程不休眠而是从同一队列取任务执行,只有队列为空且仍有任务在执行时才等待,
+ * 因此线程池很小或在工作线程内嵌套等待也不会死锁
+ * 完成情况只由一个原子计数跟踪,所有任务共用同一个等待点
+ * 第一个抛出的异常被保存并取消整个组,由wait重新抛出
+ * 组的令牌默认以构造时当前任务的令牌为父令牌,任务执行期间XCancellationToken::current()为组的令牌,
+ * 因此嵌套的组随外层一起取消
+ * 析构时等待全部任务结束,不抛出异常
+ */
+class X_CLASS_EXPORT XTaskGroup final {
+    template<typename Fn_>
+    class XGroupTaskImpl_ final : public XGroupTask_ {
+        Fn_ m_fn_;
+    public:
+        template<typename F_>
+        explicit XGroupTaskImpl_(F_ && fn) : m_fn_{std::forward<F_>(fn)} {}
+        void invoke() override { std::invoke(m_fn_); }
+    };
+
+    XThreadPool & m_pool_;
+    std::shared_ptr<XTaskGroupState_> m_state_{};
+
+    /// 任务进入组的队列并提交执行者
+    bool submit_(std::unique_ptr<XGroupTask_> task);
+
+public:
+    X_DISABLE_COPY_MOVE(XTaskGroup)
+
+    /// @param pool 执行任务的线程池,需比组的生命周期长
+    /// @param parent 父令牌,取消时组一并取消
+    explicit XTaskGroup(XThreadPool & pool,XCancellationToken const & parent = XCancellationToken::current());
+
+    ~XTaskGroup();
+
+    /// 加入任务,线程池拒绝执行者时任务仍在组的队列中,由wait的线程执行
+    /// @param fn 无参可调用对象
+    /// @return 组已取消时返回false,fn不会执行
+    template<typename Fn>
+    bool run(Fn && fn)
+    { return submit_(std::make_unique<XGroupTaskImpl_<std::decay_t<Fn>>>(std::forward<Fn>(fn))); }
+
+    /// 帮助执行组内排队的任务直到全部结束,有任务抛出异常时重新抛出第一个异常
+    /// 异常只抛出一次,组保持取消状态
+    void wait();
+
+    /// 取消组,排队中的任务不再执行,正在执行的任务可通过令牌检查
+    void cancel() noexcept;
+
+    [[nodiscard]] bool isCancelled() const noexcept;
+
+    [[nodiscard]] XCancellationToken token() const noexcept;
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef XUTILS2_X_TASK_RESULT_HPP
+#define XUTILS2_X_TASK_RESULT_HPP 1
+
+#include <XHelper/xhelper.hpp>
+#include <memory>
+#include <future>
+#include <utility>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+class XThreadPool;
+class XTaskSlot_;
+
+class X_CLASS_EXPORT XTaskResultBase_ {
+protected:
+    /// 任务槽的分配器由槽引用计数,结果不持有线程池,可以在线程池析构后或在任务中释放
+    XTaskSlot_ * m_slot_{};
+
+    constexpr XTaskResultBase_() = default;
+
+    XTaskResultBase_(XTaskResultBase_ && o) noexcept
+        : m_slot_{std::exchange(o.m_slot_,{})} {}
+
+    XTaskResultBase_ & operator=(XTaskResultBase_ && o) noexcept {
+        if (this != std::addressof(o)) {
+            release_();
+            m_slot_ = std::exchange(o.m_slot_,{});
+        }
+        return *this;
+    }
+
+    ~XTaskResultBase_() { release_(); }
+
+    [[nodiscard]] bool isReady_() const noexcept;
+
+    void wait_() const noexcept;
+
+    /// 等待任务结束,任务抛出异常或未被执行时抛出对应异常
+    /// @return 结果存储地址
+    [[nodiscard]] void * value_() const noexcept(false);
+
+    void release_() noexcept;
+
+public:
+    X_DISABLE_COPY(XTaskResultBase_)
+};
+
+/**
+ * runnableJoinTyped返回的类型化结果
+ * 结果直接存放在任务槽中,不经过std::any,获取结果不需要额外分配
+ * 与std::future相同,get只能调用一次
+ * @tparam R 任务返回值类型
+ */
+template<typename R>
+class XTaskResult final : XTaskResultBase_ {
+    friend class XThreadPool;
+    explicit XTaskResult(XTaskSlot_ * const slot) noexcept
+    { m_slot_ = slot; }
+
+public:
+    constexpr XTaskResult() = default;
+    XTaskResult(XTaskResult &&) noexcept = default;
+    XTaskResult & operator=(XTaskResult &&) noexcept = default;
+    ~XTaskResult() = default;
+
+    /// @return 是否关联了任务,get之后为false
+    [[nodiscard]] bool valid() const noexcept
+    { return m_slot_; }
+
+    /// @return 任务是否已经结束(包括抛出异常和未被执行)
+    [[nodiscard]] bool isReady() const noexcept
+    { return m_slot_ && isReady_(); }
+
+    /// 阻塞等待任务结束
+    void wait() const noexcept
+    { if (m_slot_) { wait_(); } }
+
+    /// 阻塞获取返回值,任务中抛出的异常会在此处重新抛出
+    /// 任务未被执行(队列已满或线程池析构)时抛出std::future_error
+    /// @return R类型
+    R get() noexcept(false) {
+        if (!m_slot_) { throw std::future_error(std::future_errc::no_state); }
+        struct Release_ final {
+            XTaskResult & m_self;
+            ~Release_() { m_self.release_(); }
+        } const release{*this};
+        [[maybe_unused]] auto const p{value_()};
+        if constexpr (!std::is_void_v<R>) { return std::move(*static_cast<R *>(p)); }
+    }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
@@ -0,0 +1,173 @@
+#include "xtaskslot_p.hpp"
+#include <XThreadPool/xtaskresult.hpp>
+#include <new>
+#include <future>
+#include <iostream>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+void * XTaskSlot_::bind(std::size_t const size,std::size_t const align,invoke_t const invoke
+    ,destroy_t const destroy,destroy_t const dropResult,bool const retain) noexcept
+{
+    if (size <= InlineSize_ && align <= alignof(std::max_align_t)) {
+        m_callable = m_storage;
+    } else {
+        m_callable = ::operator new(size,std::align_val_t{align},std::nothrow);
+        if (!m_callable) { return {}; }
+    }
+    m_align = static_cast<std::uint32_t>(align);
+    m_invoke = invoke;
+    m_destroy = destroy;
+    m_dropResult = dropResult;
+    m_priority = 1;
+    m_deadline = time_point_t::max();
+    m_state.store(Pending_,std::memory_order_relaxed);
+    m_refs.store(retain ? 2 : 1,std::memory_order_relaxed);
+    return m_callable;
+}
+
+void XTaskSlot_::execute() noexcept {
+    try {
+        m_invoke(m_callable);
+    } catch (...) {
+        // 有XTaskResult时异常交给调用者,否则与XAbstractRunnable一样只输出
+        if (m_refs.load(std::memory_order_acquire) > 1) {
+            m_error = std::current_exception();
+        } else {
+            try { throw; }
+            catch (std::exception const & e)
+            { std::cerr << FUNC_SIGNATURE << " exception msg : " << e.what() << "\n"; }
+            catch (...) {}
+        }
+        finish(Error_);
+        return;
+    }
+    finish(Value_);
+}
+
+void XTaskSlot_::discard() noexcept {
+    m_destroy(m_callable);
+    if (m_refs.load(std::memory_order_acquire) > 1)
+    { m_error = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)); }
+    finish(Error_);
+}
+
+void XTaskSlot_::finish(State_ const state) noexcept {
+    m_state.store(state,std::memory_order_release);
+    m_state.notify_all();
+    release();
+}
+
+void XTaskSlot_::release() noexcept {
+    if (1 == m_refs.fetch_sub(1,std::memory_order_acq_rel)) { recycle(); }
+}
+
+void XTaskSlot_::recycle() noexcept {
+    if (Value_ == m_state.load(std::memory_order_relaxed) && m_dropResult)
+    { m_dropResult(m_callable); }
+    if (m_callable != static_cast<void *>(m_storage))
+    { ::operator delete(m_callable,std::align_val_t{m_align}); }
+    m_callable = {};
+    m_invoke = {};
+    m_destroy = {};
+    m_dropResult = {};
+    m_error = {};
+    m_token = {};
+    if (m_slab) { m_slab->release(this); } else { delete this; }
+}
+
+XTaskSlab_::~XTaskSlab_() {
+    for (auto & chunk : m_chunks_)
+    { delete[] chunk.load(std::memory_order_relaxed); }
+}
+
+void XTaskSlab_::release() noexcept {
+    if (1 == m_refs_.fetch_sub(1,std::memory_order_acq_rel)) { delete this; }
+}
+
+XTaskSlot_ * XTaskSlab_::slotAt_(std::uint32_t const index) const noexcept
+{ return m_chunks_[index >> ChunkShift_].load(std::memory_order_acquire) + (index & ChunkMask_); }
+
+void XTaskSlab_::pushRange_(std::uint32_t const first,std::uint32_t const last) noexcept {
+    // [first,last]已经按顺序链接,整体压入空闲栈
+    auto const tail{slotAt_(last)};
+    auto head{m_head_.load(std::memory_order_relaxed)};
+    do { tail->m_next.store(index_(head),std::memory_order_relaxed); }
+    while (!m_head_.compare_exchange_weak(head,pack_(first,tag_(head) + 1)
+        ,std::memory_order_release,std::memory_order_relaxed));
+}
+
+XTaskSlot_ * XTaskSlab_::grow_() {
+
+    std::unique_lock lock(m_growMtx_);
+
+    if (m_chunksSize_ >= MaxChunks_) { return {}; }
+
+    auto const chunk{new (std::nothrow) XTaskSlot_[ChunkSize_]};
+    if (!chunk) { return {}; }
+
+    auto const base{m_chunksSize_ << ChunkShift_};
+    for (std::uint32_t i{}; i < ChunkSize_; ++i) {
+        chunk[i].m_slab = this;
+        chunk[i].m_index = base + i;
+        chunk[i].m_next.store(base + i + 1,std::memory_order_relaxed);
+    }
+    m_chunks_[m_chunksSize_++].store(chunk,std::memory_order_release);
+
+    // 第一个槽直接返回,其余放入空闲栈
+    pushRange_(base + 1,base + ChunkSize_ - 1);
+    return chunk;
+}
+
+XTaskSlot_ * XTaskSlab_::acquire() noexcept {
+
+    auto head{m_head_.load(std::memory_order_acquire)};
+
+    while (Nil_ != index_(head)) {
+        auto const slot{slotAt_(index_(head))};
+        if (m_head_.compare_exchange_weak(head
+            ,pack_(slot->m_next.load(std::memory_order_relaxed),tag_(head) + 1)
+            ,std::memory_order_acquire,std::memory_order_acquire))
+        {
+            m_refs_.fetch_add(1,std::memory_order_relaxed);
+            return slot;
+        }
+    }
+
+    try {
+        if (auto const slot{grow_()}) {
+            m_refs_.fetch_add(1,std::memory_order_relaxed);
+            return slot;
+        }
+    } catch (std::exception const &) {}
+
+    return new (std::nothrow) XTaskSlot_{};
+}
+
+void XTaskSlab_::release(XTaskSlot_ * const slot) noexcept {
+    if (this != slot->m_slab) { delete slot; return; }
+    auto head{m_head_.load(std::memory_order_relaxed)};
+    do { slot->m_next.store(index_(head),std::memory_order_relaxed); }
+    while (!m_head_.compare_exchange_weak(head,pack_(slot->m_index,tag_(head) + 1)
+        ,std::memory_order_release,std::memory_order_relaxed));
+    release();
+}
+
+bool XTaskResultBase_::isReady_() const noexcept
+{ return XTaskSlot_::Pending_ != m_slot_->m_state.load(std::memory_order_acquire); }
+
+void XTaskResultBase_::wait_() const noexcept
+{ m_slot_->m_state.wait(XTaskSlot_::Pending_,std::memory_order_acquire); }
+
+void * XTaskResultBase_::value_() const noexcept(false) {
+    wait_();
+    if (auto const & error{m_slot_->m_error}) { std::rethrow_exception(error); }
+    return m_slot_->m_callable;
+}
+
+void XTaskResultBase_::release_() noexcept
+{ if (auto const slot{std::exchange(m_slot_,{})}) { slot->release(); } }
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
@@ -0,0 +1,121 @@
+#ifndef XUTILS2_X_TASK_SLOT_P_HPP
+#define XUTILS2_X_TASK_SLOT_P_HPP 1
+
+#include <XThreadPool/xthreadpool.hpp>
+#include "xpooltask_p.hpp"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <cstddef>
+#include <cstdint>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+class XTaskSlab_;
+
+/**
+ * 固定大小的任务槽,可调用对象直接构造在槽内的存储中,执行后返回值构造在同一块存储中
+ * 超过内联容量或对齐要求的可调用对象才会单独分配
+ * 槽由线程池与XTaskResult共同引用,两者都释放后才归还
+ */
+class alignas(64) XTaskSlot_ final : public XPoolTask_ {
+public:
+    static constexpr std::size_t InlineSize_ {64};
+    /// 执行并销毁可调用对象,有返回值时把返回值构造在同一块存储中
+    using invoke_t = void(*)(void *);
+    using destroy_t = void(*)(void *) noexcept;
+
+    enum State_ : std::uint32_t { Pending_,Value_,Error_ };
+
+    X_DISABLE_COPY_MOVE(XTaskSlot_)
+
+    invoke_t m_invoke{};
+    /// 销毁未执行的可调用对象
+    destroy_t m_destroy{};
+    /// 销毁返回值,没有返回值时为空
+    destroy_t m_dropResult{};
+    void * m_callable{};
+    XTaskSlab_ * m_slab{};
+    std::exception_ptr m_error{};
+    std::atomic<std::uint32_t> m_next{},m_refs{},m_state{};
+    std::uint32_t m_index{};
+    std::uint32_t m_align{};
+    alignas(std::max_align_t) std::byte m_storage[InlineSize_]{};
+
+    XTaskSlot_() = default;
+    ~XTaskSlot_() override = default;
+
+    /// 为可调用对象准备存储,成功返回存储地址
+    /// @param retain 是否有XTaskResult引用本槽
+    [[nodiscard]] void * bind(std::size_t size,std::size_t align,invoke_t invoke
+        ,destroy_t destroy,destroy_t dropResult,bool retain) noexcept;
+
+    void execute() noexcept override;
+
+    void discard() noexcept override;
+
+    /// 释放一个引用,最后一个引用释放时归还任务槽
+    void release() noexcept;
+
+private:
+    void finish(State_ state) noexcept;
+    void recycle() noexcept;
+};
+
+/**
+ * 线程池持有的任务槽分配器
+ * 槽按块分配且在分配器生命周期内不释放,空闲槽通过带版本号的无锁栈复用,
+ * 稳态下获取和归还任务槽均不产生堆分配
+ * 每个取出的槽持有一个引用,线程池析构后分配器在最后一个槽(如XTaskResult仍引用的槽)归还时销毁
+ */
+class XTaskSlab_ final {
+    static constexpr std::uint32_t ChunkShift_ {8}
+        ,ChunkSize_ {1u << ChunkShift_}
+        ,ChunkMask_ {ChunkSize_ - 1}
+        ,MaxChunks_ {1024}
+        ,Nil_ {UINT32_MAX};
+
+    std::array<std::atomic<XTaskSlot_ *>,MaxChunks_> m_chunks_{};
+    std::atomic<std::uint64_t> m_head_{pack_(Nil_,0)};
+    std::mutex m_growMtx_{};
+    std::uint32_t m_chunksSize_{};
+    std::atomic<std::size_t> m_refs_{1};
+
+    ~XTaskSlab_();
+
+    static constexpr std::uint64_t pack_(std::uint32_t const index,std::uint32_t const tag) noexcept
+    { return static_cast<std::uint64_t>(tag) << 32 | index; }
+
+    static constexpr std::uint32_t index_(std::uint64_t const v) noexcept
+    { return static_cast<std::uint32_t>(v); }
+
+    static constexpr std::uint32_t tag_(std::uint64_t const v) noexcept
+    { return static_cast<std::uint32_t>(v >> 32); }
+
+    [[nodiscard]] XTaskSlot_ * slotAt_(std::uint32_t index) const noexcept;
+
+    void pushRange_(std::uint32_t first,std::uint32_t last) noexcept;
+
+    XTaskSlot_ * grow_();
+
+public:
+    X_DISABLE_COPY_MOVE(XTaskSlab_)
+
+    XTaskSlab_() = default;
+
+    /// 由线程池调用,放弃所有权
+    void release() noexcept;
+
+    /// 获取空闲槽,槽已用尽时退化为单独分配的槽
+    [[nodiscard]] XTaskSlot_ * acquire() noexcept;
+
+    /// 归还任务槽,单独分配的槽直接释放
+    void release(XTaskSlot_ * slot) noexcept;
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
@@ -1,7 +1,21 @@
 #include <utility>
 #include "xthreadpool_p.hpp"
+#include "xabstractrunnable_p.hpp"
 #include <iostream>
 #include <XHelper/xraii.hpp>
+#include <XThreadPool/xcoroutine.hpp>
+#include <string>
+#include <limits>
+#include <optional>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#if defined(X_PLATFORM_LINUX) || defined(X_PLATFORM_MACOS)
+#include <pthread.h>
+#include <climits>
+#endif
 
 XTD_NAMESPACE_BEGIN
 XTD_INLINE_NAMESPACE_BEGIN(v1)
@@ -9,108 +23,678 @@ XTD_INLINE_NAMESPACE_BEGIN(v1)
 #ifndef UNUSE_STD_THREAD_LOCAL
     static constinit thread_local void * sm_isCurrentTask_{};
 #endif
+    static constinit thread_local XWorker_ * sm_currentWorker_{};
+    static constinit thread_local XLockFreeTokens_ * sm_lockFreeTokens_{};
+    static constinit thread_local XWorkerStats_ * sm_workerStats_{};
+
+    using Level_ = XPoolEvent::Level;
+    using Kind_ = XPoolEvent::Kind;
+
+void XPoolEvent::toConsole(XPoolEvent const & event) {
+    static constexpr std::string_view levels[]{"debug","info","warn","error"};
+    auto const level{static_cast<std::size_t>(event.m_level)};
+    std::cerr << "[XThreadPool][" << (level < std::size(levels) ? levels[level] : "?") << "] "
+        << event.m_message << " (" << event.m_value << ")\n";
+}
 
-XAbstractRunnablePtr XThreadPoolPrivate::acquireTask() {
-
-    using namespace std::chrono;
+XThreadPoolPrivate::~XThreadPoolPrivate() {
+    while (auto const task{m_tasksQueue.pop()}) { dropTask(task); }
+    for (auto const & node : m_nodeQueues) {
+        while (auto const task{node->m_queue.pop()}) { dropTask(task); }
+    }
+    for (auto const & worker : m_workers) {
+        while (auto const task{worker->m_deque.pop()}) { dropTask(task); }
+    }
+    if (m_lockFreeTasks) {
+        XPoolTask_ * task{};
+        while (m_lockFreeTasks->try_dequeue(task)) { if (task) { dropTask(task); } }
+    }
+    m_taskSlab->release();
+    m_frameAllocator->release();
+}
 
-    auto const last_time { high_resolution_clock::now() };
+bool XThread_::start(std::size_t const stackSize) const {
+#if defined(X_PLATFORM_LINUX) || defined(X_PLATFORM_MACOS)
+    if (stackSize) {
+        using arg_t = std::pair<task_t,Tid_t>;
+        auto arg{std::make_unique<arg_t>(m_taskFunc_,get_id())};
+        pthread_attr_t attr{};
+        pthread_attr_init(std::addressof(attr));
+        pthread_attr_setdetachstate(std::addressof(attr),PTHREAD_CREATE_DETACHED);
+        auto const sizeOk{!pthread_attr_setstacksize(std::addressof(attr),std::max<std::size_t>(stackSize,PTHREAD_STACK_MIN))};
+        pthread_t th{};
+        auto const created{sizeOk && !pthread_create(std::addressof(th),std::addressof(attr),[](void * const p) -> void * {
+            std::unique_ptr<arg_t> const a{static_cast<arg_t *>(p)};
+            a->first(a->second);
+            return {};
+        },arg.get())};
+        pthread_attr_destroy(std::addressof(attr));
+        if (created) { static_cast<void>(arg.release()); return true; }
+    }
+#endif
+    std::thread(m_taskFunc_,get_id()).detach();
+    return !stackSize;
+}
 
+XSize_t XThreadPoolPrivate::currentTasksSize() const noexcept {
+    if (Mode::LOCK_FREE == m_mode) { return m_queuedTasksSize.loadAcquire(); }
     std::unique_lock lock(m_mtx);
+    auto ret{static_cast<XSize_t>(m_tasksQueue.size()) + m_nodeTasksSize.loadAcquire()};
+    for (auto const & worker : m_workers)
+    { ret += static_cast<XSize_t>(worker->m_deque.sizeApprox()); }
+    return ret;
+}
+
+void XThreadPoolPrivate::storeQueuedSize() noexcept {
+    m_queuedTasksSize.storeRelease(static_cast<XSize_t>(m_tasksQueue.size()));
+    m_urgentTasksSize.storeRelease(static_cast<XSize_t>(m_tasksQueue.urgentSize()));
+}
+
+XPoolTask_ * XThreadPoolPrivate::prepareTask(XAbstractRunnablePtr const & task,XTaskOptions const & options) {
+    task->set_exit_function_([this]{return m_isPoolRunning.loadAcquire();});
+    task->resetRecall_();
+    task->allow_get_();
+    auto const d{task->d_func()};
+    d->m_retain = task;
+    d->m_priority = static_cast<xuint32>(options.m_priority);
+    d->m_deadline = options.m_deadline;
+    d->m_token = options.m_token;
+    return d;
+}
+
+bool XThreadPoolPrivate::hasStealableTask() const noexcept {
+    return std::ranges::any_of(m_workers,[](auto const & worker) noexcept
+        { return !worker->m_deque.emptyApprox(); });
+}
+
+XWorker_ * XThreadPoolPrivate::localWorker() const noexcept {
+    auto const worker{sm_currentWorker_};
+    return worker && this == worker->m_pool ? worker : nullptr;
+}
+
+void XThreadPoolPrivate::wakeWorker(std::size_t const count) {
+    // 与idleWait中休眠前的检查构成Dekker式同步,保证不丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // 只唤醒需要的数量,被唤醒的线程自行减少休眠计数,多出的信号只造成一次空转
+    if (auto const sleeping{static_cast<std::size_t>(m_sleepingThreadsSize.loadRelaxed())}; sleeping > 0 && count > 0)
+    { m_idleSem.signal(static_cast<moodycamel::XLightweightSemaphore::ssize_t>(std::min(sleeping,count))); }
+}
+
+static void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+template<typename Probe_>
+bool XThreadPoolPrivate::idleWait(Probe_ && probe,std::int64_t const timeout_usecs) {
+
+    // 单核机器上自旋只会推迟持有任务的线程
+    static auto const spinCount{std::thread::hardware_concurrency() > 1 ? std::numeric_limits<xuint32>::max() : xuint32{}};
+
+    for (xuint32 i{}, n{std::min(m_config.m_spinCount,spinCount)}; i < n; ++i) {
+        if (probe()) { return true; }
+        cpuRelax();
+    }
+
+    for (xuint32 i{}; i < m_config.m_yieldCount; ++i) {
+        if (probe()) { return true; }
+        std::this_thread::yield();
+    }
+
+    m_sleepingThreadsSize.fetchAndAddOrdered(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    X_RAII const raii{[]{},[this]{ m_sleepingThreadsSize.fetchAndSubOrdered(1); }};
 
-    while (m_tasksQueue.empty()){
+    if (probe() || !m_isPoolRunning.loadAcquire()) { return true; }
+
+    return timeout_usecs < 0 ? m_idleSem.wait() : m_idleSem.wait(timeout_usecs);
+}
+
+XPoolTask_ * XThreadPoolPrivate::stealTask(XWorker_ & worker) {
+
+    auto const nodes{m_nodeQueues.size()};
+    auto const nodeTasks{nodes && m_nodeTasksSize.loadAcquire() > 0};
+    if (nodeTasks && worker.m_node < nodes) {
+        if (auto const task{takeNodeTask(worker,*m_nodeQueues[worker.m_node],true)}) { return task; }
+    }
+
+    if (m_queuedTasksSize.loadAcquire() > 0) {
+        std::unique_lock lock(m_mtx);
+        if (!m_tasksQueue.empty()) {
+            auto const isFull{!hasQueueRoom()};
+            // 按工作线程数均分注入队列,避免一个线程搬空全部任务
+            // 有高优先级任务时只取一个,不让其进入本地队列排在其他任务之后
+            auto const n{m_tasksQueue.urgentSize() ? std::size_t{1}
+                : std::min({STEAL_BATCH_SIZE,m_tasksQueue.size(),m_tasksQueue.size() / m_workers.size() + 1})};
+            auto const task{m_tasksQueue.pop()};
+            for (std::size_t i{1}; i < n; ++i) { worker.m_deque.push(m_tasksQueue.pop()); }
+            storeQueuedSize();
+            if (isFull) { m_taskQueueCond.notify_all(); }
+            lock.unlock();
+            if (n > 1) { wakeWorker(); }
+            return task;
+        }
+    }
+
+    // 其他节点的任务排在同节点线程之后,每次只取一个,不搬入本地队列
+    auto remote{nodeTasks};
+    auto const takeRemote{[&]() -> XPoolTask_ * {
+        remote = {};
+        for (std::size_t i{1}; i < nodes; ++i) {
+            if (auto const task{takeNodeTask(worker,*m_nodeQueues[(worker.m_node + i) % nodes],false)}) { return task; }
+        }
+        return {};
+    }};
+
+    for (auto const victim : worker.m_victims) {
+        if (remote && victim->m_node != worker.m_node) {
+            if (auto const task{takeRemote()}) { return task; }
+        }
+        if (auto const task{victim->m_deque.steal()}) {
+            if (auto const stats{sm_workerStats_}) { XWorkerStats_::add(stats->m_steals); }
+            return task;
+        }
+    }
+    return remote ? takeRemote() : nullptr;
+}
+
+XPoolTask_ * XThreadPoolPrivate::acquireStealingTask(XWorker_ & worker) {
+
+    while (true) {
+
+        // 共享队列中的高优先级任务先于本地队列
+        if (m_urgentTasksSize.loadAcquire() > 0) {
+            if (auto const task{stealTask(worker)}) { return task; }
+        }
+
+        if (auto const task{worker.m_deque.pop()}) { return task; }
+
+        if (auto const task{stealTask(worker)}) { return task; }
+
+        if (!m_isPoolRunning.loadAcquire() && !m_queuedTasksSize.loadAcquire() && !m_nodeTasksSize.loadAcquire()
+            && !hasStealableTask()) { return {}; }
+
+        static_cast<void>(idleWait([this]{
+            return m_queuedTasksSize.loadAcquire() > 0 || m_nodeTasksSize.loadAcquire() > 0 || hasStealableTask(); }));
+    }
+}
+
+XPoolTask_ * XThreadPoolPrivate::acquireTask() {
+
+    using namespace std::chrono;
+
+    auto last_time { steady_clock::now() };
+    auto keep_alive { duration_cast<steady_clock::duration>(seconds(m_threadTimeout.loadAcquire())) };
+
+    while (true) {
+
+        if (m_queuedTasksSize.loadAcquire() > 0) {
+            std::unique_lock lock(m_mtx);
+            if (!m_tasksQueue.empty()) {
+                auto const isFull{!hasQueueRoom()};
+                auto const task{m_tasksQueue.pop()};
+                storeQueuedSize();
+                // 只唤醒等待队列空位的提交者,工作线程由enqueue按任务数唤醒
+                if (isFull) { m_taskQueueCond.notify_all(); }
+                // 剩余任务仍在排队时,取任务的线程也参与扩容判断
+                auto const threads{m_tasksQueue.empty() ? decltype(growCacheThreads()){} : growCacheThreads()};
+                lock.unlock();
+                startThreads(threads);
+                return task;
+            }
+        }
 
         if (!m_isPoolRunning.loadAcquire()){ return {}; }
 
+        std::int64_t timeout_usecs{-1};
         if (Mode::CACHE == m_mode) {
-            using std::chrono::operator""s;
-            if (std::cv_status::timeout == m_taskQueueCond.wait_for(lock,1s)) {
-                if (auto const dur{duration_cast<seconds>(high_resolution_clock::now() - last_time)};
-                    dur >= seconds (m_threadTimeout.loadAcquire()))
-                {
-                    std::cerr << "acquireTask timeout: " << m_threadTimeout.loadAcquire() << "\n" << std::flush;
+            auto remaining{keep_alive - (steady_clock::now() - last_time)};
+            if (remaining <= steady_clock::duration::zero()) {
+                if (retireCacheThread(remaining)) {
+                    emit(Level_::DEBUG_LEVEL,Kind_::THREAD_RETIRED,static_cast<xuint64>(m_threadTimeout.loadAcquire())
+                        ,"idle timeout, thread retired");
                     return {};
                 }
-#if 0
-                else { std::cout << "no task duration: " << dur << " seconds\n" << std::flush; }
-#endif
+                last_time = steady_clock::now();
+                keep_alive = remaining;
             }
-        } else { m_taskQueueCond.wait(lock); }
-    }
-
-    if (!m_tasksQueue.empty()) { m_taskQueueCond.notify_all(); }
+            timeout_usecs = std::max<std::int64_t>(duration_cast<microseconds>(remaining).count(),1);
+        }
 
-    auto task{m_tasksQueue.front()};
-    m_tasksQueue.pop_front();
-    return task;
+        static_cast<void>(idleWait([this]{ return m_queuedTasksSize.loadAcquire() > 0; },timeout_usecs));
+    }
 }
 
-XAbstractRunnablePtr XThreadPoolPrivate::append(XAbstractRunnablePtr task) {
+bool XThreadPoolPrivate::acceptTask(XAbstractRunnablePtr const & task) {
 
     if (!task){
-        std::cerr << FUNC_SIGNATURE << " tips: task is empty!\n" << std::flush;
-        return task;
+        emit(Level_::WARN_LEVEL,Kind_::INVALID_TASK,{},"task is empty");
+        return {};
     }
 
 #ifdef UNUSE_STD_THREAD_LOCAL
-    if (m_isCurrentTask_().value_or(nullptr) == task.get()){
+    if (m_isCurrentTask_().value_or(nullptr) == static_cast<XPoolTask_ *>(task->d_func())){
 #else
-    if (task.get() == sm_isCurrentTask_){
+    if (static_cast<XPoolTask_ *>(task->d_func()) == sm_isCurrentTask_){
 #endif
-        std::cerr << FUNC_SIGNATURE << " tips:Do not add your own behavior to the execution of your own thread functions\n" << std::flush;
-        return task;
+        emit(Level_::WARN_LEVEL,Kind_::INVALID_TASK,{},"a task cannot add itself while it is running");
+        return {};
     }
 
     if (const void * old_value{};
         !task->Owner_().testAndSetOrdered({},this,old_value)){
         if (this != old_value){
-            std::cerr << FUNC_SIGNATURE << " tips: This task has been added to the pool and cannot be added to other pools until it is completed\n";
-            return task;
+            emit(Level_::WARN_LEVEL,Kind_::INVALID_TASK,{}
+                ,"task has been added to another pool and cannot be added until it is completed");
+            return {};
         }
     }
+    return true;
+}
+
+std::vector<XThread_::XThreadPtr> XThreadPoolPrivate::growCacheThreads() {
+
+    using namespace std::chrono;
+
+    std::vector<XThread_::XThreadPtr> ret{};
+
+    if (Mode::CACHE != m_mode || !m_isPoolRunning.loadAcquire()) { return ret; }
+
+    auto const threads{m_threadsContainer.size()},
+        limit{static_cast<std::size_t>(std::max<XSize_t>(m_threadsSizeThreshold.loadAcquire(),0))},
+        idle{static_cast<std::size_t>(std::max<XSize_t>(m_idleThreadsSize.loadAcquire(),0))},
+        queued{m_tasksQueue.size()};
+
+    // 空闲线程足够处理排队任务,新建的线程在启动前也计为空闲,不会重复扩容
+    if (threads >= limit || queued <= idle) { return ret; }
+
+    auto const now{steady_clock::now()};
+    auto const & elastic{m_elastic};
+    if (now - m_lastGrow < elastic.m_growInterval) { return ret; }
+
+    auto const latency{now - m_tasksQueue.oldest()->m_enqueueTime};
+    auto const target{std::max(duration_cast<steady_clock::duration>(elastic.m_targetLatency),steady_clock::duration{1})};
+    auto const saturated{!threads ||
+        static_cast<double>(threads - std::min(idle,threads)) >= elastic.m_targetUtilization * static_cast<double>(threads)};
+    if (latency < target && !saturated) { return ret; }
+
+    auto const ratio{static_cast<std::size_t>(latency / target)};
+    auto step{ratio > 1 ? threads * (ratio - 1) : std::size_t{1}};
+    step = std::min({step,queued - idle,static_cast<std::size_t>(std::max(elastic.m_maxGrowStep,xuint32{1})),limit - threads});
+    step = std::max<std::size_t>(step,1);
+
+    ret.reserve(step);
+    for (std::size_t i{}; i < step; ++i) {
+        if (auto th{createThread({},static_cast<std::size_t>(m_threadIndex.fetchAndAddRelaxed(1)))})
+        { ret.push_back(std::move(th)); }
+    }
+    m_lastGrow = now;
+    emit(Level_::DEBUG_LEVEL,Kind_::THREADS_GROWN,ret.size(),"cache threads grown");
+    return ret;
+}
+
+void XThreadPoolPrivate::startThreads(std::vector<XThread_::XThreadPtr> const & threads) const
+{
+    for (auto const & th : threads) {
+        if (!th->start(m_config.m_stackSize))
+        { emit(Level_::WARN_LEVEL,Kind_::PLACEMENT_FAILED,m_config.m_stackSize,"stack size not applied, use default"); }
+    }
+}
+
+bool XThreadPoolPrivate::retireCacheThread(std::chrono::steady_clock::duration & retry) {
+
+    using namespace std::chrono;
 
     std::unique_lock lock(m_mtx);
+    auto const now{steady_clock::now()};
+    auto const & elastic{m_elastic};
+    retry = std::max<steady_clock::duration>(elastic.m_shrinkInterval,milliseconds{1});
+
+    if (m_threadsContainer.size() <= elastic.m_minThreads) { return {}; }
 
-    using std::chrono::operator""s;
-    if(!m_taskQueueCond.wait_for(lock,1s,[this]{
-        return m_tasksQueue.size() < static_cast<decltype(m_tasksQueue.size())>(m_tasksSizeThreshold.loadAcquire());})){
-        std::cerr << "task queue is full, join task failed.\n" << std::flush;
-        return task;
+    // 刚扩容过说明负载仍有波动,推迟退出,避免反复创建与销毁线程
+    if (auto const sinceGrow{now - m_lastGrow}; sinceGrow < elastic.m_shrinkDelay) {
+        retry = std::max<steady_clock::duration>(elastic.m_shrinkDelay - sinceGrow,milliseconds{1});
+        return {};
     }
 
-    task->set_exit_function_([this]{return m_isPoolRunning.loadAcquire();});
-    task->resetRecall_();
-    task->allow_get_();
+    if (auto const sinceShrink{now - m_lastShrink}; sinceShrink < elastic.m_shrinkInterval) {
+        retry = std::max<steady_clock::duration>(elastic.m_shrinkInterval - sinceShrink,milliseconds{1});
+        return {};
+    }
 
-    m_tasksQueue.push_back(task);
-    m_taskQueueCond.notify_all();
+    m_lastShrink = now;
+    return true;
+}
 
-    if (Mode::CACHE == m_mode &&
-        m_isPoolRunning.loadAcquire() &&
-        m_threadsContainer.size() < static_cast<decltype(m_threadsContainer.size())>(m_threadsSizeThreshold.loadAcquire()) &&
-        m_tasksQueue.size() > static_cast<decltype(m_tasksQueue.size())>(m_idleThreadsSize.loadAcquire()))
-    {
+XSubmitStatus XThreadPoolPrivate::append(XAbstractRunnablePtr const & task,XTaskOptions const & options) {
+    if (!acceptTask(task)) { return XSubmitStatus::INVALID_TASK; }
+    return enqueue(prepareTask(task,options),options);
+}
+
+XThreadPoolPrivate::Overflow_ XThreadPoolPrivate::overflow(XTaskOptions const & options) const noexcept {
+    using Overflow = XTaskOptions::Overflow;
+    Overflow_ ret{options.m_overflow,options.m_blockTimeout};
+    if (Overflow::DEFAULT == ret.m_action) { ret.m_action = m_config.m_overflow; }
+    if (Overflow::DEFAULT == ret.m_action) { ret.m_action = Overflow::BLOCK; }
+    if (ret.m_timeout.count() < 0) { ret.m_timeout = std::max(m_config.m_blockTimeout,std::chrono::microseconds{}); }
+    return ret;
+}
+
+std::size_t XThreadPoolPrivate::takeQuota(std::size_t const n,std::atomic_size_t * & counter) {
+
+    static constinit thread_local struct { xuint64 m_pool; std::atomic_size_t * m_counter; } sm_quotaCache_{};
 
-        auto thSize{static_cast<XSize_t>(m_tasksQueue.size())};
+    counter = {};
+    auto const quota{m_config.m_producerQuota};
+    if (!quota) { return n; }
 
-        if (thSize >= m_threadsSizeThreshold.loadAcquire()){
-            thSize = m_threadsSizeThreshold.loadAcquire() - static_cast<decltype(thSize)>(m_threadsContainer.size());
+    if (m_id != sm_quotaCache_.m_pool) {
+        std::unique_lock lock(m_mtx);
+        auto & entry{m_producers[std::this_thread::get_id()]};
+        if (!entry) { entry = std::addressof(m_quotaCounters.emplace_back()); }
+        sm_quotaCache_ = {m_id,entry};
+    }
+
+    counter = sm_quotaCache_.m_counter;
+    auto current{counter->load(std::memory_order_acquire)};
+    while (true) {
+        auto const granted{current < quota ? std::min(n,quota - current) : std::size_t{}};
+        if (!granted || counter->compare_exchange_weak(current,current + granted,std::memory_order_acq_rel)) { return granted; }
+    }
+}
+
+XSubmitStatus XThreadPoolPrivate::runInCaller(XPoolTask_ * const task) noexcept {
+    task->releaseQuota();
+    if (task->cancelled()) {
+        m_cancelledTasksSize.fetchAndAddRelaxed(1);
+        task->discard();
+        return XSubmitStatus::CANCELLED;
+    }
+    auto const token{XCancellationToken::exchangeCurrent_(std::addressof(task->m_token))};
+#ifndef UNUSE_STD_THREAD_LOCAL
+    auto const previous{std::exchange(sm_isCurrentTask_,static_cast<void *>(task))};
+    task->execute();
+    sm_isCurrentTask_ = previous;
+#else
+    const XThreadLocalStorageConstVoid set(m_isCurrentTask_,task);
+    task->execute();
+#endif
+    XCancellationToken::exchangeCurrent_(token);
+    return XSubmitStatus::RAN_IN_CALLER;
+}
+
+std::size_t XThreadPoolPrivate::reserveLockFree(std::size_t const count,std::chrono::microseconds const timeout) {
+    using namespace std::chrono;
+    auto const deadline{steady_clock::now() + timeout};
+    auto backoff{microseconds{1}};
+    while (true) {
+        auto const threshold{m_tasksSizeThreshold.loadAcquire()};
+        auto current{m_queuedTasksSize.loadAcquire()};
+        while (current < threshold) {
+            auto const n{std::min(static_cast<XSize_t>(count),threshold - current)};
+            if (m_queuedTasksSize.testAndSetOrdered(current,current + n,current)) { return static_cast<std::size_t>(n); }
         }
+        if (steady_clock::now() >= deadline) { return {}; }
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min(backoff * 2,duration_cast<microseconds>(milliseconds{1}));
+    }
+}
 
-        for (decltype(thSize) i{};i < thSize;++i){
-            if (const auto th{XThread_::create([this](const auto &id){run(id);})}){
-                m_threadsContainer[th->get_id()] = th;
-                m_idleThreadsSize.fetchAndAddRelease(1);
-                th->start();
-                m_taskQueueCond.notify_all();
-            }
+XSubmitStatus XThreadPoolPrivate::enqueueLockFree(XPoolTask_ * const task,Overflow_ const & policy) {
+
+    using Overflow = XTaskOptions::Overflow;
+
+    XPoolTask_ * dropped{};
+    if (!reserveLockFree(1,Overflow::BLOCK == policy.m_action ? policy.m_timeout : std::chrono::microseconds{})) {
+        if (Overflow::CALLER_RUNS == policy.m_action) { return runInCaller(task); }
+        // 取出一个排队的任务,新任务沿用它占用的容量
+        if (Overflow::DROP_OLDEST == policy.m_action && m_lockFreeTasks->try_dequeue(dropped) && !dropped) {
+            m_lockFreeTasks->enqueue(static_cast<XPoolTask_ *>(nullptr));
+        }
+        if (!dropped) {
+            emit(Level_::WARN_LEVEL,Kind_::TASK_REJECTED,1,"task queue is full, join task failed");
+            reject();
+            dropTask(task);
+            return XSubmitStatus::QUEUE_FULL;
         }
-        std::cout << "new add ThreadSize: " << thSize << "\n" << std::flush;
     }
 
+    auto const tokens{sm_lockFreeTokens_};
+    if (tokens && this == tokens->m_pool ? m_lockFreeTasks->enqueue(tokens->m_producer,task) : m_lockFreeTasks->enqueue(task)) {
+        if (dropped) {
+            emit(Level_::WARN_LEVEL,Kind_::TASK_REJECTED,1,"task queue is full, oldest task dropped");
+            reject();
+            dropTask(dropped);
+        }
+        return XSubmitStatus::ACCEPTED;
+    }
+
+    m_queuedTasksSize.fetchAndSubRelease(1);
+    emit(Level_::ERROR_LEVEL,Kind_::TASK_REJECTED,1,"task queue allocation failed");
+    reject(dropped ? 2 : 1);
+    if (dropped) { dropTask(dropped); }
+    dropTask(task);
+    return XSubmitStatus::ALLOCATION_FAILED;
+}
+
+XPoolTask_ * XThreadPoolPrivate::acquireLockFreeTask(XLockFreeTokens_ & tokens) {
+
+    static auto const spinCount{std::thread::hardware_concurrency() > 1 ? std::numeric_limits<xuint32>::max() : xuint32{}};
+
+    auto & queue{*m_lockFreeTasks};
+
+    while (true) {
+        XPoolTask_ * task{};
+        for (xuint32 i{}, n{std::min(m_config.m_spinCount,spinCount)}; i < n && !queue.try_dequeue(tokens.m_consumer,task); ++i)
+        { cpuRelax(); }
+        if (!task) { queue.wait_dequeue(tokens.m_consumer,task); }
+        if (task) {
+            m_queuedTasksSize.fetchAndSubRelease(1);
+            return task;
+        }
+        // 停止标记不保证排在所有任务之后,还有任务时放回标记,先处理剩余任务
+        if (m_queuedTasksSize.loadAcquire() > 0) {
+            queue.enqueue(tokens.m_producer,static_cast<XPoolTask_ *>(nullptr));
+            std::this_thread::yield();
+            continue;
+        }
+        return {};
+    }
+}
+
+XSubmitStatus XThreadPoolPrivate::enqueue(XPoolTask_ * const task,XTaskOptions const & options) {
+
+    using Overflow = XTaskOptions::Overflow;
+
+    if (stampEnqueue()) { task->m_enqueueTime = std::chrono::steady_clock::now(); }
+    m_submittedTasksSize.fetchAndAddRelaxed(1);
+
+    if (task->cancelled()) {
+        m_cancelledTasksSize.fetchAndAddRelaxed(1);
+        task->discard();
+        return XSubmitStatus::CANCELLED;
+    }
+
+    if (!takeQuota(1,task->m_quota)) {
+        emit(Level_::WARN_LEVEL,Kind_::TASK_REJECTED,1,"producer quota exceeded, join task failed");
+        reject();
+        task->m_quota = {};
+        task->discard();
+        return XSubmitStatus::QUOTA_EXCEEDED;
+    }
+
+    auto const policy{overflow(options)};
+
+    if (Mode::LOCK_FREE == m_mode) { return enqueueLockFree(task,policy); }
+
+    // 工作线程内提交的默认优先级任务直接进入本地队列,不经过全局锁
+    if (auto const worker{localWorker()}; worker && static_cast<xuint32>(XTaskOptions::Priority::NORMAL) == task->m_priority) {
+        worker->m_deque.push(task);
+        wakeWorker();
+        return XSubmitStatus::ACCEPTED;
+    }
+
+    // 外部线程提交的默认及低优先级任务进入所在节点的注入队列,不经过全局锁;
+    // 高优先级任务仍进入全局注入队列,保证跨节点的优先顺序
+    if (task->m_priority <= static_cast<xuint32>(XTaskOptions::Priority::NORMAL) && m_isPoolRunning.loadAcquire()
+        && !m_nodeQueues.empty() && enqueueNode(task))
+    { return XSubmitStatus::ACCEPTED; }
+
+    std::unique_lock lock(m_mtx);
+
+    auto const hasRoom{[this]{ return hasQueueRoom(); }};
+
+    XPoolTask_ * dropped{};
+    if (!hasRoom()) {
+        switch (policy.m_action) {
+            case Overflow::CALLER_RUNS:
+                lock.unlock();
+                return runInCaller(task);
+            case Overflow::DROP_OLDEST:
+                dropped = m_tasksQueue.popOldest();
+                break;
+            case Overflow::BLOCK:
+                if (m_taskQueueCond.wait_for(lock,policy.m_timeout,hasRoom)) { break; }
+                [[fallthrough]];
+            default:
+                break;
+        }
+        if (!dropped && !hasRoom()) {
+            emit(Level_::WARN_LEVEL,Kind_::TASK_REJECTED,1,"task queue is full, join task failed");
+            lock.unlock();
+            reject();
+            dropTask(task);
+            return XSubmitStatus::QUEUE_FULL;
+        }
+    }
+
+    m_tasksQueue.push(task);
+    storeQueuedSize();
+
+    auto const threads{growCacheThreads()};
+
     lock.unlock();
-    m_taskQueueCond.notify_all();
-    return task;
+    if (dropped) {
+        emit(Level_::WARN_LEVEL,Kind_::TASK_REJECTED,1,"task queue is full, oldest task dropped");
+        reject();
+        dropTask(dropped);
+    }
+    startThreads(threads);
+    wakeWorker();
+    return XSubmitStatus::ACCEPTED;
+}
+
+std::vector<XAbstractRunnablePtr> XThreadPoolPrivate::appendBulk(std::vector<XAbstractRunnablePtr> && tasks) {
+
+    using Overflow = XTaskOptions::Overflow;
+
+    auto const now{stampEnqueue() ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}};
+
+    std::vector<XAbstractRunnablePtr const *> candidates{};
+    candidates.reserve(tasks.size());
+    for (auto const & task : tasks) {
+        if (acceptTask(task)) { candidates.push_back(std::addressof(task)); }
+    }
+
+    if (candidates.empty()) { return std::move(tasks); }
+
+    m_submittedTasksSize.fetchAndAddRelaxed(static_cast<XSize_t>(candidates.size()));
+
+    // 超出配额的任务直接拒绝
+    std::atomic_size_t * quota{};
+    if (auto const granted{takeQuota(candidates.size(),quota)}; granted < candidates.size()) {
+        emit(Level_::WARN_LEVEL,Kind_::TASK_REJECTED,candidates.size() - granted,"producer quota exceeded, tasks join failed");
+        reject(candidates.size() - granted);
+        for (auto i{granted}; i < candidates.size(); ++i) { (*candidates[i])->Owner_().storeRelease({}); }
+        candidates.resize(granted);
+        if (candidates.empty()) { return std::move(tasks); }
+    }
+
+    auto const prepare{[this,now,quota](XAbstractRunnablePtr const & task) {
+        auto const node{prepareTask(task)};
+        node->m_enqueueTime = now;
+        node->m_quota = quota;
+        return node;
+    }};
+
+    if (auto const worker{localWorker()}) {
+        for (auto const task : candidates) { worker->m_deque.push(prepare(*task)); }
+        wakeWorker(candidates.size());
+        return std::move(tasks);
+    }
+
+    auto const policy{overflow({})};
+    std::vector<XPoolTask_ *> dropped{};
+    std::size_t room{};
+
+    if (Mode::LOCK_FREE == m_mode) {
+        room = reserveLockFree(candidates.size(),Overflow::BLOCK == policy.m_action ? policy.m_timeout : std::chrono::microseconds{});
+        if (Overflow::DROP_OLDEST == policy.m_action) {
+            for (XPoolTask_ * task{}; room < candidates.size() && m_lockFreeTasks->try_dequeue(task); ++room) {
+                if (!task) { m_lockFreeTasks->enqueue(static_cast<XPoolTask_ *>(nullptr)); break; }
+                dropped.push_back(task);
+            }
+        }
+        std::vector<XPoolTask_ *> nodes{};
+        nodes.reserve(room);
+        for (std::size_t i{}; i < room; ++i) { nodes.push_back(prepare(*candidates[i])); }
+        if (room && !m_lockFreeTasks->enqueue_bulk(nodes.begin(),nodes.size())) {
+            m_queuedTasksSize.fetchAndSubRelease(static_cast<XSize_t>(room));
+            emit(Level_::ERROR_LEVEL,Kind_::TASK_REJECTED,room,"task queue allocation failed");
+            reject(room);
+            for (auto const node : nodes) { dropTask(node); }
+        }
+    } else {
+        std::unique_lock lock(m_mtx);
+
+        auto const threshold{static_cast<std::size_t>(m_tasksSizeThreshold.loadAcquire())};
+        auto const queued{[this]{
+            return m_tasksQueue.size() + static_cast<std::size_t>(std::max<XSize_t>(m_nodeTasksSize.loadAcquire(),0)); }};
+        auto const hasRoom{[this]{ return hasQueueRoom(); }};
+
+        if (Overflow::BLOCK == policy.m_action && !hasRoom()) {
+            static_cast<void>(m_taskQueueCond.wait_for(lock,policy.m_timeout,hasRoom));
+        }
+
+        room = hasRoom() ? std::min(candidates.size(),threshold - queued()) : std::size_t{};
+        if (Overflow::DROP_OLDEST == policy.m_action) {
+            for (; room < candidates.size() && !m_tasksQueue.empty(); ++room) { dropped.push_back(m_tasksQueue.popOldest()); }
+        }
+
+        for (std::size_t i{}; i < room; ++i) { m_tasksQueue.push(prepare(*candidates[i])); }
+        storeQueuedSize();
+
+        auto const threads{growCacheThreads()};
+
+        lock.unlock();
+        startThreads(threads);
+        wakeWorker(room);
+    }
+
+    if (!dropped.empty()) {
+        emit(Level_::WARN_LEVEL,Kind_::TASK_REJECTED,dropped.size(),"task queue is full, oldest tasks dropped");
+        reject(dropped.size());
+        for (auto const task : dropped) { dropTask(task); }
+    }
+
+    if (room < candidates.size()) {
+        if (Overflow::CALLER_RUNS == policy.m_action) {
+            for (auto i{room}; i < candidates.size(); ++i) { static_cast<void>(runInCaller(prepare(*candidates[i]))); }
+        } else {
+            emit(Level_::WARN_LEVEL,Kind_::TASK_REJECTED,candidates.size() - room,"task queue is full, tasks join failed");
+            reject(candidates.size() - room);
+            if (quota) { quota->fetch_sub(candidates.size() - room,std::memory_order_release); }
+            for (auto i{room}; i < candidates.size(); ++i) { (*candidates[i])->Owner_().storeRelease({}); }
+        }
+    }
+
+    return std::move(tasks);
 }
 
 void XThreadPoolPrivate::start(XSize_t const threadSize) {
@@ -126,37 +710,63 @@ void XThreadPoolPrivate::start(XSize_t const threadSize) {
     auto thSize{threadSize};
 
     if (thSize > m_threadsSizeThreshold.loadAcquire()) {
-        std::cerr << "threadsSize Reached the upper limit\n" << std::flush;
         thSize = m_threadsSizeThreshold.loadAcquire();
+        emit(Level_::WARN_LEVEL,Kind_::LIMIT_REACHED,static_cast<xuint64>(thSize),"threads size reached the upper limit");
     }
 
     if (Mode::CACHE == m_mode){
+        // 启动时不按积压任务数一次创建线程,之后由growCacheThreads按延迟逐步扩容
         std::unique_lock lock(m_mtx);
-        if (const auto tasksSize{static_cast<decltype(thSize)>(m_tasksQueue.size())};
-            tasksSize > m_tasksSizeThreshold.loadAcquire())
-        { thSize = m_tasksSizeThreshold.loadAcquire(); }
-        else {thSize = tasksSize > 0 ? tasksSize : thSize;}
+        auto const tasksSize{static_cast<decltype(thSize)>(m_tasksQueue.size())},
+            step{static_cast<decltype(thSize)>(std::max(m_elastic.m_maxGrowStep,xuint32{1}))},
+            minimum{static_cast<decltype(thSize)>(m_elastic.m_minThreads)};
+        thSize = std::min(std::max({thSize,minimum,std::min(tasksSize,step)}),m_threadsSizeThreshold.loadAcquire());
     }
 
-    std::cout << "Pool Start Running\n" << std::flush;
-    std::cout << "Thread Initial quantity: " << thSize << "\n" << std::flush;
+    emit(Level_::INFO_LEVEL,Kind_::POOL_STARTED,static_cast<xuint64>(thSize),"pool start running");
 
     m_initThreadsSize.storeRelease(0);
 
     std::unique_lock lock(m_mtx);
 
-    for (decltype(thSize) i{}; i < thSize; ++i){
-        if (auto th{ XThread_::create([this](const auto &id){run(id);}) }){
-            m_threadsContainer[th->get_id()].swap(th);
-            m_idleThreadsSize.fetchAndAddRelease(1);
-            m_initThreadsSize.fetchAndAddRelease(1);
+    buildPlacement();
+    buildNodeQueues();
+
+    if (Mode::WORK_STEALING == m_mode) {
+        // 上次运行残留的本地任务已由各自线程执行完毕,可以安全重建
+        m_workers.clear();
+        m_workers.reserve(static_cast<std::size_t>(thSize));
+        for (decltype(thSize) i{}; i < thSize; ++i) {
+            auto const index{static_cast<std::size_t>(i)};
+            auto const worker{m_workers.emplace_back(std::make_unique<XWorker_>(this,index)).get()};
+            worker->m_node = placement(index).first;
+            if (worker->m_node < m_nodeQueues.size()) { ++m_nodeQueues[worker->m_node]->m_workersSize; }
+            if (createThread(worker,index)) { m_initThreadsSize.fetchAndAddRelease(1); }
+        }
+        // 同节点的线程排在前面,每组内从下一个线程开始轮转,避免所有线程窃取同一个目标
+        auto const size{m_workers.size()};
+        for (auto const & worker : m_workers) {
+            worker->m_victims.clear();
+            for (auto const sameNode : {true,false}) {
+                for (std::size_t i{1}; i < size; ++i) {
+                    auto const victim{m_workers[(worker->m_index + i) % size].get()};
+                    if (sameNode == (victim->m_node == worker->m_node)) { worker->m_victims.push_back(victim); }
+                }
+            }
+        }
+    } else {
+        for (decltype(thSize) i{}; i < thSize; ++i){
+            if (createThread({},static_cast<std::size_t>(i))) { m_initThreadsSize.fetchAndAddRelease(1); }
         }
     }
+    m_threadIndex.storeRelease(thSize);
 
     m_isPoolRunning.storeRelease(true);
 
-    for (auto const & item : m_threadsContainer | std::views::values)
-    { item->start(); }
+    std::vector<XThread_::XThreadPtr> threads{};
+    threads.reserve(m_threadsContainer.size());
+    for (auto const & item : m_threadsContainer | std::views::values) { threads.push_back(item); }
+    startThreads(threads);
 }
 
 void XThreadPoolPrivate::stop() {
@@ -165,19 +775,149 @@ void XThreadPoolPrivate::stop() {
 #else
     if(m_isCurrentTask_()){
 #endif
-        std::cerr << FUNC_SIGNATURE << " tips: Working Thread Call invalid\n" << std::flush;
+        emit(Level_::WARN_LEVEL,Kind_::INVALID_CALL,{},"stop cannot be called from a worker thread");
         return;
     }
+    if (m_timers) { m_timers->shutdown(); }
     m_isPoolRunning.storeRelease({});
-    m_taskQueueCond.notify_all();
+    wakeWorker(std::numeric_limits<std::size_t>::max());
     std::unique_lock lock(m_mtx);
+    if (Mode::LOCK_FREE == m_mode && m_lockFreeTasks) {
+        // 每个线程消费一个停止标记后退出
+        for (std::size_t i{}; i < m_threadsContainer.size(); ++i)
+        { m_lockFreeTasks->enqueue(static_cast<XPoolTask_ *>(nullptr)); }
+    }
     m_taskQueueCond.notify_all();
     m_exitCond.wait(lock,[this]()noexcept{ return m_threadsContainer.empty(); });
 }
 
-void XThreadPoolPrivate::run(XSize_t const threadId) {
+XThread_::XThreadPtr XThreadPoolPrivate::createThread(XWorker_ * const worker,std::size_t const index) {
+    auto th{ XThread_::create([this,worker,index](const auto &id){run(id,worker,index);}) };
+    if (th) {
+        m_threadsContainer[th->get_id()] = th;
+        m_idleThreadsSize.fetchAndAddRelease(1);
+    }
+    return th;
+}
+
+void XThreadPoolPrivate::buildPlacement() {
+    m_nodes.clear();
+    m_cpuNodes.clear();
+    if (!m_config.m_numaSpread) { return; }
+    for (auto & cpus : XCpuTopology_::numaNodes()) {
+        // 提交线程可能运行在m_cpus之外,按物理节点映射,没有可用CPU的节点映射到下一个节点
+        for (auto const cpu : cpus) {
+            if (cpu >= m_cpuNodes.size()) { m_cpuNodes.resize(cpu + 1); }
+            m_cpuNodes[cpu] = m_nodes.size();
+        }
+        if (!m_config.m_cpus.empty()) {
+            std::erase_if(cpus,[this](auto const cpu){ return std::ranges::find(m_config.m_cpus,cpu) == m_config.m_cpus.end(); });
+        }
+        if (!cpus.empty()) { m_nodes.push_back(std::move(cpus)); }
+    }
+    if (m_nodes.empty()) {
+        emit(Level_::WARN_LEVEL,Kind_::PLACEMENT_FAILED,{},"no usable NUMA node, threads are not bound");
+    }
+}
+
+void XThreadPoolPrivate::buildNodeQueues() {
+    auto const nodes{Mode::WORK_STEALING == m_mode ? m_nodes.size() : std::size_t{}};
+    if (nodes != m_nodeQueues.size()) {
+        for (auto const & node : m_nodeQueues) {
+            while (auto const task{node->m_queue.pop()}) { m_tasksQueue.push(task); }
+            node->m_size.store({},std::memory_order_relaxed);
+        }
+        m_nodeTasksSize.storeRelease({});
+        storeQueuedSize();
+        m_nodeQueues.clear();
+        for (std::size_t i{}; i < nodes; ++i) { m_nodeQueues.push_back(std::make_unique<XNodeQueue_>()); }
+    }
+    for (auto const & node : m_nodeQueues) { node->m_workersSize = {}; }
+}
+
+bool XThreadPoolPrivate::hasQueueRoom() const noexcept {
+    return static_cast<XSize_t>(m_tasksQueue.size()) + m_nodeTasksSize.loadAcquire()
+        < m_tasksSizeThreshold.loadAcquire();
+}
+
+bool XThreadPoolPrivate::enqueueNode(XPoolTask_ * const task) {
+    // 与全局队列共用容量,超出时交给全局队列按溢出处理方式处理
+    if (m_nodeTasksSize.fetchAndAddAcquire(1) + m_queuedTasksSize.loadAcquire() >= m_tasksSizeThreshold.loadAcquire()) {
+        m_nodeTasksSize.fetchAndSubRelease(1);
+        return {};
+    }
+    auto const cpu{XCpuTopology_::currentCpu()};
+    auto & node{*m_nodeQueues[(cpu < m_cpuNodes.size() ? m_cpuNodes[cpu] : 0) % m_nodeQueues.size()]};
+    try {
+        std::unique_lock lock(node.m_mtx);
+        node.m_queue.push(task);
+        node.m_size.store(node.m_queue.size(),std::memory_order_release);
+    } catch (...) {
+        m_nodeTasksSize.fetchAndSubRelease(1);
+        return {};
+    }
+    wakeWorker();
+    return true;
+}
+
+XPoolTask_ * XThreadPoolPrivate::takeNodeTask(XWorker_ & worker,XNodeQueue_ & node,bool const batch) {
+    if (!node.m_size.load(std::memory_order_acquire)) { return {}; }
+    std::unique_lock lock(node.m_mtx);
+    if (node.m_queue.empty()) { return {}; }
+    auto const size{node.m_queue.size()};
+    auto const n{batch ? std::min({STEAL_BATCH_SIZE,size,size / std::max<std::size_t>(node.m_workersSize,1) + 1}) : std::size_t{1}};
+    auto const task{node.m_queue.pop()};
+    for (std::size_t i{1}; i < n; ++i) { worker.m_deque.push(node.m_queue.pop()); }
+    node.m_size.store(node.m_queue.size(),std::memory_order_release);
+    lock.unlock();
+    notifyNodeRoom(n);
+    if (n > 1) { wakeWorker(); }
+    return task;
+}
+
+void XThreadPoolPrivate::notifyNodeRoom(std::size_t const taken) {
+    auto const before{m_nodeTasksSize.fetchAndSubOrdered(static_cast<XSize_t>(taken))};
+    if (before + m_queuedTasksSize.loadAcquire() < m_tasksSizeThreshold.loadAcquire()) { return; }
+    // 等待者在m_mtx下检查空位,加锁后通知才不会错过
+    { std::unique_lock lock(m_mtx); }
+    m_taskQueueCond.notify_all();
+}
+
+std::pair<std::size_t,std::span<std::size_t const>> XThreadPoolPrivate::placement(std::size_t const index) const noexcept {
+    if (m_config.m_numaSpread) {
+        if (m_nodes.empty()) { return {}; }
+        auto const node{index % m_nodes.size()};
+        return {node,m_nodes[node]};
+    }
+    if (auto const & cpus{m_config.m_cpus}; !cpus.empty())
+    { return {{},std::span{cpus}.subspan(index % cpus.size(),1)}; }
+    return {};
+}
+
+void XThreadPoolPrivate::run(Tid_t const threadId,XWorker_ * const worker,std::size_t const index) {
+    if (!m_config.m_threadName.empty())
+    { XCpuTopology_::setCurrentThreadName(m_config.m_threadName + "-" + std::to_string(index)); }
+    if (auto const cpus{placement(index).second}; !cpus.empty() && !XCpuTopology_::bindCurrentThread(cpus))
+    { emit(Level_::WARN_LEVEL,Kind_::PLACEMENT_FAILED,index,"bind cpu failed"); }
+    sm_currentWorker_ = worker;
+    auto & stats{m_workerStats.acquire(index)};
+    sm_workerStats_ = std::addressof(stats);
+    auto const timing{timingEnabled()};
+    std::optional<XLockFreeTokens_> tokens{};
+    if (Mode::LOCK_FREE == m_mode) { sm_lockFreeTokens_ = std::addressof(tokens.emplace(this,*m_lockFreeTasks)); }
     while (true){
-        if (const auto task{acquireTask()}){
+        if (const auto task{worker ? acquireStealingTask(*worker) : tokens ? acquireLockFreeTask(*tokens) : acquireTask()}){
+            task->releaseQuota();
+            if (task->expired()) {
+                m_expiredTasksSize.fetchAndAddRelaxed(1);
+                task->discard();
+                continue;
+            }
+            if (task->cancelled()) {
+                m_cancelledTasksSize.fetchAndAddRelaxed(1);
+                task->discard();
+                continue;
+            }
             X_RAII const raii{[&]{
                 m_busyThreadsSize.fetchAndAddRelease(1);
                 m_idleThreadsSize.fetchAndSubRelease(1);
@@ -186,22 +926,46 @@ void XThreadPoolPrivate::run(XSize_t const threadId) {
                 m_busyThreadsSize.fetchAndSubRelease(1);
             }};
 #ifndef UNUSE_STD_THREAD_LOCAL
-            sm_isCurrentTask_ = task.get();
+            sm_isCurrentTask_ = task;
 #else
-            const XThreadLocalStorageConstVoid set(m_isCurrentTask_,task.get());
+            const XThreadLocalStorageConstVoid set(m_isCurrentTask_,task);
 #endif
-            task->call();
+            XCancellationToken::exchangeCurrent_(std::addressof(task->m_token));
+            if (!timing) {
+                task->execute();
+            } else {
+                using namespace std::chrono;
+                // execute后任务节点可能已被释放,先取出需要的字段
+                XTaskTrace trace{task->m_enqueueTime,steady_clock::now(),{},index
+                    ,static_cast<XTaskOptions::Priority>(task->m_priority)};
+                task->execute();
+                trace.m_end = steady_clock::now();
+                auto const runTime{duration_cast<nanoseconds>(trace.m_end - trace.m_start)};
+                if (XTaskTrace::time_point_t{} != trace.m_enqueue)
+                { XWorkerStats_::record(stats.m_wait,stats.m_waitNs,duration_cast<nanoseconds>(trace.m_start - trace.m_enqueue)); }
+                XWorkerStats_::record(stats.m_run,stats.m_runNs,runTime);
+                XWorkerStats_::add(stats.m_busyNs,static_cast<xuint64>(runTime.count()));
+                if (auto const & hook{m_config.m_traceHook}) {
+                    try { hook(trace); } catch (...) {}
+                }
+            }
+            XCancellationToken::exchangeCurrent_({});
+            XWorkerStats_::add(stats.m_tasks);
+            XWorkerStats_::add(stats.m_completed);
         }else{
-            std::cerr << "threadId = " << std::this_thread::get_id() <<" end\n" << std::flush;
+            emit(Level_::DEBUG_LEVEL,Kind_::THREAD_EXITED,index,"worker thread end");
             break;
         }
     }
+    sm_currentWorker_ = {};
+    sm_lockFreeTokens_ = {};
+    sm_workerStats_ = {};
+    XWorkerStatsList_::release(stats);
 
-    {
-        std::unique_lock lock(m_mtx);
-        m_threadsContainer.erase(threadId);
-    }
     m_idleThreadsSize.fetchAndSubRelease(1);
+    // 移出容器后stop可能立即返回并析构线程池,通知须在持锁期间完成,之后不再访问成员
+    std::unique_lock lock(m_mtx);
+    m_threadsContainer.erase(threadId);
     m_exitCond.notify_all();
 }
 
@@ -220,8 +984,43 @@ XSize_t XThreadPool::busyThreadsSize() const noexcept
 XSize_t XThreadPool::currentTasksSize() const noexcept
 { return d_func()->currentTasksSize(); }
 
-XThreadPool::~XThreadPool()
-{ stop(); }
+XSize_t XThreadPool::expiredTasksSize() const noexcept
+{ return d_func()->m_expiredTasksSize.loadAcquire(); }
+
+XSize_t XThreadPool::cancelledTasksSize() const noexcept
+{ return d_func()->m_cancelledTasksSize.loadAcquire(); }
+
+XThreadPoolMetrics XThreadPool::metrics() const {
+    using namespace std::chrono;
+    auto const d{d_func()};
+    XThreadPoolMetrics ret{};
+    ret.m_submitted = static_cast<xuint64>(d->m_submittedTasksSize.loadRelaxed());
+    ret.m_rejected = static_cast<xuint64>(d->m_rejectedTasksSize.loadRelaxed());
+    ret.m_expired = static_cast<xuint64>(d->m_expiredTasksSize.loadRelaxed());
+    ret.m_cancelled = static_cast<xuint64>(d->m_cancelledTasksSize.loadRelaxed());
+    ret.m_queued = static_cast<xuint64>(std::max<XSize_t>(d->m_queuedTasksSize.loadRelaxed() + d->m_nodeTasksSize.loadRelaxed(),0));
+    auto const now{duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count()};
+    d->m_workerStats.forEach([&ret,now](XWorkerStats_ const & stats) {
+        ret.m_completed += stats.m_completed.load(std::memory_order_relaxed);
+        XWorkerStats_::load(stats.m_wait,stats.m_waitNs,ret.m_queueWait);
+        XWorkerStats_::load(stats.m_run,stats.m_runNs,ret.m_runTime);
+        if (!stats.m_inUse.load(std::memory_order_acquire)) { return; }
+        auto const elapsed{now - stats.m_claimedNs.load(std::memory_order_relaxed)};
+        auto const busy{static_cast<double>(stats.m_busyNs.load(std::memory_order_relaxed))};
+        ret.m_workers.push_back({stats.m_index.load(std::memory_order_relaxed)
+            ,stats.m_tasks.load(std::memory_order_relaxed)
+            ,stats.m_steals.load(std::memory_order_relaxed)
+            ,elapsed > 0 ? std::min(busy / static_cast<double>(elapsed),1.0) : 0.0});
+    });
+    std::ranges::sort(ret.m_workers,{},&XWorkerMetrics::m_index);
+    return ret;
+}
+
+XThreadPool::~XThreadPool() {
+    // 定时线程的回调持有this,在工作线程内析构时stop直接返回,须在此无条件结束定时线程
+    if (auto const & timers{d_func()->m_timers}) { timers->shutdown(); }
+    stop();
+}
 
 void XThreadPool::start(XSize_t const threadSize)
 { d_func()->start(threadSize); }
@@ -236,15 +1035,28 @@ void XThreadPool::stop()
     X_D(XThreadPool);
     if (d->m_isPoolRunning.loadAcquire()){ return; }
     d->m_mode = mode;
+    if (Mode::LOCK_FREE == mode && !d->m_lockFreeTasks) { d->m_lockFreeTasks = std::make_unique<XLockFreeQueue_>(); }
 }
 
 [[maybe_unused]] XThreadPool::Mode XThreadPool::getMode() const noexcept
 { return d_func()->m_mode; }
 
+[[maybe_unused]] void XThreadPool::setConfig(XThreadPoolConfig config) noexcept {
+    X_D(XThreadPool);
+    if (d->m_isPoolRunning.loadAcquire()){
+        d->emit(Level_::WARN_LEVEL,Kind_::INVALID_CALL,{},"setConfig must be in a stopped state");
+        return;
+    }
+    d->m_config = std::move(config);
+}
+
+[[maybe_unused]] XThreadPoolConfig const & XThreadPool::getConfig() const noexcept
+{ return d_func()->m_config; }
+
 [[maybe_unused]] void XThreadPool::setThreadsSizeThreshold(XSize_t const num) noexcept {
     X_D(XThreadPool);
     if (d->m_isPoolRunning.loadAcquire()){
-        std::cerr << "setThreadsSizeThreshold Must be in a stopped state\n" << std::flush;
+        d->emit(Level_::WARN_LEVEL,Kind_::INVALID_CALL,{},"setThreadsSizeThreshold must be in a stopped state");
         return;
     }
     d->m_threadsSizeThreshold.storeRelease(num);
@@ -258,7 +1070,7 @@ void XThreadPool::stop()
 [[maybe_unused]] void XThreadPool::setTasksSizeThreshold(XSize_t const num) noexcept {
     X_D(XThreadPool);
     if (d->m_isPoolRunning.loadAcquire()){
-        std::cerr << "setTasksSizeThreshold Must be in a stopped state\n" << std::flush;
+        d->emit(Level_::WARN_LEVEL,Kind_::INVALID_CALL,{},"setTasksSizeThreshold must be in a stopped state");
         return;
     }
     d->m_tasksSizeThreshold.storeRelease(num);
@@ -267,25 +1079,137 @@ void XThreadPool::stop()
 [[maybe_unused]] XSize_t XThreadPool::getTasksSizeThreshold() const noexcept
 { return d_func()->m_tasksSizeThreshold.loadAcquire(); }
 
-XAbstractRunnablePtr XThreadPool::appendHelper(XAbstractRunnablePtr task) {
-    auto retTask{d_func()->append(std::move(task))};
+XAbstractRunnablePtr XThreadPool::appendHelper(XAbstractRunnablePtr task,XTaskOptions const & options) {
+    return submitHelper(std::move(task),options).m_task;
+}
+
+XSubmitResult XThreadPool::submitHelper(XAbstractRunnablePtr task,XTaskOptions const & options) {
+    auto const status{d_func()->append(task,options)};
     start();
-    return retTask;
+    return {status,std::move(task)};
 }
 
-[[maybe_unused]] void XThreadPool::setThreadTimeout(XSize_t const seconds) noexcept {
+XTimer XThreadPool::armTimer_(std::shared_ptr<XTimerNode_> node,std::chrono::steady_clock::time_point const due
+    ,std::chrono::steady_clock::duration const period)
+{
     X_D(XThreadPool);
-    if (d->m_isPoolRunning.loadAcquire()){
-        std::cerr << "setThreadTimeout Must be in a stopped state\n" << std::flush;
-        return;
+    node->m_due = due;
+    node->m_period = period;
+    node->m_wheel = d->m_timers;
+    d->m_timers->arm(node);
+    return XTimer{std::move(node)};
+}
+
+std::vector<XAbstractRunnablePtr> XThreadPool::appendBulkHelper(std::vector<XAbstractRunnablePtr> && tasks) {
+    auto retTasks{d_func()->appendBulk(std::move(tasks))};
+    start();
+    return retTasks;
+}
+
+std::pair<XTaskSlot_ *,void *> XThreadPool::allocateSlot_(std::size_t const size,std::size_t const align
+    ,invoke_t const invoke,destroy_t const destroy,destroy_t const dropResult,bool const retain)
+{
+    X_D(XThreadPool);
+    auto const slot{d->m_taskSlab->acquire()};
+    if (!slot) {
+        d->reject();
+        d->emit(Level_::ERROR_LEVEL,Kind_::TASK_REJECTED,1,"task slot allocation failed");
+        return {};
+    }
+    if (auto const storage{slot->bind(size,align,invoke,destroy,dropResult,retain)}) { return {slot,storage}; }
+    d->reject();
+    d->emit(Level_::ERROR_LEVEL,Kind_::TASK_REJECTED,1,"task storage allocation failed");
+    d->m_taskSlab->release(slot);
+    return {};
+}
+
+bool XThreadPool::submitSlot_(XTaskSlot_ * const slot,XTaskOptions const & options) {
+    slot->m_priority = static_cast<xuint32>(options.m_priority);
+    slot->m_deadline = options.m_deadline;
+    slot->m_token = options.m_token;
+    auto const status{d_func()->enqueue(slot,options)};
+    start();
+    return XSubmitStatus::ACCEPTED == status || XSubmitStatus::RAN_IN_CALLER == status;
+}
+
+XFuture<void> XThreadPool::whenAllHelper_(std::span<XReadyFlag_ const * const> const flags) {
+
+    struct XWhenAll_ final {
+        std::atomic_size_t m_remaining{};
+        XPromise<void> m_promise{};
+    };
+
+    auto const state{std::make_shared<XWhenAll_>()};
+    auto ret{state->m_promise.getFuture()};
+    // 多计一次,保证注册过程中不会提前就绪
+    state->m_remaining.store(flags.size() + 1,std::memory_order_relaxed);
+
+    auto const done{[state]() noexcept {
+        if (1 == state->m_remaining.fetch_sub(1,std::memory_order_acq_rel)) { state->m_promise.setValue(); }
+    }};
+
+    for (auto const flag : flags) {
+        if (flag) { flag->onReady(done); } else { done(); }
+    }
+    done();
+    return ret;
+}
+
+XFuture<std::size_t> XThreadPool::whenAnyHelper_(std::span<XReadyFlag_ const * const> const flags) {
+
+    struct XWhenAny_ final {
+        std::atomic_bool m_done{};
+        XPromise<std::size_t> m_promise{};
+    };
+
+    auto const state{std::make_shared<XWhenAny_>()};
+    auto ret{state->m_promise.getFuture()};
+
+    for (std::size_t i{}; i < flags.size(); ++i) {
+        auto const done{[state,i]() noexcept {
+            if (!state->m_done.exchange(true,std::memory_order_acq_rel)) { state->m_promise.setValue(i); }
+        }};
+        if (flags[i]) { flags[i]->onReady(done); } else { done(); }
+        if (state->m_done.load(std::memory_order_acquire)) { break; }
     }
+    return ret;
+}
+
+bool XThreadPool::XScheduleAwaiter_::await_suspend(std::coroutine_handle<> const handle) const
+{ return m_pool_->runnableJoinDetached([handle]{ handle.resume(); }); }
+
+void * XCoroutineFrame_::allocate(std::size_t const size,XThreadPool const * const pool) {
+    if (!pool) {
+        // 在工作线程中创建的协程使用所在线程池的分配器
+        if (auto const worker{sm_currentWorker_}) { return worker->m_pool->m_frameAllocator->allocate(size); }
+        return XFrameAllocator_::allocateDefault(size);
+    }
+    return pool->d_func()->m_frameAllocator->allocate(size);
+}
+
+void XCoroutineFrame_::deallocate(void * const frame) noexcept
+{ XFrameAllocator_::deallocate(frame); }
+
+[[maybe_unused]] void XThreadPool::setThreadTimeout(XSize_t const seconds) noexcept {
+    X_D(XThreadPool);
     if (seconds > 0){
         d->m_threadTimeout.storeRelease(seconds);
     } else{
-        std::cerr << "setThreadTimeout Cannot be negative,set failed!\n" << std::flush;
+        d->emit(Level_::WARN_LEVEL,Kind_::INVALID_CALL,static_cast<xuint64>(seconds),"setThreadTimeout must be positive");
     }
 }
 
+[[maybe_unused]] void XThreadPool::setElasticConfig(XElasticConfig const & config) noexcept {
+    X_D(XThreadPool);
+    std::unique_lock lock(d->m_mtx);
+    d->m_elastic = config;
+}
+
+[[maybe_unused]] XElasticConfig XThreadPool::elasticConfig() const noexcept {
+    std::unique_lock lock(d_func()->m_mtx);
+    return d_func()->m_elastic;
+}
+
 XThreadPoolPtr XThreadPool::create(Mode const mode) noexcept {
     auto ret{ CreateSharedPtr() };
     CHECK_EMPTY(ret);
@@ -293,11 +1217,26 @@ XThreadPoolPtr XThreadPool::create(Mode const mode) noexcept {
     return ret;
 }
 
+XThreadPoolPtr XThreadPool::create(Mode const mode,XThreadPoolConfig config) noexcept {
+    auto ret{ create(mode) };
+    CHECK_EMPTY(ret);
+    ret->setConfig(std::move(config));
+    return ret;
+}
+
 XThreadPool::XThreadPool() = default;
 
 bool XThreadPool::construct_() {
+    static constinit std::atomic<xuint64> sm_nextId_{1};
     auto dd{ makeUnique<XThreadPoolPrivate>() };
     CHECK_EMPTY(dd);
+    dd->m_id = sm_nextId_.fetch_add(1,std::memory_order_relaxed);
+    // 定时线程在stop与析构开始时结束,之后不会再访问this
+    dd->m_timers = std::make_shared<XTimerWheel_>([this](std::shared_ptr<XTimerNode_> node) {
+        XTaskOptions options{};
+        options.m_overflow = XTaskOptions::Overflow::FAIL_FAST;
+        static_cast<void>(runnableJoinDetached(options,[node = std::move(node)]{ node->fire(); }));
+    });
     m_d_ptr_ = std::move(dd);
     return true;
 }
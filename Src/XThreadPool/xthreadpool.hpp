@@ -2,9 +2,25 @@
 #define X_THREADPOOL2_HPP
 
 #include <XThreadPool/xrunnable.hpp>
+#include <XThreadPool/xtaskresult.hpp>
+#include <XThreadPool/xcancellation.hpp>
+#include <XThreadPool/xtimer.hpp>
 #include <XHelper/xtypetraits.hpp>
 #include <XHelper/xcallablehelper.hpp>
 #include <XMemory/xmemory.hpp>
+#include <vector>
+#include <ranges>
+#include <new>
+#include <algorithm>
+#include <array>
+#include <span>
+#include <tuple>
+#include <coroutine>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cmath>
 
 XTD_NAMESPACE_BEGIN
 XTD_INLINE_NAMESPACE_BEGIN(v1)
@@ -19,8 +35,219 @@ using XUSize_t = xuint32;
 
 class XThreadPool;
 class XThreadPoolPrivate;
+class XTaskSlot_;
+class XCoroutineFrame_;
+template<typename> class XTask;
 using XThreadPoolPtr = std::shared_ptr<XThreadPool>;
 
+/**
+ * 加入任务时的调度选项
+ * 共享队列按优先级出队,并按等待长度老化,低优先级任务不会被饿死
+ * 截止时间已过且尚未开始执行的任务不再执行,按加入失败处理,
+ * 等待结果的调用者得到空返回值或std::future_errc::broken_promise
+ * 令牌已取消的任务同样不再执行,加入时已取消则直接返回CANCELLED
+ */
+struct XTaskOptions final {
+    enum class Priority : xuint32 { LOW,NORMAL,HIGH,CRITICAL };
+
+    /// 任务队列已满时的处理方式
+    enum class Overflow : xuint32 {
+        DEFAULT, /*使用XThreadPoolConfig::m_overflow*/
+        BLOCK, /*等待空位至多m_blockTimeout,超时后拒绝*/
+        FAIL_FAST, /*立即拒绝*/
+        CALLER_RUNS, /*在调用线程立即执行*/
+        DROP_OLDEST /*丢弃最早排队的任务(按加入失败处理),腾出空位*/
+    };
+
+    using time_point_t = std::chrono::steady_clock::time_point;
+
+    Priority m_priority{Priority::NORMAL};
+    time_point_t m_deadline{time_point_t::max()};
+    Overflow m_overflow{Overflow::DEFAULT};
+    /// BLOCK的最长等待时间,负值使用XThreadPoolConfig::m_blockTimeout
+    std::chrono::microseconds m_blockTimeout{-1};
+    /// 取消令牌,默认永远不会被取消
+    XCancellationToken m_token{};
+
+    /// @return 以rel_time后为截止时间的选项
+    template<typename Rep_,typename Period_>
+    [[nodiscard]] static XTaskOptions within(std::chrono::duration<Rep_,Period_> const & rel_time
+        ,Priority const priority = Priority::NORMAL) noexcept
+    { return {priority,std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(rel_time)}; }
+};
+
+/**
+ * 加入任务的结果
+ */
+enum class XSubmitStatus : xuint32 {
+    ACCEPTED, /*已进入队列*/
+    RAN_IN_CALLER, /*队列已满,按CALLER_RUNS在调用线程执行完毕*/
+    QUEUE_FULL, /*队列已满,任务未加入*/
+    QUOTA_EXCEEDED, /*提交线程的排队任务数达到XThreadPoolConfig::m_producerQuota*/
+    INVALID_TASK, /*空任务、任务内加入自身、已加入其他线程池*/
+    ALLOCATION_FAILED, /*内存分配失败*/
+    CANCELLED /*加入时令牌已被取消*/
+};
+
+/**
+ * tryRunnableJoin的返回值,任务未加入时m_task仍然有效,等待其结果会得到空返回值
+ */
+struct XSubmitResult final {
+    XSubmitStatus m_status{};
+    XAbstractRunnablePtr m_task{};
+
+    /// @return 任务已进入队列或已执行
+    [[nodiscard]] explicit operator bool() const noexcept
+    { return XSubmitStatus::ACCEPTED == m_status || XSubmitStatus::RAN_IN_CALLER == m_status; }
+};
+
+/**
+ * 单个任务的跟踪记录,由XThreadPoolConfig::m_traceHook在任务结束后于工作线程内接收
+ * m_enqueue为进入队列的时间,m_start与m_end为开始与结束执行的时间
+ */
+struct XTaskTrace final {
+    using time_point_t = std::chrono::steady_clock::time_point;
+    time_point_t m_enqueue{},m_start{},m_end{};
+    /// 执行任务的工作线程序号
+    std::size_t m_worker{};
+    XTaskOptions::Priority m_priority{};
+};
+
+/**
+ * 按2的幂划分的耗时直方图,第0个桶统计小于1微秒,第i个桶统计[2^(i-1),2^i)微秒,最后一个桶包含更大的值
+ */
+struct XLatencyHistogram final {
+    static constexpr std::size_t BucketsSize{32};
+    std::array<xuint64,BucketsSize> m_buckets{};
+    xuint64 m_count{};
+    std::chrono::nanoseconds m_total{};
+
+    /// @return 不小于p(0~1)分位数的桶上界,没有样本时返回0
+    [[nodiscard]] std::chrono::microseconds percentile(double const p) const noexcept {
+        if (!m_count) { return {}; }
+        auto const rank{std::max<xuint64>(static_cast<xuint64>(std::ceil(p * static_cast<double>(m_count))),1)};
+        xuint64 seen{};
+        for (std::size_t i{}; i < BucketsSize; ++i) {
+            if ((seen += m_buckets[i]) >= rank) { return std::chrono::microseconds{xint64{1} << i}; }
+        }
+        return std::chrono::microseconds{xint64{1} << (BucketsSize - 1)};
+    }
+
+    /// @return 平均耗时,没有样本时返回0
+    [[nodiscard]] std::chrono::nanoseconds mean() const noexcept
+    { return m_count ? m_total / static_cast<std::chrono::nanoseconds::rep>(m_count) : std::chrono::nanoseconds{}; }
+};
+
+/// 单个存活工作线程的统计
+struct XWorkerMetrics final {
+    /// 工作线程序号,与线程名后缀一致
+    std::size_t m_index{};
+    /// 本线程执行的任务数
+    xuint64 m_tasks{};
+    /// 从其他工作线程窃取的任务数,只在WORK_STEALING模式下统计
+    xuint64 m_steals{};
+    /// 线程启动以来执行任务的时间占比,未开启计时为0
+    double m_busyRatio{};
+};
+
+/**
+ * XThreadPool::metrics返回的快照,各项分别无锁读取,彼此之间不保证严格一致
+ * 计数从线程池创建开始累计,m_submitted包含被拒绝的任务
+ * 直方图与m_busyRatio需要XThreadPoolConfig::m_collectTimings或m_traceHook
+ */
+struct XThreadPoolMetrics final {
+    xuint64 m_submitted{},m_completed{},m_rejected{},m_expired{},m_cancelled{};
+    /// 共享队列(LOCK_FREE模式为无锁队列)中的任务数,不包含工作线程的本地队列
+    xuint64 m_queued{};
+    XLatencyHistogram m_queueWait{},m_runTime{};
+    std::vector<XWorkerMetrics> m_workers{};
+};
+
+/**
+ * 线程池的诊断事件,由XThreadPoolConfig::m_eventSink接收
+ * 线程池不再直接写控制台,没有设置接收者时不构造消息
+ * m_message只在回调期间有效
+ */
+struct X_CLASS_EXPORT XPoolEvent final {
+    /// 使用_LEVEL后缀避免与系统平台宏冲突
+    enum class Level : xuint32 { DEBUG_LEVEL,INFO_LEVEL,WARN_LEVEL,ERROR_LEVEL };
+
+    enum class Kind : xuint32 {
+        POOL_STARTED, /*线程池启动,m_value为初始线程数*/
+        THREADS_GROWN, /*CACHE模式扩容,m_value为新增线程数*/
+        THREAD_RETIRED, /*CACHE模式线程空闲超时退出,m_value为超时秒数*/
+        THREAD_EXITED, /*工作线程结束,m_value为线程序号*/
+        TASK_REJECTED, /*队列已满或内存分配失败,任务未加入,m_value为任务数*/
+        INVALID_TASK, /*空任务、任务内加入自身、已加入其他线程池*/
+        INVALID_CALL, /*状态或线程不允许的调用,如运行中修改配置、工作线程内stop*/
+        LIMIT_REACHED, /*请求的线程数超过上限,m_value为实际值*/
+        PLACEMENT_FAILED /*NUMA放置、CPU绑定或线程栈大小未生效*/
+    };
+
+    Level m_level{};
+    Kind m_kind{};
+    xuint64 m_value{};
+    std::string_view m_message{};
+
+    /// 写到std::cerr的接收者,用于调试
+    static void toConsole(XPoolEvent const & event);
+};
+
+/**
+ * 工作线程的放置与属性,线程池启动前设置
+ */
+struct XThreadPoolConfig final {
+    /// 允许使用的CPU编号,为空表示不限制
+    /// 不启用m_numaSpread时,第i个线程绑定到m_cpus[i % m_cpus.size()]
+    std::vector<std::size_t> m_cpus{};
+    /// 按NUMA节点轮流放置线程,线程绑定到所在节点的全部CPU(与m_cpus取交集)
+    /// WORK_STEALING模式下每个节点有独立的注入队列,外部线程提交的NORMAL及LOW任务进入提交线程所在节点的队列,
+    /// 工作线程先取本节点队列与同节点线程的任务,再取其他节点的;HIGH及以上任务仍进入全局队列
+    bool m_numaSpread{};
+    /// 线程名前缀,实际名称为"前缀-序号",Linux下超过15个字符的部分被截断,为空不设置
+    std::string m_threadName{};
+    /// 线程栈大小(字节),0使用系统默认值,只在POSIX平台有效
+    std::size_t m_stackSize{};
+    /// 空闲线程先自旋(pause)检查m_spinCount次,再让出时间片m_yieldCount次,仍无任务才休眠
+    /// 调大可降低微秒级任务的唤醒延迟,代价是空闲时的CPU占用
+    /// 单核机器上不自旋
+    xuint32 m_spinCount{256};
+    xuint32 m_yieldCount{8};
+    /// 记录排队时间与执行时间,每个任务增加约三次时钟读取
+    bool m_collectTimings{};
+    /// 每个任务结束后在工作线程内调用,不能阻塞,抛出的异常被忽略,设置后同时开启计时
+    std::function<void(XTaskTrace const &)> m_traceHook{};
+    /// 队列已满时的默认处理方式,DEFAULT按BLOCK处理
+    /// 不带选项的runnableJoinDetached/runnableJoinTyped与runnableJoinBulk等加入方式总是使用该值
+    XTaskOptions::Overflow m_overflow{XTaskOptions::Overflow::BLOCK};
+    std::chrono::microseconds m_blockTimeout{std::chrono::seconds{1}};
+    /// 每个提交线程同时在队列中的任务数上限,超出时直接拒绝,0不限制
+    std::size_t m_producerQuota{};
+    /// 诊断事件接收者,为空时不产生任何诊断输出,被拒绝的任务数见XThreadPool::metrics
+    /// 可能在任意线程内调用,不能阻塞,抛出的异常被忽略
+    std::function<void(XPoolEvent const &)> m_eventSink{};
+    /// 低于该级别的事件不发送
+    XPoolEvent::Level m_eventLevel{XPoolEvent::Level::WARN_LEVEL};
+};
+
+/**
+ * CACHE模式的弹性伸缩参数,运行中可随时修改
+ * 扩容: 排队任务多于空闲线程,且最早排队的任务等待超过m_targetLatency或忙线程比例达到m_targetUtilization时,
+ *       等待时间是目标的n倍(n > 1)则增加当前线程数的(n - 1)倍,否则增加1个,每次至多m_maxGrowStep个,
+ *       两次扩容至少间隔m_growInterval
+ * 缩容: 线程空闲超过setThreadTimeout设置的时间才退出,线程数不低于m_minThreads,
+ *       最近一次扩容后m_shrinkDelay内不退出,两次退出至少间隔m_shrinkInterval
+ */
+struct XElasticConfig final {
+    std::chrono::microseconds m_targetLatency{std::chrono::milliseconds{1}};
+    double m_targetUtilization{0.9};
+    xuint32 m_maxGrowStep{4};
+    std::chrono::microseconds m_growInterval{std::chrono::milliseconds{1}};
+    std::size_t m_minThreads{};
+    std::chrono::milliseconds m_shrinkDelay{std::chrono::seconds{5}};
+    std::chrono::milliseconds m_shrinkInterval{100};
+};
+
 class X_CLASS_EXPORT XThreadPoolData {
     X_DISABLE_COPY_MOVE(XThreadPoolData)
 public:
@@ -47,15 +274,39 @@ class X_CLASS_EXPORT XThreadPool final
         enum class Private_{};
         friend struct XTemporaryTasksFactory;
         using invoker_t = Invoker<Args...>;
+        using result_t = std::decay_t<typename invoker_t::result_t>;
         mutable invoker_t m_invoker_{};
+        /// 返回值直接写入类型化结果,与任务对象同一次分配
+        mutable XFutureState_<result_t> m_state_{};
+
         constexpr std::any run() const override {
-            if constexpr (std::is_void_v<typename invoker_t::result_t>) {
-                m_invoker_();
-                return {};
-            }else {
-                return m_invoker_();
+            try {
+                if constexpr (std::is_void_v<result_t>) {
+                    m_invoker_();
+                    m_state_.setValue();
+                }else {
+                    m_state_.setValue(m_invoker_());
+                }
+            } catch (...) {
+                m_state_.setException(std::current_exception());
+                throw;
             }
+            return {};
         }
+
+        std::shared_ptr<void> typedState_(std::type_info const & type) const noexcept override {
+            if (typeid(result_t) != type) { return {}; }
+            return {shared_from_this(),std::addressof(m_state_)};
+        }
+
+        void resetTypedState_() const noexcept override
+        { if (m_state_.flag().isReady()) { m_state_.reset(); } }
+
+        void abandonTypedState_() const noexcept override {
+            if (!m_state_.flag().isReady())
+            { m_state_.setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise))); }
+        }
+
     public:
         explicit constexpr XTemporaryTasks(Private_,Args && ...args)
             : m_invoker_{ XCallableHelper::createInvoker(std::forward<Args>(args)...)  }
@@ -73,7 +324,12 @@ class X_CLASS_EXPORT XThreadPool final
     };
 
 public:
-    enum class Mode {FIXED,/*固定线程数模式*/CACHE /*动态线程数*/};
+    enum class Mode {
+        FIXED,/*固定线程数模式*/
+        CACHE, /*动态线程数*/
+        WORK_STEALING, /*固定线程数,每个线程拥有无锁本地队列,外部提交进入注入队列,空闲线程相互窃取*/
+        LOCK_FREE /*固定线程数,任务队列为无锁MPMC队列,提交与分发均不加锁,按提交线程FIFO,不区分优先级*/
+    };
 
     /// @return 返回CPU线程数量
     static unsigned cpuThreadsCount();
@@ -96,8 +352,40 @@ public:
     /// @tparam Args
     /// @param args
     /// @return task对象
+    template<typename... Args> requires (!std::is_same_v<std::remove_cvref_t<std::tuple_element_t<0,std::tuple<Args...,void>>>,XTaskOptions>)
+    [[maybe_unused]] constexpr auto runnableJoin(Args && ...args)
+    { return runnableJoin(XTaskOptions{},std::forward<Args>(args)...); }
+
+    /// 尝试加入任务,队列已满时立即返回而不等待
+    /// options.m_overflow为DEFAULT时按FAIL_FAST处理,也可以指定其他处理方式以获得加入结果
+    /// @tparam Args
+    /// @param options
+    /// @param args
+    /// @return 加入结果与task对象
     template<typename... Args>
-    [[maybe_unused]] constexpr auto runnableJoin(Args && ...args) {
+    [[maybe_unused]] XSubmitResult tryRunnableJoin(XTaskOptions options,Args && ...args) {
+        if (XTaskOptions::Overflow::DEFAULT == options.m_overflow) { options.m_overflow = XTaskOptions::Overflow::FAIL_FAST; }
+        using First_t [[maybe_unused]] = std::tuple_element_t<0,std::tuple<Args...>>;
+        if constexpr (is_smart_pointer_v<std::decay_t<First_t>>) {
+            return submitHelper(std::forward<Args>(args)...,options);
+        } else {
+            return submitHelper(XTemporaryTasksFactory::create(std::forward<Args>(args)...),options);
+        }
+    }
+
+    /// 以默认选项尝试加入任务,队列已满时立即返回
+    template<typename... Args> requires (!std::is_same_v<std::remove_cvref_t<std::tuple_element_t<0,std::tuple<Args...,void>>>,XTaskOptions>)
+    [[maybe_unused]] XSubmitResult tryRunnableJoin(Args && ...args)
+    { return tryRunnableJoin(XTaskOptions{},std::forward<Args>(args)...); }
+
+    /// 带调度选项加入任务,其余与runnableJoin相同
+    /// WORK_STEALING模式下非默认优先级的任务总是进入共享队列,工作线程优先处理其中的高优先级任务
+    /// @tparam Args
+    /// @param options 优先级与截止时间
+    /// @param args
+    /// @return task对象
+    template<typename... Args>
+    [[maybe_unused]] constexpr auto runnableJoin(XTaskOptions const & options,Args && ...args) {
 
         using First_t [[maybe_unused]] = std::tuple_element_t<0,std::tuple<Args...>>;
 
@@ -107,12 +395,264 @@ public:
 
             static_assert(std::is_base_of_v<XAbstractRunnable,Derived_t>,"Derived_t no base of XAbstractTask2");
 
-            return appendHelper(std::forward<Args>(args)...);
+            return appendHelper(std::forward<Args>(args)...,options);
         }else{
-            return appendHelper(XTemporaryTasksFactory::create(std::forward<Args>(args)...));
+            return appendHelper(XTemporaryTasksFactory::create(std::forward<Args>(args)...),options);
+        }
+    }
+
+    /// 批量加入任务,整批只加锁一次、只做一次容量检查、只唤醒一次
+    /// 元素可以是XAbstractRunnable派生类的智能指针,也可以是无参可调用对象
+    /// 超出任务数阈值的部分不会加入线程池,仍按原顺序返回,可以再次加入
+    /// @tparam Range
+    /// @param range
+    /// @return 与range顺序一致的task对象
+    template<std::ranges::input_range Range>
+    [[maybe_unused]] auto runnableJoinBulk(Range && range) {
+
+        using Value_t = std::remove_cvref_t<std::ranges::range_reference_t<Range>>;
+
+        std::vector<XAbstractRunnablePtr> tasks{};
+        if constexpr (std::ranges::sized_range<Range>)
+        { tasks.reserve(static_cast<std::size_t>(std::ranges::size(range))); }
+
+        for (auto && item : range) {
+            if constexpr (is_smart_pointer_v<Value_t>) {
+                using Derived_t = std::decay_t<decltype(std::declval<Value_t>().operator*())>;
+                static_assert(std::is_base_of_v<XAbstractRunnable,Derived_t>,"Derived_t no base of XAbstractRunnable");
+                tasks.emplace_back(std::forward<decltype(item)>(item));
+            } else {
+                tasks.emplace_back(XTemporaryTasksFactory::create(std::forward<decltype(item)>(item)));
+            }
         }
+        return appendBulkHelper(std::move(tasks));
     }
 
+    /// 批量加入count个相同的任务,fn可以接收任务序号[0,count),也可以无参
+    /// 其余行为与runnableJoinBulk相同
+    /// @tparam Fn
+    /// @param fn
+    /// @param count
+    /// @return 按序号排列的task对象
+    template<typename Fn>
+    [[maybe_unused]] auto runnableJoinN(Fn && fn,XSize_t const count) {
+        std::vector<XAbstractRunnablePtr> tasks{};
+        tasks.reserve(static_cast<std::size_t>(count > 0 ? count : 0));
+        for (XSize_t i{}; i < count; ++i) {
+            if constexpr (std::is_invocable_v<std::decay_t<Fn> &,XSize_t>) {
+                tasks.emplace_back(XTemporaryTasksFactory::create(fn,i));
+            } else {
+                tasks.emplace_back(XTemporaryTasksFactory::create(fn));
+            }
+        }
+        return appendBulkHelper(std::move(tasks));
+    }
+
+    /// 以"发后即忘"方式加入任务,不创建task对象,也不保存返回值
+    /// 可调用对象直接构造在线程池预分配的任务槽中,不超过64字节的可调用对象在稳态下不产生堆分配
+    /// 任务抛出的异常会被捕获并输出,不会传播到调用者
+    /// 支持的可调用对象与runnableJoin相同
+    /// @tparam Args
+    /// @param args
+    /// @return 是否成功加入
+    template<typename... Args> requires (!std::is_same_v<std::remove_cvref_t<std::tuple_element_t<0,std::tuple<Args...,void>>>,XTaskOptions>)
+    [[maybe_unused]] bool runnableJoinDetached(Args && ...args)
+    { return runnableJoinDetached(XTaskOptions{},std::forward<Args>(args)...); }
+
+    /// 带调度选项以"发后即忘"方式加入任务,其余与runnableJoinDetached相同
+    /// 可调用对象内通过XCancellationToken::current()检查取消
+    /// @tparam Args
+    /// @param options 优先级、截止时间、取消令牌与队列已满时的处理方式
+    /// @param args
+    /// @return 是否成功加入
+    template<typename... Args>
+    [[maybe_unused]] bool runnableJoinDetached(XTaskOptions const & options,Args && ...args) {
+        using invoker_t = Invoker<Args...>;
+        auto const [slot,storage]{ allocateSlot_(sizeof(invoker_t),alignof(invoker_t)
+            ,&slotInvoke_<invoker_t,void>,&slotDestroy_<invoker_t>,{},{}) };
+        if (!slot) { return {}; }
+        ::new (storage) invoker_t(XCallableHelper::createInvoker(std::forward<Args>(args)...));
+        return submitSlot_(slot,options);
+    }
+
+    /// 加入任务并返回类型化结果,与runnableJoinDetached一样使用任务槽
+    /// 返回值直接构造在任务槽中,不经过std::any,稳态下提交与取值均不产生堆分配
+    /// 可调用对象与返回值共用槽内存储,两者中较大者不超过64字节时不需要单独分配
+    /// 加入失败时返回的结果在get时抛出std::future_error
+    /// @tparam Args
+    /// @param args
+    /// @return XTaskResult<返回值类型>
+    template<typename... Args> requires (!std::is_same_v<std::remove_cvref_t<std::tuple_element_t<0,std::tuple<Args...,void>>>,XTaskOptions>)
+    [[maybe_unused]] auto runnableJoinTyped(Args && ...args)
+    { return runnableJoinTyped(XTaskOptions{},std::forward<Args>(args)...); }
+
+    /// 带调度选项加入任务并返回类型化结果,其余与runnableJoinTyped相同
+    /// 令牌取消后未开始执行的任务不再执行,结果在get时抛出std::future_error
+    /// @tparam Args
+    /// @param options
+    /// @param args
+    /// @return XTaskResult<返回值类型>
+    template<typename... Args>
+    [[maybe_unused]] auto runnableJoinTyped(XTaskOptions const & options,Args && ...args) {
+        using invoker_t = Invoker<Args...>;
+        using result_t = std::decay_t<typename invoker_t::result_t>;
+        using storage_t = std::conditional_t<std::is_void_v<result_t>,invoker_t,result_t>;
+        destroy_t dropResult{};
+        if constexpr (!std::is_void_v<result_t>) { dropResult = &slotDestroy_<result_t>; }
+        auto const [slot,storage]{ allocateSlot_(std::max(sizeof(invoker_t),sizeof(storage_t))
+            ,std::max(alignof(invoker_t),alignof(storage_t))
+            ,&slotInvoke_<invoker_t,result_t>,&slotDestroy_<invoker_t>,dropResult,true) };
+        if (!slot) { return XTaskResult<result_t>{}; }
+        ::new (storage) invoker_t(XCallableHelper::createInvoker(std::forward<Args>(args)...));
+        XTaskResult<result_t> ret{slot};
+        submitSlot_(slot,options);
+        return ret;
+    }
+
+    /// 源结束后把fn加入本线程池执行,不阻塞任何线程
+    /// 源是XFuture<T>时fn接收T const &(T为void时无参),源抛出的异常直接传递给返回值,fn不会执行
+    /// 源是task对象时fn可以接收task对象,也可以无参,task被再次加入线程池后不会重复触发
+    /// 线程池已析构或任务加入失败时,返回值在get时抛出std::future_error
+    /// 延续任务使用token,没有指定时依次继承源task的令牌、当前线程正在执行的任务的令牌,
+    /// 因此在任务内建立的延续链随该任务一起取消,令牌已取消时fn不再执行,返回值同样抛出std::future_error
+    /// @tparam Source
+    /// @tparam Fn
+    /// @param source XFuture<T>或task对象
+    /// @param fn
+    /// @param token 取消令牌
+    /// @return XFuture<fn的返回值类型>
+    template<typename Source,typename Fn>
+    [[maybe_unused]] auto then(Source const & source,Fn && fn,XCancellationToken token = {}) {
+        using source_t = std::conditional_t<is_smart_pointer_v<Source>,XAbstractRunnablePtr,Source>;
+        using args_helper_t = XContinuationArgs_<source_t,std::decay_t<Fn>>;
+        using result_t = std::decay_t<decltype(std::apply(fn,std::declval<typename args_helper_t::type>()))>;
+        XPromise<result_t> promise{};
+        auto ret{promise.getFuture()};
+        auto const flag{readyFlagOf_(source)};
+        if (!flag) { return ret; }
+        if (!token.canBeCancelled()) {
+            if constexpr (is_smart_pointer_v<Source>) { token = source->cancellationToken(); }
+            if (!token.canBeCancelled()) { token = XCancellationToken::current(); }
+        }
+        XTaskOptions options{};
+        options.m_token = std::move(token);
+        flag->onReady([weak = weak_from_this(),source = source_t{source},promise = std::move(promise)
+            ,fn = std::decay_t<Fn>(std::forward<Fn>(fn)),options = std::move(options)]() mutable noexcept {
+            auto const pool{weak.lock()};
+            if (!pool || options.m_token.isCancelled()) { return; }
+            // 任务加入失败时闭包被销毁,promise随之设置broken_promise
+            static_cast<void>(pool->runnableJoinDetached(options,[source = std::move(source),promise = std::move(promise)
+                ,fn = std::move(fn)]() mutable {
+                try {
+                    if constexpr (std::is_void_v<result_t>) {
+                        std::apply(fn,args_helper_t::get(source));
+                        promise.setValue();
+                    } else {
+                        promise.setValue(std::apply(fn,args_helper_t::get(source)));
+                    }
+                } catch (...) { promise.setException(std::current_exception()); }
+            }));
+        });
+        return ret;
+    }
+
+    /// delay后在线程池中执行fn一次
+    /// 定时器由线程池共用的分层时间轮管理,精度为1毫秒,挂入与取消均为O(1),只有一个定时线程,等待期间不占用工作线程
+    /// 到期时以FAIL_FAST加入线程池,队列已满时本次触发被丢弃,stop会丢弃全部定时器
+    /// @tparam Rep
+    /// @tparam Period
+    /// @tparam Fn 无参可调用对象
+    /// @param delay
+    /// @param fn
+    /// @return 定时器句柄,可用于取消
+    template<typename Rep,typename Period,typename Fn>
+    [[maybe_unused]] XTimer runAfter(std::chrono::duration<Rep,Period> const & delay,Fn && fn) {
+        return armTimer_(std::make_shared<XTimerNodeImpl_<std::decay_t<Fn>>>(std::forward<Fn>(fn))
+            ,std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(delay),{});
+    }
+
+    /// 在tp时刻执行fn一次,其余与runAfter相同
+    /// 非steady_clock的时刻按调用时与steady_clock的差值换算,之后调整系统时间不影响触发时刻
+    template<typename Clock,typename Duration,typename Fn>
+    [[maybe_unused]] XTimer runAt(std::chrono::time_point<Clock,Duration> const & tp,Fn && fn) {
+        using namespace std::chrono;
+        steady_clock::time_point due{};
+        if constexpr (std::is_same_v<Clock,steady_clock>) { due = time_point_cast<steady_clock::duration>(tp); }
+        else { due = steady_clock::now() + ceil<steady_clock::duration>(tp - Clock::now()); }
+        return armTimer_(std::make_shared<XTimerNodeImpl_<std::decay_t<Fn>>>(std::forward<Fn>(fn)),due,{});
+    }
+
+    /// 从现在起每隔period执行fn一次,固定频率,错过的触发不补
+    /// 上一次触发仍在执行时跳过本次触发,同一定时器的fn不会并发执行
+    /// 其余与runAfter相同
+    template<typename Rep,typename Period,typename Fn>
+    [[maybe_unused]] XTimer runEvery(std::chrono::duration<Rep,Period> const & period,Fn && fn) {
+        using namespace std::chrono;
+        auto const interval{std::max<steady_clock::duration>(ceil<steady_clock::duration>(period),milliseconds{1})};
+        return armTimer_(std::make_shared<XTimerNodeImpl_<std::decay_t<Fn>>>(std::forward<Fn>(fn))
+            ,steady_clock::now() + interval,interval);
+    }
+
+    /// 全部源结束后就绪,不传递源的返回值和异常,需要时从各自的XFuture读取
+    /// 在最后一个结束的源所在线程直接设置,不占用线程池
+    /// @tparam Sources XFuture<T>或task对象
+    /// @param sources
+    /// @return XFuture<void>
+    template<typename... Sources> requires (!std::ranges::range<Sources> && ...)
+    [[maybe_unused]] static XFuture<void> whenAll(Sources const & ...sources) {
+        auto const flags{std::to_array<XReadyFlag_ const *>({readyFlagOf_(sources)...})};
+        return whenAllHelper_(flags);
+    }
+
+    /// 范围版本的whenAll
+    template<std::ranges::input_range Range>
+    [[maybe_unused]] static XFuture<void> whenAll(Range const & range) {
+        std::vector<XReadyFlag_ const *> flags{};
+        for (auto const & source : range) { flags.push_back(readyFlagOf_(source)); }
+        return whenAllHelper_(flags);
+    }
+
+    /// 任意一个源结束后就绪,值为最先结束的源的序号
+    /// @tparam Sources XFuture<T>或task对象
+    /// @param sources
+    /// @return XFuture<std::size_t>
+    template<typename... Sources> requires (!std::ranges::range<Sources> && ...)
+    [[maybe_unused]] static XFuture<std::size_t> whenAny(Sources const & ...sources) {
+        auto const flags{std::to_array<XReadyFlag_ const *>({readyFlagOf_(sources)...})};
+        return whenAnyHelper_(flags);
+    }
+
+    /// 范围版本的whenAny
+    template<std::ranges::input_range Range>
+    [[maybe_unused]] static XFuture<std::size_t> whenAny(Range const & range) {
+        std::vector<XReadyFlag_ const *> flags{};
+        for (auto const & source : range) { flags.push_back(readyFlagOf_(source)); }
+        return whenAnyHelper_(flags);
+    }
+
+    class XScheduleAwaiter_ final {
+        XThreadPool * m_pool_{};
+    public:
+        explicit constexpr XScheduleAwaiter_(XThreadPool * const pool) noexcept : m_pool_{pool} {}
+        [[nodiscard]] static constexpr bool await_ready() noexcept { return {}; }
+        /// 加入失败时不挂起,在当前线程继续执行
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) const;
+        static constexpr void await_resume() noexcept {}
+    };
+
+    /// co_await pool->schedule() 把当前协程转移到本线程池的工作线程上继续执行
+    /// 恢复协程的任务使用任务槽,不产生堆分配
+    /// @return awaiter
+    [[maybe_unused]] [[nodiscard]] XScheduleAwaiter_ schedule() noexcept
+    { return XScheduleAwaiter_{this}; }
+
+    /// 在本线程池启动协程,返回值与异常写入XFuture,需要包含<XThreadPool/xcoroutine.hpp>
+    /// @tparam T
+    /// @param task
+    /// @return XFuture<T>
+    template<typename T>
+    [[maybe_unused]] XFuture<T> spawn(XTask<T> task);
+
     /// 模式设置,线程池启动后设置无效
     /// @param mode
     [[maybe_unused]] void setMode(Mode mode) noexcept;
@@ -146,25 +686,119 @@ public:
     /// @return 当前任务数量
     [[maybe_unused]] [[nodiscard]] XSize_t currentTasksSize() const noexcept;
 
-    /// 设置线程池在CACHE模式下线程等待任务的时间,如果线程超时则退出,默认是60s
+    /// @return 因截止时间已过而未执行的任务累计数量
+    [[maybe_unused]] [[nodiscard]] XSize_t expiredTasksSize() const noexcept;
+
+    /// @return 因令牌已取消而未执行的任务累计数量
+    [[maybe_unused]] [[nodiscard]] XSize_t cancelledTasksSize() const noexcept;
+
+    /// 无锁读取运行统计,不影响工作线程
+    /// @return 统计快照
+    [[maybe_unused]] [[nodiscard]] XThreadPoolMetrics metrics() const;
+
+    /// 设置线程池在CACHE模式下线程等待任务的时间,如果线程超时则按XElasticConfig申请退出,默认是60s
     /// 只在CACHE模式下有效
-    /// 线程池启动后设置无效
+    /// 运行中设置对下一次等待生效
     /// @param seconds 单位是秒
     [[maybe_unused]] void setThreadTimeout(XSize_t seconds) noexcept;
 
+    /// CACHE模式的弹性伸缩参数,运行中设置立即生效
+    /// @param config
+    [[maybe_unused]] void setElasticConfig(XElasticConfig const & config) noexcept;
+
+    /// @return CACHE模式的弹性伸缩参数
+    [[maybe_unused]] [[nodiscard]] XElasticConfig elasticConfig() const noexcept;
+
+    /// 工作线程配置,线程池启动后设置无效
+    /// @param config
+    [[maybe_unused]] void setConfig(XThreadPoolConfig config) noexcept;
+
+    /// @return 工作线程配置
+    [[maybe_unused]] [[nodiscard]] XThreadPoolConfig const & getConfig() const noexcept;
+
     /// 创建线程池对象,默认模式为FIXED
     /// @param mode
     /// @return 线程池对象
     [[maybe_unused]] [[nodiscard]] static XThreadPoolPtr create(Mode mode = Mode::FIXED) noexcept;
 
+    /// 创建线程池对象并设置工作线程配置
+    /// @param mode
+    /// @param config
+    /// @return 线程池对象
+    [[maybe_unused]] [[nodiscard]] static XThreadPoolPtr create(Mode mode,XThreadPoolConfig config) noexcept;
+
     ~XThreadPool();
 
     X_DISABLE_COPY_MOVE(XThreadPool)
 
 private:
+    friend class XCoroutineFrame_;
     explicit XThreadPool();
     bool construct_();
-    XAbstractRunnablePtr appendHelper( XAbstractRunnablePtr ) ;
+    XAbstractRunnablePtr appendHelper( XAbstractRunnablePtr ,XTaskOptions const & = {}) ;
+    XSubmitResult submitHelper(XAbstractRunnablePtr,XTaskOptions const &);
+    std::vector<XAbstractRunnablePtr> appendBulkHelper(std::vector<XAbstractRunnablePtr> &&);
+    XTimer armTimer_(std::shared_ptr<XTimerNode_> node,std::chrono::steady_clock::time_point due
+        ,std::chrono::steady_clock::duration period);
+    template<typename Source_,typename Fn_> struct XContinuationArgs_;
+
+    template<typename T_,typename Fn_>
+    struct XContinuationArgs_<XFuture<T_>,Fn_> {
+        using type = std::conditional_t<std::is_void_v<T_>,std::tuple<>,std::tuple<std::add_lvalue_reference_t<T_ const>>>;
+        static type get(XFuture<T_> const & f) {
+            if constexpr (std::is_void_v<T_>) { f.get(); return {}; }
+            else { return type{f.get()}; }
+        }
+    };
+
+    template<typename Fn_>
+    struct XContinuationArgs_<XAbstractRunnablePtr,Fn_> {
+        using type = std::conditional_t<std::is_invocable_v<Fn_ &,XAbstractRunnablePtr const &>
+            ,std::tuple<XAbstractRunnablePtr const &>,std::tuple<>>;
+        static type get(XAbstractRunnablePtr const & task) {
+            if constexpr (std::tuple_size_v<type>) { return type{task}; }
+            else { return {}; }
+        }
+    };
+
+    template<typename T_>
+    static XReadyFlag_ const * readyFlagOf_(XFuture<T_> const & f) noexcept
+    { return f.flag_(); }
+
+    template<typename Ptr_> requires is_smart_pointer_v<Ptr_>
+    static XReadyFlag_ const * readyFlagOf_(Ptr_ const & task) noexcept
+    { return task ? std::addressof(task->readyFlag_()) : nullptr; }
+
+    static XFuture<void> whenAllHelper_(std::span<XReadyFlag_ const * const> flags);
+    static XFuture<std::size_t> whenAnyHelper_(std::span<XReadyFlag_ const * const> flags);
+
+    using invoke_t = void(*)(void *);
+    using destroy_t = void(*)(void *) noexcept;
+
+    /// 执行并销毁可调用对象,有返回值时构造在同一块存储中
+    template<typename Invoker_,typename R_>
+    static void slotInvoke_(void * const p) {
+        auto const invoker{static_cast<Invoker_ *>(p)};
+        struct Destroy_ final {
+            Invoker_ * m_invoker;
+            ~Destroy_() { m_invoker->~Invoker_(); }
+        };
+        if constexpr (std::is_void_v<R_>) {
+            Destroy_ const destroy{invoker};
+            static_cast<void>((*invoker)());
+        } else {
+            auto value{[invoker]{ Destroy_ const destroy{invoker}; return R_((*invoker)()); }()};
+            ::new (p) R_(std::move(value));
+        }
+    }
+
+    template<typename Ty_>
+    static void slotDestroy_(void * const p) noexcept
+    { static_cast<Ty_ *>(p)->~Ty_(); }
+
+    std::pair<XTaskSlot_ *,void *> allocateSlot_(std::size_t size,std::size_t align
+        ,invoke_t invoke,destroy_t destroy,destroy_t dropResult,bool retain);
+    bool submitSlot_(XTaskSlot_ * slot,XTaskOptions const & options);
 };
 
 [[maybe_unused]] X_API void sleep_for_ns(XSize_t ns);
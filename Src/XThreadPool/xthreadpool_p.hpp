@@ -2,13 +2,33 @@
 #define XUTILS2_XTHREAD_POOL_P_HPP 1
 
 #include <XThreadPool/xthreadpool.hpp>
+#include "xpooltask_p.hpp"
+#include "xworkstealingdeque_p.hpp"
+#include "xtaskslot_p.hpp"
+#include "xframeallocator_p.hpp"
+#include "xpriorityqueue_p.hpp"
+#include "xcputopology_p.hpp"
+#include "xworkerstats_p.hpp"
+#include "xtimerwheel_p.hpp"
 #include <deque>
+#include <vector>
 #include <thread>
 #include <condition_variable>
 #include <mutex>
 #include <unordered_map>
 #include <functional>
+#include <span>
 #include <XAtomic/xatomic.hpp>
+#include <XConcurrentQueue/xlightweightsemaphore.hpp>
+// 第三方队列的位运算未加括号,只在此处屏蔽,不影响线程池自身代码的告警
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wparentheses"
+#endif
+#include <XConcurrentQueue/xconcurrentqueueproxy.hpp>
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER)
+#pragma GCC diagnostic pop
+#endif
 
 #if __cplusplus >= 202002L
 #include <ranges>
@@ -30,6 +50,9 @@ static inline constexpr auto MAX_TASKS_SIZE{INT32_MAX};
 
 static inline constexpr auto WAIT_MINUTES{60};
 
+/// WORK_STEALING模式下,工作线程一次从注入队列搬运的最大任务数
+static inline constexpr std::size_t STEAL_BATCH_SIZE{32};
+
 using Tid_t = xptrdiff;
 
 class XThread_ final : public std::enable_shared_from_this<XThread_> {
@@ -41,7 +64,9 @@ public:
     explicit XThread_(task_t && t,Private):m_taskFunc_(std::move(t)){}
     ~XThread_() = default;
 
-    void start() const { std::thread(m_taskFunc_, reinterpret_cast<Tid_t>(this)).detach();}
+    /// @param stackSize 线程栈大小,0使用std::thread
+    /// @return 指定的栈大小是否生效,未生效时仍以默认栈大小启动
+    bool start(std::size_t stackSize = {}) const;
 
     [[nodiscard]] auto get_id() const noexcept
     { return reinterpret_cast<Tid_t>(this); }
@@ -55,6 +80,66 @@ public:
     X_DEFAULT_COPY_MOVE(XThread_)
 };
 
+class XThreadPoolPrivate;
+
+/**
+ * WORK_STEALING模式下的工作线程上下文
+ * 每个工作线程拥有一个无锁双端队列,本线程提交的任务直接压入,空闲线程从其他线程窃取
+ */
+class XWorker_ final {
+public:
+    X_DISABLE_COPY_MOVE(XWorker_)
+    XWorkStealingDeque_<XPoolTask_ *> m_deque{};
+    XThreadPoolPrivate * m_pool{};
+    std::size_t m_index{};
+    /// 所在NUMA节点,未启用NUMA放置时为0
+    std::size_t m_node{};
+    /// 窃取顺序,同节点的线程在前
+    std::vector<XWorker_ *> m_victims{};
+
+    explicit XWorker_(XThreadPoolPrivate * const pool,std::size_t const index)
+        : m_pool{pool},m_index{index} {}
+    ~XWorker_() = default;
+};
+
+/**
+ * WORK_STEALING模式下启用m_numaSpread时每个NUMA节点的注入队列,各自加锁
+ * 外部线程提交的默认及低优先级任务进入提交线程所在节点的队列,
+ * 工作线程先取本节点的队列,其他节点的队列排在全局注入队列与同节点线程之后
+ */
+class alignas(64) XNodeQueue_ final {
+public:
+    X_DISABLE_COPY_MOVE(XNodeQueue_)
+    std::mutex m_mtx{};
+    XPriorityQueue_ m_queue{};
+    /// 队列长度,无锁判断是否为空
+    std::atomic_size_t m_size{};
+    /// 本节点的工作线程数,用于均分批量搬运
+    std::size_t m_workersSize{};
+
+    XNodeQueue_() = default;
+    ~XNodeQueue_() = default;
+};
+
+/// LOCK_FREE模式的任务队列,nullptr是停止标记
+using XLockFreeQueue_ = moodycamel::XBlockingConcurrentQueueProxy<XPoolTask_ *>;
+
+/**
+ * LOCK_FREE模式下工作线程持有的令牌
+ * 工作线程内提交的任务使用显式生产者令牌,外部线程使用队列的隐式生产者(同样按线程区分)
+ */
+class XLockFreeTokens_ final {
+public:
+    X_DISABLE_COPY_MOVE(XLockFreeTokens_)
+    XThreadPoolPrivate * m_pool{};
+    moodycamel::ProducerToken m_producer;
+    moodycamel::ConsumerToken m_consumer;
+
+    explicit XLockFreeTokens_(XThreadPoolPrivate * const pool,XLockFreeQueue_ & queue)
+        : m_pool{pool},m_producer{queue.m_q},m_consumer{queue.m_q} {}
+    ~XLockFreeTokens_() = default;
+};
+
 class X_CLASS_EXPORT XThreadPoolPrivate final : public XThreadPoolData {
 
     X_DISABLE_COPY_MOVE(XThreadPoolPrivate)
@@ -65,39 +150,204 @@ public:
     mutable XThreadLocalConstVoid m_isCurrentTask_{};
 #endif
 
-    std::deque<XAbstractRunnablePtr> m_tasksQueue{};
+    /// FIXED/CACHE模式下的任务队列,WORK_STEALING模式下作为外部提交的注入队列,按优先级出队
+    XPriorityQueue_ m_tasksQueue{};
     std::unordered_map<Tid_t, XThread_::XThreadPtr> m_threadsContainer{};
+    std::vector<std::unique_ptr<XWorker_>> m_workers{};
+    /// runnableJoinDetached/runnableJoinTyped使用的任务槽,线程池析构后由最后一个归还的槽释放
+    XTaskSlab_ * m_taskSlab{new XTaskSlab_{}};
+    /// runAfter/runAt/runEvery共用的时间轮,stop时丢弃全部定时器
+    std::shared_ptr<XTimerWheel_> m_timers{};
+    /// LOCK_FREE模式的任务队列,切换到该模式时创建,m_queuedTasksSize同时作为容量计数
+    std::unique_ptr<XLockFreeQueue_> m_lockFreeTasks{};
+    /// 提交线程的配额计数,由m_mtx保护,线程池析构前不释放
+    std::deque<std::atomic_size_t> m_quotaCounters{};
+    std::unordered_map<std::thread::id,std::atomic_size_t *> m_producers{};
+    /// 进程内唯一的线程池编号,用于提交线程缓存自己的配额计数
+    xuint64 m_id{};
+    /// 每个工作线程的统计,metrics无锁汇总
+    XWorkerStatsList_ m_workerStats{};
+    /// XTask协程帧的分配器,线程池析构后由最后一个存活的帧释放
+    XFrameAllocator_ * m_frameAllocator{new XFrameAllocator_{}};
 
     mutable std::recursive_mutex m_mtx{};
+    /// m_taskQueueCond只用于等待队列空位的提交者
     mutable std::condition_variable_any m_taskQueueCond{},m_exitCond{};
+    /// 空闲工作线程在此休眠,自旋由idleWait完成,信号量本身不再自旋
+    moodycamel::XLightweightSemaphore m_idleSem{0,0};
 
     using Mode = XThreadPool::Mode;
     Mode m_mode{};
+    XThreadPoolConfig m_config{};
+    /// 以下三项由m_mtx保护
+    XElasticConfig m_elastic{};
+    std::chrono::steady_clock::time_point m_lastGrow{},m_lastShrink{};
+    /// start时按m_config计算的NUMA节点,每个节点是可用的CPU编号
+    std::vector<std::vector<std::size_t>> m_nodes{};
+    /// CPU编号到m_nodes下标,提交线程据此选择节点注入队列
+    std::vector<std::size_t> m_cpuNodes{};
+    /// 与m_nodes一一对应的注入队列,只在WORK_STEALING模式启用m_numaSpread时存在,start时重建
+    std::vector<std::unique_ptr<XNodeQueue_>> m_nodeQueues{};
+    /// 节点注入队列中的任务总数,与全局队列的任务数之和不超过m_tasksSizeThreshold
+    XAtomicInteger<XSize_t> m_nodeTasksSize{};
     XAtomicBool m_isPoolRunning{};
     XAtomicInteger<XSize_t> m_initThreadsSize{},m_idleThreadsSize{},m_busyThreadsSize{},
         m_threadTimeout{WAIT_MINUTES},
         m_threadsSizeThreshold{MAX_THREADS_SIZE},
-        m_tasksSizeThreshold{MAX_TASKS_SIZE};
+        m_tasksSizeThreshold{MAX_TASKS_SIZE},
+        m_queuedTasksSize{},m_sleepingThreadsSize{},
+        m_urgentTasksSize{},m_expiredTasksSize{},m_cancelledTasksSize{},
+        m_submittedTasksSize{},m_rejectedTasksSize{},
+        m_threadIndex{};
 
     constexpr XThreadPoolPrivate() = default;
 
-    ~XThreadPoolPrivate() override = default;
+    ~XThreadPoolPrivate() override;
+
+    XPoolTask_ * acquireTask();
+
+    XSubmitStatus append(XAbstractRunnablePtr const & task,XTaskOptions const & options = {});
+
+    /// 共享队列变化后同步无锁读取的计数,调用前需持有m_mtx
+    void storeQueuedSize() noexcept;
+
+    /// 解析后的溢出处理方式
+    struct Overflow_ final {
+        XTaskOptions::Overflow m_action{};
+        std::chrono::microseconds m_timeout{};
+    };
+
+    /// @return 合并任务选项与m_config后的溢出处理方式
+    [[nodiscard]] Overflow_ overflow(XTaskOptions const & options) const noexcept;
+
+    /// 任务节点入队,工作线程内提交进入本地队列,否则进入全局队列
+    /// 队列已满时按溢出处理方式处理,未加入的任务调用dropTask
+    XSubmitStatus enqueue(XPoolTask_ * task,XTaskOptions const & options = {});
+
+    /// 占用当前提交线程至多n个配额,不限配额时counter为nullptr
+    /// @return 获准的数量
+    std::size_t takeQuota(std::size_t n,std::atomic_size_t * & counter);
+
+    /// 归还配额并丢弃任务
+    static void dropTask(XPoolTask_ * const task) noexcept
+    { task->releaseQuota(); task->discard(); }
+
+    /// CALLER_RUNS: 在调用线程执行任务
+    XSubmitStatus runInCaller(XPoolTask_ * task) noexcept;
 
-    XAbstractRunnablePtr acquireTask();
+    std::vector<XAbstractRunnablePtr> appendBulk(std::vector<XAbstractRunnablePtr> && tasks);
 
-    XAbstractRunnablePtr append( XAbstractRunnablePtr task);
+    /// 检查任务能否加入本线程池,并抢占任务的所有者
+    bool acceptTask(XAbstractRunnablePtr const & task);
+
+    /// CACHE模式下按排队延迟与利用率决定是否扩容,调用前需持有m_mtx
+    /// @return 新创建的线程,由调用者释放m_mtx后启动
+    [[nodiscard]] std::vector<XThread_::XThreadPtr> growCacheThreads();
+
+    /// 在锁外启动growCacheThreads创建的线程
+    void startThreads(std::vector<XThread_::XThreadPtr> const & threads) const;
+
+    /// CACHE模式下空闲超时的线程申请退出,调用前不能持有m_mtx
+    /// @param retry 未获准退出时,再次申请前的等待时间
+    /// @return 允许退出
+    bool retireCacheThread(std::chrono::steady_clock::duration & retry);
 
     void start(XSize_t threadSize);
 
     void stop();
 
-    void run(XSize_t threadId);
+    void run(Tid_t threadId,XWorker_ * worker,std::size_t index);
+
+    /// 创建第index个线程并加入线程容器,由调用者启动,调用前需持有m_mtx
+    XThread_::XThreadPtr createThread(XWorker_ * worker,std::size_t index);
+
+    /// @return 第index个线程所在的节点和绑定的CPU,不绑定时CPU为空
+    [[nodiscard]] std::pair<std::size_t,std::span<std::size_t const>> placement(std::size_t index) const noexcept;
+
+    /// 按m_config计算m_nodes
+    void buildPlacement();
+
+    /// 为任务设置线程池相关状态并转移所有权给线程池
+    XPoolTask_ * prepareTask(XAbstractRunnablePtr const & task,XTaskOptions const & options = {});
+
+    /// LOCK_FREE模式: 预占容量后入队,不加锁,容量不足时按溢出处理方式处理
+    XSubmitStatus enqueueLockFree(XPoolTask_ * task,Overflow_ const & policy);
+
+    /// LOCK_FREE模式: 自旋尝试出队,仍无任务时阻塞在队列的信号量上,收到停止标记且队列为空时返回nullptr
+    XPoolTask_ * acquireLockFreeTask(XLockFreeTokens_ & tokens);
+
+    /// LOCK_FREE模式: 预占至多count个容量,没有容量时退避等待至多timeout
+    /// @return 预占到的数量
+    std::size_t reserveLockFree(std::size_t count,std::chrono::microseconds timeout);
+
+    /// WORK_STEALING模式: 预占容量后加入提交线程所在节点的注入队列
+    /// @return 没有容量时返回false,由调用者按全局队列的溢出处理方式处理
+    bool enqueueNode(XPoolTask_ * task);
+
+    /// 从节点注入队列取任务,batch为true时按本节点线程数均分搬运到本地队列
+    XPoolTask_ * takeNodeTask(XWorker_ & worker,XNodeQueue_ & node,bool batch);
+
+    /// 节点注入队列的任务出队后,全局与节点队列此前已满时唤醒等待空位的提交者
+    void notifyNodeRoom(std::size_t taken);
+
+    /// 把节点注入队列的残留任务移入全局队列并按当前模式与节点重建,调用前需持有m_mtx
+    void buildNodeQueues();
+
+    /// @return 全局队列与节点队列是否还有空位,调用前需持有m_mtx
+    [[nodiscard]] bool hasQueueRoom() const noexcept;
+
+    /// WORK_STEALING模式: 本地队列 -> 本节点注入队列 -> 全局注入队列 -> 同节点线程 -> 其他节点注入队列 -> 其他节点线程,
+    /// 均无任务时休眠
+    XPoolTask_ * acquireStealingTask(XWorker_ & worker);
+
+    /// 从注入队列批量搬运或窃取其他工作线程的任务,本节点的注入队列优先
+    XPoolTask_ * stealTask(XWorker_ & worker);
+
+    /// @return 当前线程是本线程池的工作线程时返回其上下文,否则返回nullptr
+    [[nodiscard]] XWorker_ * localWorker() const noexcept;
+
+    /// 唤醒至多count个休眠的工作线程
+    void wakeWorker(std::size_t count = 1);
+
+    /// 空闲等待: 自旋m_spinCount次 -> 让出m_yieldCount次 -> 休眠,probe返回true表示可能有任务
+    /// @return 超时返回false
+    template<typename Probe_>
+    bool idleWait(Probe_ && probe,std::int64_t timeout_usecs = -1);
+
+    [[nodiscard]] bool hasStealableTask() const noexcept;
 
     auto currentThreadsSize() const noexcept
     { std::unique_lock lock(m_mtx); return static_cast<XSize_t>(m_threadsContainer.size()); }
 
-    auto currentTasksSize() const noexcept
-    { std::unique_lock lock(m_mtx); return static_cast<XSize_t>(m_tasksQueue.size()); }
+    XSize_t currentTasksSize() const noexcept;
+
+    /// @return 是否记录排队与执行时间
+    [[nodiscard]] bool timingEnabled() const noexcept
+    { return m_config.m_collectTimings || static_cast<bool>(m_config.m_traceHook); }
+
+    /// @return 入队时是否需要记录时间,CACHE模式的扩容判断也需要
+    [[nodiscard]] bool stampEnqueue() const noexcept
+    { return Mode::CACHE == m_mode || timingEnabled(); }
+
+    /// 任务因队列已满等原因未能加入
+    void reject(std::size_t const n = 1) noexcept
+    { m_rejectedTasksSize.fetchAndAddRelaxed(static_cast<XSize_t>(n)); }
+
+    /// 发送诊断事件,没有接收者或级别不足时直接返回
+    /// @param message 字符串,或返回字符串的可调用对象(只在需要发送时调用)
+    template<typename Message_>
+    void emit(XPoolEvent::Level const level,XPoolEvent::Kind const kind,xuint64 const value,Message_ && message) const noexcept {
+        auto const & sink{m_config.m_eventSink};
+        if (!sink || level < m_config.m_eventLevel) { return; }
+        try {
+            if constexpr (std::is_invocable_v<Message_ &>) {
+                std::string const text{std::invoke(message)};
+                sink(XPoolEvent{level,kind,value,text});
+            } else {
+                sink(XPoolEvent{level,kind,value,std::string_view{message}});
+            }
+        } catch (...) {}
+    }
 };
 
 XTD_INLINE_NAMESPACE_END
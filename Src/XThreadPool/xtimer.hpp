@@ -0,0 +1,99 @@
+#ifndef XUTILS2_X_TIMER_HPP
+#define XUTILS2_X_TIMER_HPP 1
+
+#include <XHelper/xhelper.hpp>
+#include <XGlobal/xtypes.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+class XTimerWheel_;
+
+/**
+ * 时间轮槽内的双向循环链表节点,槽本身是哨兵节点
+ */
+class XTimerLink_ {
+public:
+    XTimerLink_ * m_prev{this},* m_next{this};
+    X_DISABLE_COPY_MOVE(XTimerLink_)
+    XTimerLink_() = default;
+    ~XTimerLink_() = default;
+};
+
+/**
+ * 定时器节点
+ * 在时间轮中时由m_self持有自身,到期后交给线程池执行,周期定时器随即重新挂入时间轮
+ */
+class X_CLASS_EXPORT XTimerNode_ : public XTimerLink_ {
+public:
+    using time_point_t = std::chrono::steady_clock::time_point;
+    using duration_t = std::chrono::steady_clock::duration;
+
+    X_DISABLE_COPY_MOVE(XTimerNode_)
+
+    /// 以下由时间轮的互斥量保护
+    std::shared_ptr<XTimerNode_> m_self{};
+    time_point_t m_due{};
+    /// 到期的时间轮刻度
+    xuint64 m_expires{};
+
+    /// 周期,0为一次性定时器,创建后不再修改
+    duration_t m_period{};
+    std::weak_ptr<XTimerWheel_> m_wheel{};
+    /// 在时间轮中等待触发
+    std::atomic_bool m_armed{};
+    std::atomic_bool m_cancelled{};
+    /// 周期定时器上一次触发仍在执行时跳过本次触发
+    std::atomic_bool m_running{};
+
+    XTimerNode_() = default;
+    virtual ~XTimerNode_() = default;
+
+    /// 在线程池中执行,已取消或上一次仍在执行时直接返回
+    void fire();
+
+    virtual void invoke() = 0;
+};
+
+template<typename Fn_>
+class XTimerNodeImpl_ final : public XTimerNode_ {
+    Fn_ m_fn_;
+public:
+    template<typename F_>
+    explicit XTimerNodeImpl_(F_ && fn) : m_fn_{std::forward<F_>(fn)} {}
+    void invoke() override { std::invoke(m_fn_); }
+};
+
+/**
+ * runAfter、runAt、runEvery返回的定时器句柄,可以复制
+ * 句柄析构不会取消定时器
+ */
+class X_CLASS_EXPORT XTimer final {
+    std::shared_ptr<XTimerNode_> m_node_{};
+
+public:
+    XTimer() = default;
+
+    explicit XTimer(std::shared_ptr<XTimerNode_> node) noexcept
+        : m_node_{std::move(node)} {}
+
+    /// 取消定时器,O(1),不等待正在执行的触发结束
+    /// @return 取消前仍在等待触发
+    bool cancel() noexcept;
+
+    /// @return 仍在等待触发,一次性定时器触发后或取消后返回false
+    [[nodiscard]] bool isActive() const noexcept
+    { return m_node_ && m_node_->m_armed.load(std::memory_order_acquire) && !m_node_->m_cancelled.load(std::memory_order_acquire); }
+
+    [[nodiscard]] explicit operator bool() const noexcept
+    { return static_cast<bool>(m_node_); }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
@@ -0,0 +1,184 @@
+#include "xtimerwheel_p.hpp"
+#include <algorithm>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+void XTimerNode_::fire() {
+    if (m_cancelled.load(std::memory_order_acquire) || m_running.exchange(true,std::memory_order_acquire)) { return; }
+    struct Reset_ final {
+        std::atomic_bool & m_running;
+        ~Reset_() { m_running.store(false,std::memory_order_release); }
+    } const reset{m_running};
+    invoke();
+}
+
+bool XTimer::cancel() noexcept {
+    if (!m_node_ || m_node_->m_cancelled.exchange(true,std::memory_order_acq_rel)) { return {}; }
+    auto const wheel{m_node_->m_wheel.lock()};
+    return wheel && wheel->cancel(*m_node_);
+}
+
+XTimerWheel_::~XTimerWheel_()
+{ shutdown(); }
+
+xuint64 XTimerWheel_::tickOf_(time_point_t const tp) const noexcept {
+    if (tp <= m_origin_) { return {}; }
+    return static_cast<xuint64>(std::chrono::ceil<std::chrono::milliseconds>(tp - m_origin_).count() / Tick_.count());
+}
+
+XTimerWheel_::time_point_t XTimerWheel_::timeOf_(xuint64 const tick) const noexcept
+{ return m_origin_ + Tick_ * static_cast<std::chrono::milliseconds::rep>(tick); }
+
+void XTimerWheel_::link_(XTimerNode_ & node) noexcept {
+    // 超出覆盖范围的定时器挂在最高层,重新分配时再次计算
+    auto const expires{std::clamp(node.m_expires,m_current_,m_current_ + MaxDelta_)};
+    auto const delta{expires - m_current_};
+    std::size_t level{};
+    while (level + 1 < LevelsSize_ && delta >> SlotBits_ * (level + 1)) { ++level; }
+    auto & head{m_slots_[level][expires >> SlotBits_ * level & SlotMask_]};
+    node.m_prev = head.m_prev;
+    node.m_next = std::addressof(head);
+    head.m_prev->m_next = std::addressof(node);
+    head.m_prev = std::addressof(node);
+}
+
+void XTimerWheel_::unlink_(XTimerNode_ & node) noexcept {
+    node.m_prev->m_next = node.m_next;
+    node.m_next->m_prev = node.m_prev;
+    node.m_prev = node.m_next = std::addressof(node);
+}
+
+void XTimerWheel_::advance_(time_point_t const now,std::vector<std::shared_ptr<XTimerNode_>> & due) {
+    ++m_current_;
+
+    // 到达某层的边界时,把上一层对应槽内的定时器重新分配,从高层到低层依次进行
+    std::size_t levels{};
+    while (levels + 1 < LevelsSize_ && !(m_current_ & ((xuint64{1} << SlotBits_ * (levels + 1)) - 1))) { ++levels; }
+    for (auto level{levels}; level > 0; --level) {
+        auto & head{m_slots_[level][m_current_ >> SlotBits_ * level & SlotMask_]};
+        while (head.m_next != std::addressof(head)) {
+            auto & node{static_cast<XTimerNode_ &>(*head.m_next)};
+            unlink_(node);
+            link_(node);
+        }
+    }
+
+    auto & head{m_slots_[0][m_current_ & SlotMask_]};
+    XTimerLink_ pending{};
+    // 先整体摘下,重新挂入的周期定时器不会在本刻度再次触发
+    if (head.m_next != std::addressof(head)) {
+        pending.m_next = head.m_next;
+        pending.m_prev = head.m_prev;
+        pending.m_next->m_prev = pending.m_prev->m_next = std::addressof(pending);
+        head.m_prev = head.m_next = std::addressof(head);
+    }
+    while (pending.m_next != std::addressof(pending)) {
+        auto & node{static_cast<XTimerNode_ &>(*pending.m_next)};
+        unlink_(node);
+        if (node.m_expires > m_current_) { link_(node); continue; }
+        if (node.m_period.count() > 0) {
+            // 固定频率,错过的触发不补
+            node.m_due += node.m_period;
+            if (node.m_due <= now) { node.m_due = now + node.m_period; }
+            node.m_expires = std::max(tickOf_(node.m_due),m_current_ + 1);
+            link_(node);
+            due.push_back(node.m_self);
+        } else {
+            node.m_armed.store(false,std::memory_order_release);
+            --m_size_;
+            due.push_back(std::move(node.m_self));
+        }
+    }
+}
+
+xuint64 XTimerWheel_::nextTick_() const noexcept {
+    auto const boundary{(m_current_ | SlotMask_) + 1};
+    for (auto tick{m_current_ + 1}; tick < boundary; ++tick) {
+        auto const & head{m_slots_[0][tick & SlotMask_]};
+        if (head.m_next != std::addressof(head)) { return tick; }
+    }
+    return boundary;
+}
+
+void XTimerWheel_::loop_() {
+    std::vector<std::shared_ptr<XTimerNode_>> due{};
+    std::unique_lock lock(m_mtx_);
+    while (!m_stop_) {
+        auto const now{std::chrono::steady_clock::now()};
+        if (!m_size_) {
+            m_current_ = std::max(m_current_,tickOf_(now));
+            m_wakeAt_ = time_point_t::max();
+            m_cond_.wait(lock);
+            continue;
+        }
+        for (auto const target{tickOf_(now)}; m_current_ < target && m_size_;) { advance_(now,due); }
+        if (!due.empty()) {
+            lock.unlock();
+            for (auto & node : due) { m_dispatch_(std::move(node)); }
+            due.clear();
+            lock.lock();
+            continue;
+        }
+        m_wakeAt_ = timeOf_(nextTick_());
+        m_cond_.wait_until(lock,m_wakeAt_);
+    }
+}
+
+void XTimerWheel_::arm(std::shared_ptr<XTimerNode_> const & node) {
+    std::unique_lock lock(m_mtx_);
+    // 正在停止,定时器随之丢弃
+    if (m_stop_) { return; }
+    if (!m_size_) { m_current_ = std::max(m_current_,tickOf_(std::chrono::steady_clock::now())); }
+    node->m_self = node;
+    node->m_expires = std::max(tickOf_(node->m_due),m_current_ + 1);
+    link_(*node);
+    ++m_size_;
+    node->m_armed.store(true,std::memory_order_release);
+    if (!m_thread_.joinable()) {
+        m_thread_ = std::thread([this]{ loop_(); });
+    } else if (timeOf_(node->m_expires) < m_wakeAt_) {
+        m_cond_.notify_one();
+    }
+}
+
+bool XTimerWheel_::cancel(XTimerNode_ & node) noexcept {
+    std::shared_ptr<XTimerNode_> self{};
+    {
+        std::unique_lock lock(m_mtx_);
+        if (!node.m_self) { return {}; }
+        unlink_(node);
+        --m_size_;
+        node.m_armed.store(false,std::memory_order_release);
+        self = std::move(node.m_self);
+    }
+    return true;
+}
+
+void XTimerWheel_::shutdown() noexcept {
+    std::vector<std::shared_ptr<XTimerNode_>> dropped{};
+    std::thread thread{};
+    {
+        std::unique_lock lock(m_mtx_);
+        m_stop_ = true;
+        for (auto & level : m_slots_) {
+            for (auto & head : level) {
+                while (head.m_next != std::addressof(head)) {
+                    auto & node{static_cast<XTimerNode_ &>(*head.m_next)};
+                    unlink_(node);
+                    node.m_armed.store(false,std::memory_order_release);
+                    dropped.push_back(std::move(node.m_self));
+                }
+            }
+        }
+        m_size_ = {};
+        thread = std::move(m_thread_);
+    }
+    m_cond_.notify_all();
+    if (thread.joinable()) { thread.join(); }
+    std::unique_lock lock(m_mtx_);
+    m_stop_ = {};
+}
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
@@ -0,0 +1,80 @@
+#ifndef XUTILS2_X_TIMER_WHEEL_P_HPP
+#define XUTILS2_X_TIMER_WHEEL_P_HPP 1
+
+#include <XThreadPool/xtimer.hpp>
+#include <XGlobal/xtypes.hpp>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 分层时间轮,刻度为1毫秒,4层每层256个槽,覆盖约49天,更远的定时器在最高层循环等待
+ * 挂入与取消均为O(1),每到一层的边界时把上一层对应槽内的定时器重新分配到下层
+ * 只有一个定时线程,第一次挂入时启动,没有定时器时无限期休眠,
+ * 到期的定时器在锁外交给m_dispatch,由线程池执行,不为每个定时器占用线程
+ */
+class XTimerWheel_ final {
+public:
+    using time_point_t = XTimerNode_::time_point_t;
+    using dispatch_t = std::function<void(std::shared_ptr<XTimerNode_>)>;
+
+    static constexpr std::chrono::milliseconds Tick_{1};
+    static constexpr std::size_t SlotBits_{8},SlotsSize_{std::size_t{1} << SlotBits_},LevelsSize_{4};
+    static constexpr xuint64 SlotMask_{SlotsSize_ - 1},MaxDelta_{(xuint64{1} << SlotBits_ * LevelsSize_) - 1};
+
+private:
+    dispatch_t m_dispatch_{};
+    std::mutex m_mtx_{};
+    std::condition_variable m_cond_{};
+    std::array<std::array<XTimerLink_,SlotsSize_>,LevelsSize_> m_slots_{};
+    time_point_t const m_origin_{std::chrono::steady_clock::now()};
+    /// 最后处理的刻度
+    xuint64 m_current_{};
+    std::size_t m_size_{};
+    /// 定时线程计划醒来的时间,挂入更早的定时器时才唤醒
+    time_point_t m_wakeAt_{time_point_t::max()};
+    std::thread m_thread_{};
+    bool m_stop_{};
+
+    [[nodiscard]] xuint64 tickOf_(time_point_t tp) const noexcept;
+    [[nodiscard]] time_point_t timeOf_(xuint64 tick) const noexcept;
+
+    /// 按m_expires挂入对应的槽,m_expires不晚于当前刻度时挂入当前槽
+    void link_(XTimerNode_ & node) noexcept;
+    static void unlink_(XTimerNode_ & node) noexcept;
+
+    /// 前进一个刻度,到期的定时器放入due
+    void advance_(time_point_t now,std::vector<std::shared_ptr<XTimerNode_>> & due);
+
+    /// @return 下一个可能有定时器到期的刻度
+    [[nodiscard]] xuint64 nextTick_() const noexcept;
+
+    void loop_();
+
+public:
+    X_DISABLE_COPY_MOVE(XTimerWheel_)
+
+    explicit XTimerWheel_(dispatch_t dispatch) : m_dispatch_{std::move(dispatch)} {}
+
+    ~XTimerWheel_();
+
+    /// 挂入定时器,需要时启动定时线程
+    void arm(std::shared_ptr<XTimerNode_> const & node);
+
+    /// 从时间轮摘除定时器
+    /// @return 定时器仍在时间轮中
+    bool cancel(XTimerNode_ & node) noexcept;
+
+    /// 停止定时线程并丢弃全部定时器,之后仍可再次挂入
+    void shutdown() noexcept;
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
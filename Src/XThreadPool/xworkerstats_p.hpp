@@ -0,0 +1,103 @@
+#ifndef XUTILS2_X_WORKER_STATS_P_HPP
+#define XUTILS2_X_WORKER_STATS_P_HPP 1
+
+#include <XThreadPool/xthreadpool.hpp>
+#include <atomic>
+#include <bit>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * 单个工作线程的统计,只由持有它的线程写入,快照时无锁读取
+ * 线程退出后归还,由之后创建的线程复用,累计值(完成数、直方图)不清零
+ */
+class XWorkerStats_ final {
+public:
+    X_DISABLE_COPY_MOVE(XWorkerStats_)
+    using counter_t = std::atomic<xuint64>;
+    using histogram_t = std::array<counter_t,XLatencyHistogram::BucketsSize>;
+
+    /// 发布到链表后不再修改
+    XWorkerStats_ * m_next{};
+    std::atomic_bool m_inUse{};
+    std::atomic_size_t m_index{};
+    /// 以下四项在每次被线程持有时清零
+    counter_t m_tasks{},m_steals{},m_busyNs{};
+    std::atomic<std::int64_t> m_claimedNs{};
+    /// 累计值
+    counter_t m_completed{},m_waitNs{},m_runNs{};
+    histogram_t m_wait{},m_run{};
+
+    constexpr XWorkerStats_() = default;
+    ~XWorkerStats_() = default;
+
+    /// 只有持有者写入,不需要原子的读-改-写
+    static void add(counter_t & counter,xuint64 const n = 1) noexcept
+    { counter.store(counter.load(std::memory_order_relaxed) + n,std::memory_order_relaxed); }
+
+    static void record(histogram_t & histogram,counter_t & total,std::chrono::nanoseconds const duration) noexcept {
+        auto const ns{static_cast<xuint64>(std::max(duration.count(),std::chrono::nanoseconds::rep{}))};
+        auto const bucket{std::min<std::size_t>(std::bit_width(ns / 1000),XLatencyHistogram::BucketsSize - 1)};
+        add(histogram[bucket]);
+        add(total,ns);
+    }
+
+    static void load(histogram_t const & histogram,counter_t const & total,XLatencyHistogram & out) noexcept {
+        for (std::size_t i{}; i < XLatencyHistogram::BucketsSize; ++i) {
+            auto const n{histogram[i].load(std::memory_order_relaxed)};
+            out.m_buckets[i] += n;
+            out.m_count += n;
+        }
+        out.m_total += std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(total.load(std::memory_order_relaxed))};
+    }
+};
+
+/**
+ * 只增不减的无锁统计链表,线程池析构时释放
+ */
+class XWorkerStatsList_ final {
+    std::atomic<XWorkerStats_ *> m_head_{};
+
+public:
+    X_DISABLE_COPY_MOVE(XWorkerStatsList_)
+    constexpr XWorkerStatsList_() = default;
+
+    ~XWorkerStatsList_() {
+        for (auto p{m_head_.load(std::memory_order_acquire)}; p;) { delete std::exchange(p,p->m_next); }
+    }
+
+    /// 持有一个空闲的统计块,没有时新建
+    [[nodiscard]] XWorkerStats_ & acquire(std::size_t const index) {
+        XWorkerStats_ * stats{};
+        for (auto p{m_head_.load(std::memory_order_acquire)}; p && !stats; p = p->m_next) {
+            if (bool expected{}; p->m_inUse.compare_exchange_strong(expected,true,std::memory_order_acquire)) { stats = p; }
+        }
+        if (!stats) {
+            stats = new XWorkerStats_{};
+            stats->m_inUse.store(true,std::memory_order_relaxed);
+            stats->m_next = m_head_.load(std::memory_order_relaxed);
+            while (!m_head_.compare_exchange_weak(stats->m_next,stats,std::memory_order_release,std::memory_order_relaxed)) {}
+        }
+        stats->m_index.store(index,std::memory_order_relaxed);
+        stats->m_tasks.store({},std::memory_order_relaxed);
+        stats->m_steals.store({},std::memory_order_relaxed);
+        stats->m_busyNs.store({},std::memory_order_relaxed);
+        stats->m_claimedNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count(),std::memory_order_relaxed);
+        return *stats;
+    }
+
+    static void release(XWorkerStats_ & stats) noexcept
+    { stats.m_inUse.store({},std::memory_order_release); }
+
+    template<typename Fn_>
+    void forEach(Fn_ && fn) const {
+        for (auto p{m_head_.load(std::memory_order_acquire)}; p; p = p->m_next) { fn(*p); }
+    }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
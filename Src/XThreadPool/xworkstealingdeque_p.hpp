@@ -0,0 +1,133 @@
+#ifndef XUTILS2_X_WORK_STEALING_DEQUE_P_HPP
+#define XUTILS2_X_WORK_STEALING_DEQUE_P_HPP 1
+
+#include <XHelper/xversion.hpp>
+#include <XGlobal/xclasshelpermacros.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+XTD_NAMESPACE_BEGIN
+XTD_INLINE_NAMESPACE_BEGIN(v1)
+
+/**
+ * Chase-Lev 无锁工作窃取双端队列
+ * push/pop 只允许拥有者线程调用(LIFO端),steal 允许任意线程调用(FIFO端)
+ * 扩容后的旧数组可能仍被窃取者读取,因此延迟到队列析构时释放
+ * 参考: Lê, Pop, Cohen, Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models"
+ */
+template<typename T>
+class XWorkStealingDeque_ final {
+    static_assert(std::is_pointer_v<T>,"XWorkStealingDeque_ only stores pointers");
+
+    class Array_ final {
+        std::int64_t m_capacity_{},m_mask_{};
+        std::unique_ptr<std::atomic<T>[]> m_data_{};
+
+    public:
+        explicit Array_(std::int64_t const capacity)
+            : m_capacity_{capacity},m_mask_{capacity - 1}
+            , m_data_{std::make_unique<std::atomic<T>[]>(static_cast<std::size_t>(capacity))}
+        {}
+
+        [[nodiscard]] std::int64_t capacity() const noexcept { return m_capacity_; }
+
+        [[nodiscard]] T load(std::int64_t const i) const noexcept
+        { return m_data_[i & m_mask_].load(std::memory_order_relaxed); }
+
+        void store(std::int64_t const i,T const v) noexcept
+        { m_data_[i & m_mask_].store(v,std::memory_order_relaxed); }
+
+        [[nodiscard]] std::unique_ptr<Array_> grow(std::int64_t const b,std::int64_t const t) const {
+            auto ret{std::make_unique<Array_>(m_capacity_ << 1)};
+            for (auto i{t}; i < b; ++i) { ret->store(i,load(i)); }
+            return ret;
+        }
+    };
+
+    static constexpr std::size_t CacheLine_ {64};
+
+    alignas(CacheLine_) std::atomic<std::int64_t> m_top_{};
+    alignas(CacheLine_) std::atomic<std::int64_t> m_bottom_{};
+    alignas(CacheLine_) std::atomic<Array_ *> m_array_{};
+    std::vector<std::unique_ptr<Array_>> m_arrays_{};
+
+public:
+    X_DISABLE_COPY_MOVE(XWorkStealingDeque_)
+
+    explicit XWorkStealingDeque_(std::int64_t const capacity = 256) {
+        auto cap{std::int64_t{1}};
+        while (cap < capacity) { cap <<= 1; }
+        m_arrays_.push_back(std::make_unique<Array_>(cap));
+        m_array_.store(m_arrays_.back().get(),std::memory_order_relaxed);
+    }
+
+    ~XWorkStealingDeque_() = default;
+
+    /// 拥有者线程压入
+    void push(T const v) {
+        auto const b{m_bottom_.load(std::memory_order_relaxed)}
+            ,t{m_top_.load(std::memory_order_acquire)};
+        auto a{m_array_.load(std::memory_order_relaxed)};
+        if (b - t > a->capacity() - 1) {
+            m_arrays_.push_back(a->grow(b,t));
+            a = m_arrays_.back().get();
+            m_array_.store(a,std::memory_order_release);
+        }
+        a->store(b,v);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom_.store(b + 1,std::memory_order_relaxed);
+    }
+
+    /// 拥有者线程弹出(LIFO),为空返回nullptr
+    [[nodiscard]] T pop() noexcept {
+        auto const b{m_bottom_.load(std::memory_order_relaxed) - 1};
+        auto const a{m_array_.load(std::memory_order_relaxed)};
+        m_bottom_.store(b,std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t{m_top_.load(std::memory_order_relaxed)};
+
+        if (t > b) {
+            m_bottom_.store(b + 1,std::memory_order_relaxed);
+            return {};
+        }
+
+        auto x{a->load(b)};
+        if (t == b) {
+            // 最后一个元素,与窃取者竞争
+            if (!m_top_.compare_exchange_strong(t,t + 1,std::memory_order_seq_cst,std::memory_order_relaxed))
+            { x = {}; }
+            m_bottom_.store(b + 1,std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    /// 任意线程窃取(FIFO),为空或竞争失败返回nullptr
+    [[nodiscard]] T steal() noexcept {
+        auto t{m_top_.load(std::memory_order_acquire)};
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto const b{m_bottom_.load(std::memory_order_acquire)};
+        if (t >= b) { return {}; }
+        auto const a{m_array_.load(std::memory_order_acquire)};
+        auto const x{a->load(t)};
+        if (!m_top_.compare_exchange_strong(t,t + 1,std::memory_order_seq_cst,std::memory_order_relaxed))
+        { return {}; }
+        return x;
+    }
+
+    /// @return 近似元素数量
+    [[nodiscard]] std::size_t sizeApprox() const noexcept {
+        auto const b{m_bottom_.load(std::memory_order_relaxed)}
+            ,t{m_top_.load(std::memory_order_relaxed)};
+        return b > t ? static_cast<std::size_t>(b - t) : std::size_t{};
+    }
+
+    [[nodiscard]] bool emptyApprox() const noexcept { return !sizeApprox(); }
+};
+
+XTD_INLINE_NAMESPACE_END
+XTD_NAMESPACE_END
+
+#endif
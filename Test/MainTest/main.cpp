@@ -15,6 +15,11 @@
 #include <XMath/xmath.hpp>
 #include <XDesignPattern/xcor.hpp>
 #include <XThreadPool/xrunnable.hpp>
+#include <XThreadPool/xcoroutine.hpp>
+#include <XParallel/xparallel.hpp>
+#include <XThreadPool/xtaskgroup.hpp>
+#include <random>
+#include <map>
 
 static std::mutex mtx{};
 
@@ -705,6 +710,558 @@ void test12() {
     });
 }
 
+void test13() {
+
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::WORK_STEALING)};
+    pool->start(4);
+
+    std::atomic_int count{};
+    std::vector<XUtils::XAbstractRunnablePtr> tasks{};
+    for (int i{}; i < 1000; ++i) {
+        tasks.push_back(pool->runnableJoin([&count,&pool](int const id) {
+            // 工作线程内提交的任务进入本地队列,由空闲线程窃取
+            pool->runnableJoin([&count]{ count.fetch_add(1); });
+            count.fetch_add(1);
+            return id;
+        },i));
+    }
+
+    int sum{};
+    for (auto const & task : tasks) { sum += task->result<int>(); }
+    while (count.load() < 2000) { std::this_thread::yield(); }
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum << " count = " << count.load() << "\n";
+}
+
+void test14() {
+
+    auto const pool{XUtils::XThreadPool::create()};
+
+    auto const tasks{pool->runnableJoinN([](XUtils::XSize_t const i){ return static_cast<int>(i); },10000)};
+
+    std::vector<std::function<int()>> fns(100,[]{ return 1; });
+    auto const tasks2{pool->runnableJoinBulk(fns)};
+
+    int sum{};
+    for (auto const & task : tasks) { sum += task->result<int>(); }
+    for (auto const & task : tasks2) { sum += task->result<int>(); }
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum << "\n";
+}
+
+void test15() {
+
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::WORK_STEALING)};
+
+    std::atomic_int count{};
+    for (int i{}; i < 10000; ++i)
+    { pool->runnableJoinDetached([&count]{ count.fetch_add(1,std::memory_order_relaxed); }); }
+
+    std::vector<XUtils::XTaskResult<int>> results{};
+    for (int i{}; i < 1000; ++i)
+    { results.push_back(pool->runnableJoinTyped([](int const v){ return v; },i)); }
+
+    auto str{pool->runnableJoinTyped([]{ return std::string(100,'x'); })};
+    auto err{pool->runnableJoinTyped([]()->int{ throw std::runtime_error("typed error"); })};
+
+    int sum{};
+    for (auto & result : results) { sum += result.get(); }
+
+    try { static_cast<void>(err.get()); }
+    catch (std::exception const & e) { std::cerr << FUNC_SIGNATURE << " " << e.what() << "\n"; }
+
+    while (count.load() < 10000) { std::this_thread::yield(); }
+    std::cerr << FUNC_SIGNATURE << " count = " << count.load() << " sum = " << sum
+        << " str.size = " << str.get().size() << "\n";
+}
+
+void test16() {
+
+    auto const pool{XUtils::XThreadPool::create()};
+
+    auto const task{pool->runnableJoin([](int const v){ return std::string(static_cast<std::size_t>(v),'y'); },64)};
+    auto const future{task->future<std::string>()};
+    std::cerr << FUNC_SIGNATURE << " valid = " << future.valid()
+        << " mismatch valid = " << task->future<int>().valid() << "\n";
+    std::cerr << FUNC_SIGNATURE << " size = " << future.get().size()
+        << " result = " << task->result<std::string>().size() << "\n";
+
+    XUtils::XPromise<int> promise{};
+    auto const f{promise.getFuture()};
+    pool->runnableJoin([p = std::make_shared<XUtils::XPromise<int>>(std::move(promise))]{
+        XUtils::sleep_for_ms(10);
+        p->setValue(42);
+    });
+    std::cerr << FUNC_SIGNATURE << " ready in 1ms = " << f.waitFor(std::chrono::milliseconds(1))
+        << " value = " << f.get() << "\n";
+}
+
+void test17() {
+
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::WORK_STEALING)};
+
+    auto const a{pool->runnableJoin([]{ XUtils::sleep_for_ms(20); return 20; })};
+    auto const b{pool->runnableJoin([]{ return 22; })};
+
+    auto const sum{pool->then(XUtils::XThreadPool::whenAll(a,b),[fa = a->future<int>(),fb = b->future<int>()]{
+        return fa.get() + fb.get();
+    })};
+    auto const text{pool->then(sum,[](int const v){ return std::to_string(v); })};
+    auto const first{XUtils::XThreadPool::whenAny(a->future<int>(),b->future<int>())};
+    auto const err{pool->then(pool->then(sum,[](int)->int{ throw std::runtime_error("then error"); })
+        ,[](int const v){ return v; })};
+    auto const after{pool->then(a,[](XUtils::XAbstractRunnablePtr const & task){ return task->future<int>().get() * 2; })};
+
+    try { static_cast<void>(err.get()); }
+    catch (std::exception const & e) { std::cerr << FUNC_SIGNATURE << " " << e.what() << "\n"; }
+
+    std::cerr << FUNC_SIGNATURE << " text = " << text.get() << " first = " << first.get()
+        << " after = " << after.get() << "\n";
+}
+
+static XUtils::XTask<int> test18Square(XUtils::XThreadPoolPtr const pool,int const v) {
+    co_await pool->schedule();
+    co_return v * v;
+}
+
+static XUtils::XTask<int> test18Sum(XUtils::XThreadPoolPtr const pool) {
+    int sum{};
+    for (int i{1}; i <= 10; ++i) { sum += co_await test18Square(pool,i); }
+    auto const task{pool->runnableJoin([]{ XUtils::sleep_for_ms(10); return 100; })};
+    co_await task;
+    sum += co_await task->future<int>();
+    co_await pool->schedule();
+    co_return sum;
+}
+
+static XUtils::XTask<> test18Throw() {
+    throw std::runtime_error("coroutine error");
+    co_return;
+}
+
+void test18() {
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::WORK_STEALING)};
+    auto const sum{pool->spawn(test18Sum(pool))};
+    auto const err{pool->spawn(test18Throw())};
+    try { err.get(); }
+    catch (std::exception const & e) { std::cerr << FUNC_SIGNATURE << " " << e.what() << "\n"; }
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum.get() << "\n";
+}
+
+void test19() {
+    using Priority = XUtils::XTaskOptions::Priority;
+    auto const pool{XUtils::XThreadPool::create()};
+    pool->start(1);
+
+    std::promise<void> gate{},started{};
+    pool->runnableJoin([&started,f = gate.get_future().share()]{ started.set_value(); f.wait(); });
+    started.get_future().wait();
+
+    std::mutex orderMtx{};
+    std::string order{};
+    auto const record{[&](char const c){ std::unique_lock lock(orderMtx); order += c; }};
+
+    pool->runnableJoin(XUtils::XTaskOptions{Priority::LOW},record,'L');
+    pool->runnableJoin(record,'N');
+    pool->runnableJoin(XUtils::XTaskOptions{Priority::CRITICAL},record,'C');
+    auto const expired{pool->runnableJoin(XUtils::XTaskOptions::within(std::chrono::milliseconds{1},Priority::HIGH),record,'E')};
+    pool->runnableJoin(XUtils::XTaskOptions{Priority::HIGH},record,'H');
+
+    XUtils::sleep_for_ms(20);
+    gate.set_value();
+    static_cast<void>(expired->future<void>().waitFor(std::chrono::seconds{1}));
+    static_cast<void>(pool->runnableJoin(XUtils::XTaskOptions{Priority::LOW},[]{})->future<void>().waitFor(std::chrono::seconds{1}));
+
+    std::unique_lock lock(orderMtx);
+    std::cerr << FUNC_SIGNATURE << " order = " << order << " expired = " << pool->expiredTasksSize() << "\n";
+}
+
+void test20() {
+    XUtils::XThreadPoolConfig config{};
+    config.m_cpus = {0};
+    config.m_numaSpread = true;
+    config.m_threadName = "xpool";
+    config.m_stackSize = 1 << 20;
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::WORK_STEALING,std::move(config))};
+    auto const task{pool->runnableJoin([]{
+        std::string name{"unknown"};
+#if defined(__linux__)
+        char buf[16]{};
+        if (!pthread_getname_np(pthread_self(),buf,sizeof(buf))) { name = buf; }
+        name += " cpu " + std::to_string(sched_getcpu());
+#endif
+        return name;
+    })};
+    std::cerr << FUNC_SIGNATURE << " " << task->future<std::string>().get() << "\n";
+}
+
+void test21() {
+    for (auto const spin : {0u,1024u}) {
+        XUtils::XThreadPoolConfig config{};
+        config.m_spinCount = spin;
+        config.m_yieldCount = spin ? 16 : 0;
+        auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED,std::move(config))};
+        pool->start(2);
+        constexpr auto count{2000};
+        auto const begin{std::chrono::steady_clock::now()};
+        for (int i{}; i < count; ++i) { pool->runnableJoinTyped([i]{ return i; }).get(); }
+        auto const us{std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count()};
+        std::cerr << FUNC_SIGNATURE << " spin = " << spin << " round trip = " << static_cast<double>(us) / count << "us\n";
+    }
+}
+
+void test22() {
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::LOCK_FREE)};
+    pool->start(4);
+    std::atomic_int sum{};
+    std::vector<std::thread> producers{};
+    for (int p{}; p < 4; ++p) {
+        producers.emplace_back([&pool,&sum]{
+            std::vector<XUtils::XTaskResult<int>> futures{};
+            for (int i{}; i < 1000; ++i) {
+                futures.push_back(pool->runnableJoinTyped([&pool,&sum,i]{
+                    // 工作线程内提交走显式生产者令牌
+                    if (!(i % 100)) { pool->runnableJoinDetached([&sum]{ sum.fetch_add(1); }); }
+                    return i;
+                }));
+            }
+            for (auto & f : futures) { sum.fetch_add(f.get()); }
+        });
+    }
+    for (auto & th : producers) { th.join(); }
+    pool->stop();
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum.load() << " remain = " << pool->currentTasksSize() << "\n";
+}
+
+void test23() {
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::WORK_STEALING)};
+    pool->start(4);
+    using XUtils::XParallel;
+    std::vector<std::int64_t> values(1 << 20);
+    XParallel::parallelFor(*pool,0,values.size(),0,[&values](std::size_t const i){ values[i] = static_cast<std::int64_t>(i); });
+    auto const sum{XParallel::parallelReduce(*pool,values,0,std::int64_t{})};
+    std::vector<std::int64_t> squares(values.size()),prefix(values.size());
+    XParallel::parallelTransform(*pool,values,squares.begin(),0,[](auto const v){ return v % 7; });
+    XParallel::parallelScan(*pool,squares,prefix.begin(),0,std::int64_t{});
+    std::mt19937 engine{42};
+    std::ranges::shuffle(values,engine);
+    XParallel::parallelSort(*pool,values);
+    std::string error{};
+    try {
+        XParallel::parallelFor(*pool,0,1000,10,[](std::size_t const i){ if (500 == i) { throw std::runtime_error("parallel error"); } });
+    } catch (std::exception const & e) { error = e.what(); }
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum << " scan = " << prefix.back()
+        << " sorted = " << std::ranges::is_sorted(values) << " " << error << "\n";
+}
+
+void test24() {
+    using namespace std::chrono_literals;
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::CACHE)};
+    pool->setThreadsSizeThreshold(16);
+    pool->setThreadTimeout(1);
+    pool->start();
+    XUtils::XElasticConfig elastic{};
+    elastic.m_targetLatency = 500us;
+    elastic.m_maxGrowStep = 2;
+    elastic.m_minThreads = 1;
+    elastic.m_shrinkDelay = 200ms;
+    elastic.m_shrinkInterval = 50ms;
+    pool->setElasticConfig(elastic);
+    std::vector<XUtils::XTaskResult<void>> results{};
+    for (int i{}; i < 200; ++i) { results.push_back(pool->runnableJoinTyped([]{ std::this_thread::sleep_for(2ms); })); }
+    XUtils::XSize_t peak{};
+    for (auto & r : results) {
+        peak = std::max(peak,pool->currentThreadsSize());
+        r.get();
+    }
+    std::this_thread::sleep_for(3s);
+    std::cerr << FUNC_SIGNATURE << " peak = " << peak << " after idle = " << pool->currentThreadsSize() << "\n";
+}
+
+void test25() {
+    std::atomic_int traces{};
+    XUtils::XThreadPoolConfig config{};
+    config.m_collectTimings = true;
+    config.m_traceHook = [&traces](XUtils::XTaskTrace const & trace) {
+        if (trace.m_end >= trace.m_start && trace.m_start >= trace.m_enqueue) { traces.fetch_add(1); }
+    };
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::WORK_STEALING,std::move(config))};
+    pool->start(4);
+    std::vector<XUtils::XTaskResult<void>> results{};
+    for (int i{}; i < 100; ++i) {
+        results.push_back(pool->runnableJoinTyped([&pool]{
+            for (int j{}; j < 9; ++j) { pool->runnableJoinDetached([]{ std::this_thread::sleep_for(std::chrono::microseconds{50}); }); }
+        }));
+    }
+    for (auto & r : results) { r.get(); }
+    while (pool->metrics().m_completed < 1000) { std::this_thread::sleep_for(std::chrono::milliseconds{1}); }
+    auto const workers{pool->metrics().m_workers.size()};
+    pool->stop();
+    auto const m{pool->metrics()};
+    std::cerr << FUNC_SIGNATURE << " submitted = " << m.m_submitted << " completed = " << m.m_completed
+        << " rejected = " << m.m_rejected << " traces = " << traces.load() << " wait samples = " << m.m_queueWait.m_count
+        << " run samples = " << m.m_runTime.m_count << " workers = " << workers
+        << " p99 run = " << m.m_runTime.percentile(0.99).count() << "us\n";
+}
+
+void test26() {
+    using Kind = XUtils::XPoolEvent::Kind;
+    std::mutex m{};
+    std::map<Kind,int> events{};
+    XUtils::XThreadPoolConfig config{};
+    config.m_eventLevel = XUtils::XPoolEvent::Level::DEBUG_LEVEL;
+    config.m_eventSink = [&](XUtils::XPoolEvent const & event) {
+        std::unique_lock lock(m);
+        ++events[event.m_kind];
+    };
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED,std::move(config))};
+    pool->setTasksSizeThreshold(1);
+    pool->start(1);
+    XUtils::XPromise<void> gate{};
+    auto const opened{gate.getFuture()};
+    auto const blocker{pool->runnableJoinTyped([&opened]{ opened.wait(); })};
+    while (pool->busyThreadsSize() < 1) { std::this_thread::yield(); }
+    auto const queued{pool->runnableJoinTyped([]{})};
+    auto const rejected{pool->runnableJoinTyped([]{})};
+    pool->setConfig({});
+    gate.setValue();
+    pool->stop();
+    std::unique_lock lock(m);
+    std::cerr << FUNC_SIGNATURE << " started = " << events[Kind::POOL_STARTED] << " rejected = " << events[Kind::TASK_REJECTED]
+        << " invalid call = " << events[Kind::INVALID_CALL] << " exited = " << events[Kind::THREAD_EXITED]
+        << " metrics rejected = " << pool->metrics().m_rejected << "\n";
+}
+
+void test27() {
+    using Overflow = XUtils::XTaskOptions::Overflow;
+    auto const status{[](XUtils::XSubmitResult const & r) { return static_cast<int>(r.m_status); }};
+    auto const blocked{[](XUtils::XThreadPoolConfig config,XUtils::XSize_t const threshold,XUtils::XPromise<void> & gate) {
+        auto pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED,std::move(config))};
+        pool->setTasksSizeThreshold(threshold);
+        pool->start(1);
+        pool->runnableJoinDetached([opened = gate.getFuture()]{ opened.wait(); });
+        while (pool->busyThreadsSize() < 1) { std::this_thread::yield(); }
+        return pool;
+    }};
+
+    XUtils::XPromise<void> gate{};
+    auto const pool{blocked({},1,gate)};
+    std::atomic_int oldest{},newest{};
+    std::atomic_bool inCaller{};
+    auto const queued{pool->tryRunnableJoin([&oldest]{ ++oldest; })};
+    auto const full{pool->tryRunnableJoin([]{})};
+    XUtils::XTaskOptions options{};
+    options.m_overflow = Overflow::BLOCK;
+    options.m_blockTimeout = std::chrono::milliseconds{10};
+    auto const timedOut{pool->tryRunnableJoin(options,[]{})};
+    options.m_overflow = Overflow::CALLER_RUNS;
+    auto const id{std::this_thread::get_id()};
+    auto const ran{pool->tryRunnableJoin(options,[&inCaller,id]{ inCaller = std::this_thread::get_id() == id; })};
+    options.m_overflow = Overflow::DROP_OLDEST;
+    auto const replaced{pool->tryRunnableJoin(options,[&newest]{ ++newest; })};
+    gate.setValue();
+    pool->stop();
+
+    XUtils::XThreadPoolConfig config{};
+    config.m_producerQuota = 1;
+    XUtils::XPromise<void> quotaGate{};
+    auto const quotaPool{blocked(std::move(config),8,quotaGate)};
+    auto const first{quotaPool->tryRunnableJoin([]{})};
+    auto const second{quotaPool->tryRunnableJoin([]{})};
+    quotaGate.setValue();
+    quotaPool->stop();
+
+    std::cerr << FUNC_SIGNATURE << " queued = " << status(queued) << " full = " << status(full) << " timed out = " << status(timedOut)
+        << " caller runs = " << status(ran) << "/" << inCaller << " drop oldest = " << status(replaced) << " oldest ran = " << oldest
+        << " newest ran = " << newest << " rejected = " << pool->metrics().m_rejected
+        << " quota = " << status(first) << "/" << status(second) << "\n";
+}
+
+void test28() {
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED)};
+    pool->start(2);
+    XUtils::XCancellationSource group{};
+    XUtils::XCancellationSource child{group.token()};
+    XUtils::XTaskOptions groupOptions{},childOptions{};
+    groupOptions.m_token = group.token();
+    childOptions.m_token = child.token();
+
+    std::atomic_bool started{},observed{};
+    pool->runnableJoinDetached(groupOptions,[&started,&observed]{
+        started = true;
+        while (!XUtils::XCancellationToken::current().isCancelled()) { std::this_thread::yield(); }
+        observed = true;
+    });
+    XUtils::XPromise<void> gate{};
+    pool->runnableJoinDetached([opened = gate.getFuture()]{ opened.wait(); });
+    while (!started || pool->busyThreadsSize() < 2) { std::this_thread::yield(); }
+
+    std::atomic_int ran{};
+    for (int i{}; i < 100; ++i) { pool->runnableJoinDetached(childOptions,[&ran]{ ++ran; }); }
+    auto const task{pool->runnableJoin(childOptions,[&ran]{ ++ran; return 1; })};
+    auto const continuation{pool->then(task,[&ran]{ ++ran; return 2; })};
+    group.cancel();
+    gate.setValue();
+
+    bool broken{};
+    try { static_cast<void>(continuation.get()); } catch (std::future_error const &) { broken = true; }
+    auto const late{pool->tryRunnableJoin(childOptions,[&ran]{ ++ran; })};
+    pool->stop();
+    std::cerr << FUNC_SIGNATURE << " ran = " << ran << " observed = " << observed << " child cancelled = " << child.isCancelled()
+        << " continuation broken = " << broken << " late = " << static_cast<int>(late.m_status)
+        << " cancelled = " << pool->cancelledTasksSize() << "\n";
+}
+
+void test29() {
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED)};
+    pool->start(1);
+    std::atomic_int sum{};
+    {
+        XUtils::XTaskGroup outer{*pool};
+        for (int i{}; i < 4; ++i) {
+            outer.run([&pool,&sum]{
+                // 唯一的工作线程在内层等待时执行内层的任务
+                XUtils::XTaskGroup inner{*pool};
+                for (int j{1}; j <= 8; ++j) { inner.run([&sum,j]{ sum += j; }); }
+                inner.wait();
+            });
+        }
+        outer.wait();
+    }
+
+    std::atomic_int ran{};
+    std::string error{};
+    XUtils::XTaskGroup failing{*pool};
+    failing.run([]{ throw std::runtime_error("first"); });
+    for (int i{}; i < 100; ++i) { failing.run([&ran]{ ++ran; }); }
+    try { failing.wait(); } catch (std::runtime_error const & e) { error = e.what(); }
+
+    XUtils::XTaskGroup cancelled{*pool};
+    cancelled.cancel();
+    auto const accepted{cancelled.run([&ran]{ ++ran; })};
+    cancelled.wait();
+    pool->stop();
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum << " error = " << error << " failing cancelled = " << failing.isCancelled()
+        << " ran after failure <= 100 : " << (ran <= 100) << " accepted after cancel = " << accepted << "\n";
+}
+
+void test30() {
+    using namespace std::chrono;
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED)};
+    pool->start(2);
+    auto const begin{steady_clock::now()};
+    std::atomic<steady_clock::duration::rep> after{};
+    std::atomic_bool at{};
+    std::atomic_int ticks{},fired{};
+    // 超过第0层的256毫秒,经过一次重新分配
+    std::atomic_bool cascaded{};
+    pool->runAfter(300ms,[&cascaded]{ cascaded = true; });
+    auto const once{pool->runAfter(20ms,[&after,begin]{ after = (steady_clock::now() - begin).count(); })};
+    pool->runAt(system_clock::now() + 30ms,[&at]{ at = true; });
+    auto periodic{pool->runEvery(5ms,[&ticks]{ ++ticks; })};
+    std::vector<XUtils::XTimer> timers{};
+    for (int i{}; i < 1000; ++i) { timers.push_back(pool->runAfter(50ms,[&fired]{ ++fired; })); }
+    int cancelled{};
+    for (std::size_t i{}; i < timers.size(); i += 2) { cancelled += timers[i].cancel(); }
+    std::this_thread::sleep_for(120ms);
+    auto const stopped{periodic.cancel()};
+    auto const count{ticks.load()};
+    std::this_thread::sleep_for(250ms);
+    pool->stop();
+    std::cerr << FUNC_SIGNATURE << " after >= 20ms = " << (steady_clock::duration{after.load()} >= 20ms) << " at = " << at
+        << " once active = " << once.isActive() << " periodic ticks >= 10 = " << (count >= 10) << " periodic cancelled = " << stopped
+        << " cancelled = " << cancelled << " fired = " << fired << " cascaded = " << cascaded << "\n";
+}
+
+void test31() {
+    using namespace std::chrono;
+    std::atomic_int released{};
+    XUtils::XTaskResult<int> late{};
+    {
+        auto pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED)};
+        pool->start(2);
+        // 最后一个结果句柄在任务中释放,线程池只由本线程持有,不会在工作线程上析构
+        for (int i{}; i < 100; ++i) {
+            auto value{pool->runnableJoinTyped([]{ return std::string(100,'z'); })};
+            pool->runnableJoinDetached([result = std::move(value),&released]() mutable {
+                std::this_thread::sleep_for(1ms);
+                released += 100 == result.get().size();
+            });
+        }
+        late = pool->runnableJoinTyped([]{ return 7; });
+        late.wait();
+        pool.reset();
+    }
+    // 线程池析构后结果仍然有效,任务槽随最后一个句柄归还
+    std::cerr << FUNC_SIGNATURE << " released <= 100 = " << (released.load() <= 100)
+        << " late = " << late.get() << "\n";
+}
+
+static XUtils::XTask<long long> test32Await(XUtils::XThreadPool & pool,int const count) {
+    long long sum{};
+    for (int i{}; i < count; ++i) {
+        // 结果与注册回调竞争,注册时已就绪则在本栈帧继续,不在await_suspend内嵌套恢复
+        auto const promise{std::make_shared<XUtils::XPromise<int>>()};
+        auto const future{promise->getFuture()};
+        pool.runnableJoinDetached([promise,i]{ promise->setValue(i); });
+        sum += co_await future;
+    }
+    co_return sum;
+}
+
+void test32() {
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED)};
+    pool->start(2);
+    constexpr int count{20000};
+    auto const sum{pool->spawn(test32Await(*pool,count))};
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum.get()
+        << " expected = " << static_cast<long long>(count) * (count - 1) / 2 << "\n";
+}
+
+void test33() {
+    XUtils::XThreadPoolConfig config{};
+    config.m_numaSpread = true;
+    auto const pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::WORK_STEALING,std::move(config))};
+    pool->setTasksSizeThreshold(64);
+    pool->start(4);
+    constexpr int producers{4},count{5000};
+    std::atomic_llong sum{};
+    std::atomic_int done{};
+    std::vector<std::thread> threads{};
+    for (int p{}; p < producers; ++p) {
+        threads.emplace_back([&pool,&sum,&done]{
+            XUtils::XTaskOptions options{};
+            options.m_overflow = XUtils::XTaskOptions::Overflow::BLOCK;
+            options.m_blockTimeout = std::chrono::seconds{10};
+            for (int i{}; i < count; ++i) {
+                options.m_priority = i % 100 ? XUtils::XTaskOptions::Priority::NORMAL : XUtils::XTaskOptions::Priority::HIGH;
+                pool->runnableJoin(options,[&sum,&done,i]{ sum += i; ++done; });
+            }
+        });
+    }
+    for (auto & th : threads) { th.join(); }
+    for (int i{}; i < 10000 && done.load() < producers * count; ++i) { XUtils::sleep_for_ms(1); }
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum.load()
+        << " expected = " << static_cast<long long>(producers) * count * (count - 1) / 2
+        << " rejected = " << pool->metrics().m_rejected << "\n";
+}
+
+static XUtils::XTask<int> test34Value(int const value) { co_return value; }
+
+void test34() {
+    // spawn的协程帧不持有线程池,get返回后立即释放,线程池应在调用线程析构
+    std::atomic_int invalid{};
+    int sum{};
+    for (int i{}; i < 200; ++i) {
+        XUtils::XThreadPoolConfig config{};
+        config.m_eventSink = [&invalid](XUtils::XPoolEvent const & event)
+        { if (XUtils::XPoolEvent::Kind::INVALID_CALL == event.m_kind) { ++invalid; } };
+        auto pool{XUtils::XThreadPool::create(XUtils::XThreadPool::Mode::FIXED,std::move(config))};
+        pool->start(2);
+        sum += pool->spawn(test34Value(i)).get();
+        pool.reset();
+    }
+    std::cerr << FUNC_SIGNATURE << " sum = " << sum << " expected = " << 199 * 200 / 2 << " invalid = " << invalid << "\n";
+}
+
 int main(){
     test1();
     //test2();
@@ -718,5 +1275,27 @@ int main(){
     //test10();
     //test11();
     test12();
+    test13();
+    test14();
+    test15();
+    test16();
+    test17();
+    test18();
+    test19();
+    test20();
+    test21();
+    test22();
+    test23();
+    test24();
+    test25();
+    test26();
+    test27();
+    test28();
+    test29();
+    test30();
+    test31();
+    test32();
+    test33();
+    test34();
     return 0;
 }
@@ -1,7 +1,12 @@
 #include <XLog/xlog.hpp>
 #include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
 #include <thread>
 #include <vector>
+#include <algorithm>
+#include <limits>
 
 using namespace XUtils;
 
@@ -158,6 +163,418 @@ void testPerformance() {
     std::cout << "Performance test completed.\n";
 }
 
+/**
+ * @brief 快速路径测试 - 调用线程只保存原始记录,格式化由工作线程完成
+ * 队列容量大于记录数且策略为DROP_NEWEST,调用线程不会等待工作线程,测得的是调用方的开销
+ */
+void testFastPath() {
+    std::cout << "\n=== Testing Fast Path ===\n";
+
+    auto const logger{XlogHandle()};
+    logger->setOutput(LogOutput::FILE);
+    logger->setLogFileConfig("test_fast_path", "test_logs", 1024, 7);
+    logger->setOverflowPolicy(LogOverflow::DROP_NEWEST);
+    logger->setLogLevel(LogLevel::INFO_LEVEL);
+    // 队列在线程第一次写日志时按当前容量创建,计时在新线程中进行
+    logger->setAsyncQueueSize(1 << 16);
+
+    constexpr int test_count {1 << 14}, rounds {5};
+    std::string const long_message(300, 'x');
+    auto const dropped {logger->getDroppedCount()};
+    std::int64_t best {std::numeric_limits<std::int64_t>::max()};
+
+    for (int round {}; round < rounds; ++round) {
+        std::thread([&best, logger] {
+            XLOG_INFO("warm up message");
+            logger->flush();
+            auto const start {std::chrono::steady_clock::now()};
+            for (int i {}; i < test_count; ++i) {
+                XLOG_INFO("fast path message");
+            }
+            auto const elapsed {std::chrono::steady_clock::now() - start};
+            best = std::min<std::int64_t>(best, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / test_count);
+            logger->flush();
+        }).join();
+    }
+    XLOG_INFO(long_message);
+    logger->flush();
+
+    std::ifstream file(logger->getCurrentLogFile());
+    int matched {}, long_matched {};
+    for (std::string line {}; std::getline(file, line);) {
+        if (line.find("test_xlog.cpp:") != std::string::npos
+            && line.find("testFastPath") != std::string::npos
+            && line.ends_with("() - fast path message")) { ++matched; }
+        if (line.ends_with(long_message)) { ++long_matched; }
+    }
+
+    std::cout << "caller cost: " << best << " ns/call (best of " << rounds << ")"
+              << ", written = " << matched << "/" << test_count * rounds
+              << " dropped = " << logger->getDroppedCount() - dropped
+              << " long = " << long_matched << "\n";
+
+    logger->setAsyncQueueSize(0);
+    logger->setOverflowPolicy(LogOverflow::DROP_OLDEST);
+    logger->setOutput(LogOutput::BOTH);
+}
+
+/**
+ * @brief 线程队列测试 - 每个线程独立的无锁队列及其溢出策略
+ */
+void testThreadQueues() {
+    std::cout << "\n=== Testing Thread Queues ===\n";
+
+    auto const logger{XlogHandle()};
+    logger->setOutput(LogOutput::FILE);
+    logger->setLogFileConfig("test_thread_queues", "test_logs", 1024, 7);
+    logger->setLogLevel(LogLevel::INFO_LEVEL);
+
+    auto const count_lines{[logger](std::string_view const & marker) {
+        logger->flush();
+        std::ifstream file(logger->getCurrentLogFile());
+        int matched {};
+        for (std::string line {}; std::getline(file, line);) {
+            if (line.find(marker) != std::string::npos) { ++matched; }
+        }
+        return matched;
+    }};
+
+    auto const run{[](int const num_threads, int const messages_per_thread, char const * const message) {
+        std::vector<std::thread> threads{};
+        for (int t {}; t < num_threads; ++t) {
+            threads.emplace_back([messages_per_thread, message] {
+                for (int i {}; i < messages_per_thread; ++i) { XLOG_INFO(message); }
+            });
+        }
+        for (auto & thread : threads) { thread.join(); }
+    }};
+
+    // BLOCK: 队列满时等待,全部写出
+    logger->setOverflowPolicy(LogOverflow::BLOCK);
+    logger->setAsyncQueueSize(64);
+    auto dropped {logger->getDroppedCount()};
+    run(8, 5000, "blocking queue message");
+    auto const blocked {count_lines("blocking queue message")};
+    auto const blocked_dropped {logger->getDroppedCount() - dropped};
+
+    // DROP_NEWEST / DROP_OLDEST: 写出的与丢弃的合计等于总数
+    logger->setOverflowPolicy(LogOverflow::DROP_NEWEST);
+    dropped = logger->getDroppedCount();
+    run(4, 5000, "drop newest message");
+    auto const newest {count_lines("drop newest message")};
+    auto const newest_dropped {logger->getDroppedCount() - dropped};
+
+    logger->setOverflowPolicy(LogOverflow::DROP_OLDEST);
+    dropped = logger->getDroppedCount();
+    run(4, 5000, "drop oldest message");
+    auto const oldest {count_lines("drop oldest message")};
+    auto const oldest_dropped {logger->getDroppedCount() - dropped};
+
+    std::cout << "block written = " << blocked << "/40000 dropped = " << blocked_dropped
+              << " drop newest total = " << newest + newest_dropped
+              << " drop oldest total = " << oldest + oldest_dropped
+              << " queue size = " << logger->getQueueSize() << "\n";
+
+    logger->setAsyncQueueSize(0);
+    logger->setOutput(LogOutput::BOTH);
+}
+
+/**
+ * @brief 文件写入策略测试 - 成批写入,按策略决定写入时机
+ */
+void testFileSink() {
+    std::cout << "\n=== Testing File Sink ===\n";
+
+    auto const logger{XlogHandle()};
+    logger->setOutput(LogOutput::FILE);
+    logger->setLogFileConfig("test_file_sink", "test_logs", 1024, 7);
+    logger->setLogLevel(LogLevel::INFO_LEVEL);
+
+    auto const count_lines{[logger](std::string_view const & marker) {
+        std::ifstream file(logger->getCurrentLogFile());
+        int matched {};
+        for (std::string line {}; std::getline(file, line);) {
+            if (line.find(marker) != std::string::npos) { ++matched; }
+        }
+        return matched;
+    }};
+
+    // 不调用flush,轮询等待工作线程写入
+    auto const wait_lines{[&count_lines](std::string_view const & marker, int const expected) {
+        auto matched {count_lines(marker)};
+        for (int i {}; i < 200 && matched < expected; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            matched = count_lines(marker);
+        }
+        return matched;
+    }};
+
+    // EVERY_BATCH: 每批写入一次
+    logger->setFlushPolicy(LogFlushPolicy::EVERY_BATCH);
+    for (int i {}; i < 1000; ++i) { XLOG_INFO("every batch message"); }
+    auto const every_batch {wait_lines("every batch message", 1000)};
+
+    // INTERVAL: 到达间隔后写入
+    logger->setFlushPolicy(LogFlushPolicy::INTERVAL, std::chrono::milliseconds{50});
+    for (int i {}; i < 10; ++i) { XLOG_INFO("interval message"); }
+    auto const interval {wait_lines("interval message", 10)};
+
+    // ON_ERROR: INFO留在缓冲中,出现ERROR时一并写入
+    logger->setFlushPolicy(LogFlushPolicy::ON_ERROR);
+    for (int i {}; i < 10; ++i) { XLOG_INFO("on error message"); }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto const before_error {count_lines("on error message")};
+    XLOG_ERROR("on error message");
+    auto const after_error {wait_lines("on error message", 11)};
+
+    std::cout << "every batch = " << every_batch << "/1000 interval = " << interval
+              << "/10 on error before = " << before_error << " after = " << after_error << "/11\n";
+
+    logger->setFlushPolicy(LogFlushPolicy::EVERY_BATCH);
+    logger->setOutput(LogOutput::BOTH);
+}
+
+/**
+ * @brief 时间戳测试 - 缓存格式化、精度与单调时钟锚点
+ */
+void testTimestamps() {
+    std::cout << "\n=== Testing Timestamps ===\n";
+
+    auto const logger{XlogHandle()};
+    logger->setOutput(LogOutput::FILE);
+    logger->setLogLevel(LogLevel::INFO_LEVEL);
+
+    constexpr int test_count {100000};
+    std::size_t total_size {};
+    auto const start {std::chrono::steady_clock::now()};
+    for (int i {}; i < test_count; ++i) { total_size += XLog::getCurrentTimestamp().size(); }
+    auto const elapsed {std::chrono::steady_clock::now() - start};
+
+    // 返回时间戳方括号内的长度,MONOTONIC时为"+"开头
+    auto const last_stamp{[logger](std::string_view const & marker) {
+        logger->flush();
+        std::ifstream file(logger->getCurrentLogFile());
+        std::string stamp {};
+        for (std::string line {}; std::getline(file, line);) {
+            if (line.find(marker) != std::string::npos && line.starts_with('[')) {
+                stamp = line.substr(1, line.find(']') - 1);
+            }
+        }
+        return stamp;
+    }};
+
+    logger->setLogFileConfig("test_timestamps", "test_logs", 1024, 7);
+    logger->setTimestampFormat(LogTimePrecision::MICROSECONDS);
+    XLOG_INFO("microseconds stamp");
+    auto const micro {last_stamp("microseconds stamp")};
+    logger->setTimestampFormat(LogTimePrecision::NANOSECONDS);
+    XLOG_INFO("nanoseconds stamp");
+    auto const nano {last_stamp("nanoseconds stamp")};
+
+    logger->setTimestampFormat(LogTimePrecision::MICROSECONDS, LogTimestamp::MONOTONIC);
+    logger->setLogFileConfig("test_monotonic", "test_logs", 1024, 7);
+    XLOG_INFO("monotonic stamp");
+    auto const monotonic {last_stamp("monotonic stamp")};
+    auto const anchor {last_stamp("[ANCHOR]")};
+
+    std::cout << "cached timestamp: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / test_count
+              << " ns/call, ms width = " << total_size / test_count
+              << " us width = " << micro.size() << " ns width = " << nano.size()
+              << " monotonic = " << monotonic.starts_with('+')
+              << " anchor width = " << anchor.size() << "\n";
+
+    logger->setTimestampFormat(LogTimePrecision::MILLISECONDS);
+    logger->setOutput(LogOutput::BOTH);
+}
+
+/**
+ * @brief 格式化参数测试 - 编译期检查的格式串与工作线程格式化
+ */
+void testFormatArguments() {
+    std::cout << "\n=== Testing Format Arguments ===\n";
+
+    auto const logger{XlogHandle()};
+    logger->setOutput(LogOutput::FILE);
+    logger->setLogLevel(LogLevel::INFO_LEVEL);
+    logger->setLogFileConfig("test_format", "test_logs", 1024, 7);
+    auto const policy {logger->getOverflowPolicy()};
+    logger->setOverflowPolicy(LogOverflow::BLOCK);
+    auto const dropped {logger->getDroppedCount()};
+
+    enum Color { RED, GREEN };
+    std::string const text {"string"};
+    std::string_view const view {"view!"};
+    char const * const null_text {};
+    std::string const long_text(300, 'x');
+    XLOGF_INFO("args %s|%s|%.3s|%s|%-4d|%05u|%x|%c|%d", text, view, "literal", null_text, -7, 42u, 255, 'A', GREEN);
+    XLOGF_INFO("floats %.2f|%.3Lf|%g|%*.*f|%%", 1.005f, 2.5L, 1e20, 8, 2, 3.14159);
+    XLOGF_INFO("wide %lld|%hhu|%zu|%p", -1234567890123LL, static_cast<unsigned char>(200), std::size_t{77}, nullptr);
+    XLOGF_INFO("long [%s] tail %d", long_text, 9);
+
+    constexpr int test_count {100000};
+    auto const start {std::chrono::steady_clock::now()};
+    for (int i {}; i < test_count; ++i) { XLOGF_INFO("format cost %d %.2f %s", i, i * 0.5, text); }
+    auto const elapsed {std::chrono::steady_clock::now() - start};
+    logger->flush();
+
+    std::ifstream file(logger->getCurrentLogFile());
+    std::string line {};
+    std::size_t matched {}, costs {};
+    std::array<std::string_view, 4> const expected {
+        "args string|view!|lit|(null)|-7  |00042|ff|A|1",
+        "floats 1.00|2.500|1e+20|    3.14|%",
+        "wide -1234567890123|200|77|",
+        "tail 9"
+    };
+    while (std::getline(file, line)) {
+        for (auto const & e : expected) { if (line.find(e) != std::string::npos) { ++matched; } }
+        if (line.find("long [" + long_text + "] tail 9") != std::string::npos) { ++matched; }
+        if (line.find("format cost ") != std::string::npos) { ++costs; }
+    }
+
+    std::cout << "format cost: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / test_count
+              << " ns/call, matched = " << matched << "/5 written = " << costs << "/" << test_count
+              << " dropped = " << logger->getDroppedCount() - dropped << "\n";
+
+    logger->setOverflowPolicy(policy);
+    logger->setOutput(LogOutput::BOTH);
+}
+
+/**
+ * @brief 二进制日志测试 - 写入.xlb文件、跨文件轮转,再还原为文本
+ */
+void testBinarySink() {
+    std::cout << "\n=== Testing Binary Sink ===\n";
+
+    auto const logger{XlogHandle()};
+    logger->setLogLevel(LogLevel::INFO_LEVEL);
+    auto const policy {logger->getOverflowPolicy()};
+    logger->setOverflowPolicy(LogOverflow::BLOCK);
+
+    // 同一批消息分别以文本和二进制写入,比较文件大小
+    auto const write_files{[logger](std::string_view const & base, LogOutput const output, int const count) {
+        for (auto const & entry : std::filesystem::directory_iterator("test_logs")) {
+            if (entry.path().filename().string().starts_with(base)) { std::filesystem::remove(entry.path()); }
+        }
+        logger->setOutput(output);
+        logger->setLogFileConfig(base, "test_logs", 1, 7);
+        std::string const text {"binary payload"};
+        for (int i {}; i < count; ++i) {
+            XLOGF_INFO("request %d took %.3f ms from %s", i, i * 0.25, text);
+            if (!(i % 1000)) { XLOG_WARN("plain checkpoint"); }
+        }
+        logger->flush();
+
+        std::vector<std::filesystem::path> files {};
+        std::uintmax_t size {};
+        for (auto const & entry : std::filesystem::directory_iterator("test_logs")) {
+            if (entry.path().filename().string().starts_with(base)) {
+                files.push_back(entry.path());
+                size += entry.file_size();
+            }
+        }
+        std::ranges::sort(files);
+        return std::pair{files, size};
+    }};
+
+    constexpr int test_count {100000};
+    auto const [text_files, text_size] {write_files("test_text_sink", LogOutput::FILE, test_count)};
+    auto const [binary_files, binary_size] {write_files("test_binary_sink", LogOutput::BINARY, test_count)};
+    logger->setOutput(LogOutput::BOTH);
+    logger->setOverflowPolicy(policy);
+
+    // 逐个文件解码,轮转后的文件也能独立还原
+    std::size_t lines {}, matched {}, decoded_ok {};
+    std::string first {};
+    for (auto const & path : binary_files) {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream out {};
+        decoded_ok += XLog::decodeBinaryLog(in, out);
+        std::istringstream decoded {out.str()};
+        for (std::string line {}; std::getline(decoded, line); ++lines) {
+            if (first.empty()) { first = line; }
+            if (line.find("request 4321 took 1080.250 ms from binary payload") != std::string::npos
+                || line.find("[WARN]") != std::string::npos) { ++matched; }
+        }
+    }
+
+    std::cout << "binary files = " << binary_files.size() << " decoded = " << decoded_ok
+              << " lines = " << lines << "/" << test_count + test_count / 1000
+              << " matched = " << matched << "/" << 1 + test_count / 1000
+              << " text/binary size = " << text_size << "/" << binary_size
+              << " (" << (binary_size ? text_size / binary_size : 0) << "x)\n"
+              << "decoded: " << first << "\n";
+}
+
+/**
+ * @brief 模块级别测试 - 单独打开一个模块的DEBUG,关闭的级别不求值参数
+ */
+#undef XLOG_MODULE
+#define XLOG_MODULE "xlog-test-net"
+static void logNetDebug(int const i)
+{ XLOGF_DEBUG("module debug %d", i); }
+#undef XLOG_MODULE
+#define XLOG_MODULE nullptr
+
+void testModuleLevels() {
+    std::cout << "\n=== Testing Module Levels ===\n";
+
+    auto const logger{XlogHandle()};
+    logger->setOutput(LogOutput::FILE);
+    logger->setLogLevel(LogLevel::INFO_LEVEL);
+    logger->setLogFileConfig("test_module", "test_logs", 1024, 7);
+    auto const policy {logger->getOverflowPolicy()};
+    logger->setOverflowPolicy(LogOverflow::BLOCK);
+
+    int evaluated {};
+    auto const argument {[&evaluated] { ++evaluated; return std::string{"evaluated"}; }};
+
+    // 全局INFO,模块单独打开DEBUG
+    logger->setModuleLogLevel("xlog-test-net", LogLevel::DEBUG_LEVEL);
+    logNetDebug(1);
+    XLOGF_DEBUG("global debug %d", 1);
+    XLOG_DEBUG(argument());
+    auto const module_level {logger->getModuleLogLevel("xlog-test-net")};
+
+    // 恢复跟随全局级别,随全局级别变化
+    logger->resetModuleLogLevel("xlog-test-net");
+    logNetDebug(2);
+    logger->setLogLevel(LogLevel::DEBUG_LEVEL);
+    logNetDebug(3);
+    logger->setLogLevel(LogLevel::INFO_LEVEL);
+
+    constexpr int test_count {1000000};
+    auto const start {std::chrono::steady_clock::now()};
+    for (int i {}; i < test_count; ++i) { XLOG_DEBUG(argument()); }
+    auto const elapsed {std::chrono::steady_clock::now() - start};
+    logger->flush();
+
+    std::ifstream file(logger->getCurrentLogFile());
+    std::string line {};
+    std::size_t module_lines {}, global_lines {};
+    bool ordered {true};
+    for (int expect {1}; std::getline(file, line);) {
+        if (auto const pos {line.find("module debug ")}; pos != std::string::npos) {
+            ++module_lines;
+            if (line.substr(pos + 13) != std::to_string(expect)) { ordered = false; }
+            expect = 3;
+        }
+        if (line.find("global debug") != std::string::npos) { ++global_lines; }
+    }
+
+    std::cout << "module lines = " << module_lines << "/2 (" << (ordered ? "1,3" : "unexpected")
+              << ") global debug lines = " << global_lines << "/0"
+              << " module level = " << XLog::getLevelName(module_level)
+              << " evaluated = " << evaluated << "/0\n"
+              << "filtered cost: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / test_count << " ns/call\n";
+
+    logger->setOverflowPolicy(policy);
+    logger->setOutput(LogOutput::BOTH);
+}
+
 int main() {
 
 #if 1
@@ -181,6 +598,13 @@ int main() {
         // 运行各项测试
         testBasicLogging();
         testFormattedLogging();
+        testFastPath();
+        testThreadQueues();
+        testFileSink();
+        testTimestamps();
+        testFormatArguments();
+        testBinarySink();
+        testModuleLevels();
         //testConfiguration();
         //testMultiThreadLogging();
         //testPerformance();